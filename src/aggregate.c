@@ -0,0 +1,524 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   HASH AGGREGATION — COUNT / SUM / AVG / MIN / MAX [GROUP BY]
+   ============================================================
+   Matching rows stream in from the batch pipeline. Each row's group key
+   (the GROUP BY cells) is hashed into an open-addressing table of group
+   ids; a group remembers its first row, which both answers key equality
+   checks and supplies the key values when printing. Every group owns one
+   accumulator per SELECT item. Groups print in first-seen order.
+
+   Large scans aggregate per morsel on the worker pool: each morsel fills a
+   private group table, and the partial tables are merged in morsel order.
+
+   Without GROUP BY or WHERE, a column-major table folds each numeric
+   column straight over its contiguous vector instead, again one morsel
+   per task with the partial results combined in order. */
+
+#define AGG_MIN_SLOTS 64
+
+//One accumulator: enough state for any of the five functions
+typedef struct {
+    int64_t count;  // rows folded; COUNT's answer, AVG's divisor
+    int64_t isum;   // SUM/AVG over INT
+    double fsum;    // SUM/AVG over FLOAT
+    Value best;     // MIN/MAX so far, valid once count > 0
+} Acc;
+
+//A SELECT item with its column resolved
+typedef struct {
+    AggFunc func;
+    int col;  // -1 = COUNT(*)
+    ColumnType type;
+} AggItem;
+
+typedef struct {
+    const Table* t;
+    const AggItem* items;
+    int num_items;
+    const int* group_cols;
+    int num_group;
+    int* group_rows;      // first row seen for each group
+    uint32_t* group_hash;
+    Acc* accs;            // num_items per group
+    int num_groups;
+    int group_cap;
+    int* slots;           // group id per slot, -1 = empty
+    int slot_count;       // power of two
+    int oom;
+} AggState;
+
+static const char* agg_name(AggFunc f) {
+    switch (f) {
+        case AGG_COUNT: return "COUNT";
+        case AGG_SUM:   return "SUM";
+        case AGG_AVG:   return "AVG";
+        case AGG_MIN:   return "MIN";
+        case AGG_MAX:   return "MAX";
+        default:        return "";
+    }
+}
+
+/* ===== Group table ===== */
+
+static uint32_t group_key_hash(const AggState* st, int row) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < st->num_group; i++) {
+        Value v;
+        table_cell_value(st->t, row, st->group_cols[i], &v);
+        uint32_t vh = (v.type == COL_TEXT && !v.s) ? 0 : value_hash(&v);
+        h = (h ^ vh) * 16777619u;
+    }
+    return h;
+}
+
+static int group_key_equals(const AggState* st, int a, int b) {
+    for (int i = 0; i < st->num_group; i++) {
+        Value va, vb;
+        table_cell_value(st->t, a, st->group_cols[i], &va);
+        table_cell_value(st->t, b, st->group_cols[i], &vb);
+        if (va.type == COL_TEXT && (!va.s || !vb.s)) {
+            if (va.s != vb.s) return 0;  // NULL only groups with NULL
+        } else if (!value_equals(&va, &vb)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int grow_slots(AggState* st) {
+    int count = st->slot_count ? st->slot_count * 2 : AGG_MIN_SLOTS;
+    int* slots = malloc(sizeof(int) * (size_t)count);
+    if (!slots) return 0;
+    for (int i = 0; i < count; i++) slots[i] = -1;
+    uint32_t mask = (uint32_t)count - 1;
+    for (int g = 0; g < st->num_groups; g++) {
+        uint32_t i = st->group_hash[g] & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = g;
+    }
+    free(st->slots);
+    st->slots = slots;
+    st->slot_count = count;
+    return 1;
+}
+
+static int new_group(AggState* st, int row, uint32_t h) {
+    if (st->num_groups == st->group_cap) {
+        int cap = st->group_cap ? st->group_cap * 2 : 16;
+        int* rows = realloc(st->group_rows, sizeof(int) * (size_t)cap);
+        if (rows) st->group_rows = rows;
+        uint32_t* hashes = realloc(st->group_hash, sizeof(uint32_t) * (size_t)cap);
+        if (hashes) st->group_hash = hashes;
+        Acc* accs = realloc(st->accs, sizeof(Acc) * (size_t)cap * (size_t)(st->num_items > 0 ? st->num_items : 1));
+        if (accs) st->accs = accs;
+        if (!rows || !hashes || !accs) return -1;
+        st->group_cap = cap;
+    }
+    int g = st->num_groups++;
+    st->group_rows[g] = row;
+    st->group_hash[g] = h;
+    memset(&st->accs[(size_t)g * (size_t)st->num_items], 0, sizeof(Acc) * (size_t)st->num_items);
+    return g;
+}
+
+/* Returns the group id for row's key, creating the group on first sight. */
+static int find_group(AggState* st, int row) {
+    if ((st->num_groups + 1) * 2 > st->slot_count && !grow_slots(st)) return -1;
+    uint32_t h = group_key_hash(st, row);
+    uint32_t mask = (uint32_t)st->slot_count - 1;
+    uint32_t i = h & mask;
+    for (; st->slots[i] >= 0; i = (i + 1) & mask) {
+        int g = st->slots[i];
+        if (st->group_hash[g] == h && group_key_equals(st, row, st->group_rows[g])) return g;
+    }
+    int g = new_group(st, row, h);
+    if (g >= 0) st->slots[i] = g;
+    return g;
+}
+
+/* ===== Folding ===== */
+
+static void fold_value(Acc* a, AggFunc func, const Value* v) {
+    if (v->type == COL_TEXT && !v->s) return;  // aggregates skip NULL cells
+    switch (func) {
+        case AGG_SUM:
+        case AGG_AVG:
+            if (v->type == COL_INT) a->isum += v->i;
+            else a->fsum += v->f;
+            break;
+        case AGG_MIN:
+            if (a->count == 0 || value_compare(v, &a->best) < 0) a->best = *v;
+            break;
+        case AGG_MAX:
+            if (a->count == 0 || value_compare(v, &a->best) > 0) a->best = *v;
+            break;
+        default:
+            break;
+    }
+    a->count++;
+}
+
+static int aggregate_batch(BatchSink* self, const Table* t, const Batch* b,
+                           const VectorView* cols, int num_cols) {
+    (void)cols;
+    (void)num_cols;
+    AggState* st = self->state;
+    for (int k = 0; k < b->count; k++) {
+        int row = b->sel[k];
+        int g = st->num_group > 0 ? find_group(st, row) : 0;
+        if (g < 0) {
+            st->oom = 1;
+            return 0;
+        }
+        Acc* accs = &st->accs[(size_t)g * (size_t)st->num_items];
+        for (int i = 0; i < st->num_items; i++) {
+            const AggItem* it = &st->items[i];
+            if (it->func == AGG_NONE) continue;
+            if (it->col < 0) {
+                accs[i].count++;
+                continue;
+            }
+            Value v;
+            table_cell_value(t, row, it->col, &v);
+            fold_value(&accs[i], it->func, &v);
+        }
+    }
+    return 1;
+}
+
+/* Folds a finished accumulator into another of the same item. */
+static void combine_acc(Acc* into, const Acc* from, AggFunc func) {
+    if (from->count == 0) return;
+    if (func == AGG_MIN && (into->count == 0 || value_compare(&from->best, &into->best) < 0)) {
+        into->best = from->best;
+    }
+    if (func == AGG_MAX && (into->count == 0 || value_compare(&from->best, &into->best) > 0)) {
+        into->best = from->best;
+    }
+    into->count += from->count;
+    into->isum += from->isum;
+    into->fsum += from->fsum;
+}
+
+/* ===== Parallel partial aggregation ===== */
+
+static void free_state(AggState* st) {
+    free(st->group_rows);
+    free(st->group_hash);
+    free(st->accs);
+    free(st->slots);
+}
+
+//A forked sink and the group table it fills
+typedef struct {
+    BatchSink sink;  // first, so the sink pointer is the part
+    AggState st;
+} AggPart;
+
+/* A private AggState for one morsel, sharing the resolved items. */
+static BatchSink* fork_state(BatchSink* self) {
+    const AggState* st = self->state;
+    AggPart* part = calloc(1, sizeof(AggPart));
+    if (!part) return NULL;
+    AggState* ps = &part->st;
+    ps->t = st->t;
+    ps->items = st->items;
+    ps->num_items = st->num_items;
+    ps->group_cols = st->group_cols;
+    ps->num_group = st->num_group;
+    if (ps->num_group == 0 && new_group(ps, -1, 0) != 0) {
+        free_state(ps);
+        free(part);
+        return NULL;
+    }
+    part->sink.consume = aggregate_batch;
+    part->sink.state = ps;
+    return &part->sink;
+}
+
+/* Merges a morsel's groups in their first-seen order, so the overall
+   group order matches a serial scan. */
+static int join_state(BatchSink* self, BatchSink* part) {
+    AggState* st = self->state;
+    AggState* ps = part->state;
+    int ok = !ps->oom;
+    for (int g = 0; ok && g < ps->num_groups; g++) {
+        int into = st->num_group > 0 ? find_group(st, ps->group_rows[g]) : 0;
+        if (into < 0) {
+            ok = 0;
+            break;
+        }
+        for (int i = 0; i < st->num_items; i++) {
+            combine_acc(&st->accs[(size_t)into * (size_t)st->num_items + (size_t)i],
+                        &ps->accs[(size_t)g * (size_t)ps->num_items + (size_t)i], st->items[i].func);
+        }
+    }
+    if (!ok) st->oom = 1;
+    free_state(ps);
+    free(part);
+    return ok;
+}
+
+/* ===== Vector fast path ===== */
+
+/* One tight loop over slots [from, to) of a contiguous column-major
+   vector, skipping tombstoned slots a bitmap word at a time. from is a
+   multiple of 64. */
+static void fold_int_vector(const Table* t, const int64_t* v, int from, int to, AggFunc func, Acc* a) {
+    int64_t n = 0, sum = 0, lo = INT64_MAX, hi = INT64_MIN;
+    for (int start = from; start < to; start += 64) {
+        int end = start + 64 < to ? start + 64 : to;
+        uint64_t dead = (start >> 6) < t->deleted_words ? t->deleted[start >> 6] : 0;
+        for (int r = start; r < end; r++) {
+            if ((dead >> (r - start)) & 1) continue;
+            sum += v[r];
+            if (v[r] < lo) lo = v[r];
+            if (v[r] > hi) hi = v[r];
+            n++;
+        }
+    }
+    a->count = n;
+    a->isum = sum;
+    a->best.type = COL_INT;
+    a->best.i = func == AGG_MIN ? lo : hi;
+}
+
+static void fold_float_vector(const Table* t, const double* v, int from, int to, AggFunc func, Acc* a) {
+    int64_t n = 0;
+    double sum = 0.0, lo = 0.0, hi = 0.0;
+    for (int start = from; start < to; start += 64) {
+        int end = start + 64 < to ? start + 64 : to;
+        uint64_t dead = (start >> 6) < t->deleted_words ? t->deleted[start >> 6] : 0;
+        for (int r = start; r < end; r++) {
+            if ((dead >> (r - start)) & 1) continue;
+            sum += v[r];
+            if (n == 0 || v[r] < lo) lo = v[r];
+            if (n == 0 || v[r] > hi) hi = v[r];
+            n++;
+        }
+    }
+    a->count = n;
+    a->fsum = sum;
+    a->best.type = COL_FLOAT;
+    a->best.f = func == AGG_MIN ? lo : hi;
+}
+
+static int can_fold_vectors(const Table* t, const AggItem* items, int n) {
+    if (!t->column_major) return 0;
+    for (int i = 0; i < n; i++) {
+        if (items[i].col >= 0 && items[i].type == COL_TEXT) return 0;
+    }
+    return 1;
+}
+
+//Per-morsel partial accumulators for the vector fast path
+typedef struct {
+    MorselJob job;  // first, so the job pointer is the fold
+    const Table* t;
+    const AggItem* items;
+    int num_items;
+    Acc* partial;   // num_items per morsel
+    Acc* total;
+} VectorFold;
+
+static void fold_morsel(MorselJob* job, int m) {
+    VectorFold* vf = (VectorFold*)job;
+    const Table* t = vf->t;
+    int from = m * MORSEL_ROWS;
+    int to = from + MORSEL_ROWS < t->num_rows ? from + MORSEL_ROWS : t->num_rows;
+    Acc* accs = &vf->partial[(size_t)m * (size_t)vf->num_items];
+    for (int i = 0; i < vf->num_items; i++) {
+        const AggItem* it = &vf->items[i];
+        if (it->col < 0) {
+            // COUNT(*): live slots in the range
+            int64_t n = to - from;
+            for (int w = from >> 6; w << 6 < to && w < t->deleted_words; w++) {
+                n -= __builtin_popcountll(t->deleted[w]);
+            }
+            accs[i].count = n;
+            continue;
+        }
+        const ColumnStorage* col = &t->column_data[it->col];
+        if (col->type == COL_INT) fold_int_vector(t, col->ints, from, to, it->func, &accs[i]);
+        else fold_float_vector(t, col->floats, from, to, it->func, &accs[i]);
+    }
+}
+
+static int merge_fold(MorselJob* job, int m) {
+    VectorFold* vf = (VectorFold*)job;
+    for (int i = 0; i < vf->num_items; i++) {
+        combine_acc(&vf->total[i], &vf->partial[(size_t)m * (size_t)vf->num_items + (size_t)i], vf->items[i].func);
+    }
+    return 1;
+}
+
+/* Folds every item over its vector, one morsel per task, and combines the
+   partial results in morsel order. */
+static int fold_vectors(const Table* t, const AggItem* items, int n, Acc* accs) {
+    int num_morsels = (t->num_rows + MORSEL_ROWS - 1) / MORSEL_ROWS;
+    VectorFold vf = { { fold_morsel, merge_fold }, t, items, n, NULL, accs };
+    vf.partial = calloc((size_t)(num_morsels > 0 ? num_morsels : 1) * (size_t)(n > 0 ? n : 1), sizeof(Acc));
+    if (!vf.partial) return 0;
+    parallel_run(&vf.job, num_morsels);
+    free(vf.partial);
+    return 1;
+}
+
+/* ===== Output ===== */
+
+//Type of an item's printed values
+static ColumnType result_type(const AggItem* it) {
+    switch (it->func) {
+        case AGG_COUNT: return COL_INT;
+        case AGG_AVG:   return COL_FLOAT;
+        default:        return it->type;
+    }
+}
+
+static void print_result(ResultWriter* w, const Table* t, const AggItem* it, const Acc* a, int group_row) {
+    Value v;
+    if (it->func == AGG_NONE) {
+        table_cell_value(t, group_row, it->col, &v);
+        writer_value(w, &v);
+        return;
+    }
+    if (it->func == AGG_COUNT) {
+        writer_int(w, a->count);
+        return;
+    }
+    if (a->count == 0) {
+        writer_null(w);
+        return;
+    }
+    switch (it->func) {
+        case AGG_SUM:
+            v.type = it->type;
+            v.i = a->isum;
+            v.f = a->fsum;
+            writer_value(w, &v);
+            break;
+        case AGG_AVG:
+            v.type = COL_FLOAT;
+            v.f = (it->type == COL_INT ? (double)a->isum : a->fsum) / (double)a->count;
+            writer_value(w, &v);
+            break;
+        default:
+            writer_value(w, &a->best);
+            break;
+    }
+}
+
+/* ===== Entry point ===== */
+
+/* Resolves items and GROUP BY columns; prints the error and returns 0 on a
+   bad name, SUM/AVG over TEXT, or a plain column that is not grouped. */
+static int resolve_aggregate(Table* t, const SelectItem* items, int num_items,
+                             char** group_cols, int num_group, AggItem* out, int* groups) {
+    for (int i = 0; i < num_group; i++) {
+        groups[i] = column_index(t, group_cols[i]);
+        if (groups[i] < 0) {
+            printf("Error: unknown column '%s' in GROUP BY.\n", group_cols[i]);
+            return 0;
+        }
+    }
+    for (int i = 0; i < num_items; i++) {
+        out[i].func = items[i].func;
+        out[i].col = -1;
+        out[i].type = COL_INT;
+        if (items[i].func == AGG_COUNT && strcmp(items[i].column, "*") == 0) continue;
+
+        out[i].col = column_index(t, items[i].column);
+        if (out[i].col < 0) {
+            printf("Error: unknown column '%s'.\n", items[i].column);
+            return 0;
+        }
+        out[i].type = t->columns[out[i].col].type;
+        if ((items[i].func == AGG_SUM || items[i].func == AGG_AVG) && out[i].type == COL_TEXT) {
+            printf("Error: %s needs a numeric column; '%s' is TEXT.\n",
+                   agg_name(items[i].func), items[i].column);
+            return 0;
+        }
+        if (items[i].func == AGG_NONE) {
+            int grouped = 0;
+            for (int j = 0; j < num_group; j++) grouped |= groups[j] == out[i].col;
+            if (!grouped) {
+                printf("Error: column '%s' must appear in GROUP BY or inside an aggregate.\n",
+                       items[i].column);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int select_aggregate(Database* db, const char* table_name, const SelectItem* items, int num_items,
+                     char** group_cols, int num_group, const Expr* where, const RowLimit* limit) {
+    Table* t = find_table(db, table_name);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", table_name);
+        return 0;
+    }
+
+    AggItem* resolved = malloc(sizeof(AggItem) * (size_t)(num_items > 0 ? num_items : 1));
+    int* groups = malloc(sizeof(int) * (size_t)(num_group > 0 ? num_group : 1));
+    AggState st;
+    memset(&st, 0, sizeof(AggState));
+    int ok = resolved && groups &&
+             resolve_aggregate(t, items, num_items, group_cols, num_group, resolved, groups);
+    st.t = t;
+    st.items = resolved;
+    st.num_items = num_items;
+    st.group_cols = groups;
+    st.num_group = num_group;
+
+    // Without GROUP BY there is exactly one group, even over no rows
+    if (ok && num_group == 0) ok = new_group(&st, -1, 0) == 0;
+
+    if (ok && num_group == 0 && !where && can_fold_vectors(t, resolved, num_items)) {
+        ok = fold_vectors(t, resolved, num_items, st.accs);
+        st.oom = !ok;
+    } else if (ok) {
+        ScanSpec spec;
+        WhereProgram prog;
+        ok = plan_where(t, where, &spec, &prog);
+        if (ok) {
+            BatchSink sink = { aggregate_batch, &st, fork_state, join_state };
+            ok = pipeline_run(t, &spec, &sink) && !st.oom;
+            release_plan(&spec, &prog);
+        }
+        if (!ok && st.oom) fprintf(stderr, "Out of memory aggregating '%s'.\n", table_name);
+    }
+
+    if (ok) {
+        ResultWriter w;
+        writer_begin(&w, db->output_mode, num_items);
+        for (int i = 0; i < num_items; i++) {
+            char name[MAX_NAME_LEN + 8];
+            if (items[i].func == AGG_NONE) snprintf(name, sizeof(name), "%s", items[i].column);
+            else snprintf(name, sizeof(name), "%s(%s)", agg_name(items[i].func), items[i].column);
+            writer_column(&w, name, result_type(&resolved[i]));
+        }
+        // LIMIT and OFFSET count groups, in the order they print
+        int first = 0;
+        int end = st.num_groups;
+        if (limit) {
+            first = limit->offset < end ? (int)limit->offset : end;
+            if (limit->count >= 0 && limit->count < end - first) end = first + (int)limit->count;
+        }
+        for (int g = first; g < end; g++) {
+            const Acc* accs = &st.accs[(size_t)g * (size_t)num_items];
+            for (int i = 0; i < num_items; i++) print_result(&w, t, &resolved[i], &accs[i], st.group_rows[g]);
+        }
+        writer_end(&w);
+    }
+
+    free(resolved);
+    free(groups);
+    free_state(&st);
+    return ok;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   PER-TABLE ARENA — bump allocator for cell bytes
+   ============================================================ */
+
+#define ARENA_MIN_CHUNK (4 * 1024)
+#define ARENA_MAX_CHUNK (1024 * 1024)
+#define ARENA_ALIGN     sizeof(void*)
+
+void arena_init(Arena* a) {
+    a->head = NULL;
+    a->next_chunk_size = ARENA_MIN_CHUNK;
+    a->bytes_reserved = 0;
+}
+
+void arena_free(Arena* a) {
+    ArenaChunk* c = a->head;
+    while (c) {
+        ArenaChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    arena_init(a);
+}
+
+static ArenaChunk* arena_new_chunk(Arena* a, size_t min_size) {
+    // Chunks double up to ARENA_MAX_CHUNK so large tables need few of them
+    size_t cap = a->next_chunk_size;
+    if (cap < min_size) cap = min_size;
+    ArenaChunk* c = malloc(sizeof(ArenaChunk) + cap);
+    if (!c) {
+        fprintf(stderr, "Out of memory in arena\n");
+        exit(1);
+    }
+    c->used = 0;
+    c->cap = cap;
+    c->next = a->head;
+    a->head = c;
+    a->bytes_reserved += cap;
+    if (a->next_chunk_size < ARENA_MAX_CHUNK) a->next_chunk_size *= 2;
+    return c;
+}
+
+static void* arena_bump(Arena* a, size_t size, size_t align) {
+    ArenaChunk* c = a->head;
+    size_t off = 0;
+    if (c) off = (c->used + align - 1) & ~(align - 1);
+    if (!c || off + size > c->cap) {
+        c = arena_new_chunk(a, size);
+        off = 0;
+    }
+    c->used = off + size;
+    return c->data + off;
+}
+
+void* arena_alloc(Arena* a, size_t size) {
+    return arena_bump(a, size, ARENA_ALIGN);
+}
+
+void* arena_alloc_bytes(Arena* a, size_t size) {
+    return arena_bump(a, size, 1);
+}
+
+char* arena_strndup(Arena* a, const char* s, size_t len) {
+    char* out = arena_bump(a, len + 1, 1);
+    memcpy(out, s, len);
+    out[len] = '\0';
+    return out;
+}
+
+char* arena_strdup(Arena* a, const char* s) {
+    if (!s) return NULL;
+    return arena_strndup(a, s, strlen(s));
+}
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   B+TREE INDEX — ordered by (typed key, row id)
+   ============================================================
+   Entries are (Value, row) pairs, so duplicate keys are still unique
+   entries and equal keys come out in row order. TEXT keys point at arena
+   bytes, which stay put until vacuum rebuilds every index. Removal does not
+   rebalance: leaves may run underfull until the next rebuild. */
+
+int value_compare(const Value* a, const Value* b) {
+    switch (a->type) {
+        case COL_INT:   return (a->i > b->i) - (a->i < b->i);
+        case COL_FLOAT: return (a->f > b->f) - (a->f < b->f);
+        default:        return strcmp(a->s, b->s);
+    }
+}
+
+static int entry_compare(const Value* ka, int ra, const Value* kb, int rb) {
+    int c = value_compare(ka, kb);
+    if (c != 0) return c;
+    return (ra > rb) - (ra < rb);
+}
+
+static BTreeNode* node_new(int leaf) {
+    BTreeNode* n = calloc(1, sizeof(BTreeNode));
+    if (!n) {
+        fprintf(stderr, "Out of memory in B+tree\n");
+        exit(1);
+    }
+    n->leaf = leaf;
+    return n;
+}
+
+void btree_free(BTreeNode* n) {
+    if (!n) return;
+    if (!n->leaf) {
+        for (int i = 0; i < n->count; i++) btree_free(n->children[i]);
+    }
+    free(n);
+}
+
+/* Child of an internal node that may hold (key, row): the number of
+   separators not greater than the entry. */
+static int child_slot(const BTreeNode* n, const Value* key, int row) {
+    int lo = 0, hi = n->count - 1;  // count children, count - 1 separators
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (entry_compare(key, row, &n->keys[mid], n->rows[mid]) < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* First position in a leaf whose entry is >= (key, row). */
+static int leaf_slot(const BTreeNode* n, const Value* key, int row) {
+    int lo = 0, hi = n->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (entry_compare(&n->keys[mid], n->rows[mid], key, row) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Inserts below n. On split, returns the new right sibling and stores its
+   smallest entry in (*sep_key, *sep_row) for the parent. */
+static BTreeNode* insert_rec(BTreeNode* n, const Value* key, int row,
+                             Value* sep_key, int* sep_row) {
+    if (n->leaf) {
+        int pos = leaf_slot(n, key, row);
+        memmove(&n->keys[pos + 1], &n->keys[pos], sizeof(Value) * (size_t)(n->count - pos));
+        memmove(&n->rows[pos + 1], &n->rows[pos], sizeof(int) * (size_t)(n->count - pos));
+        n->keys[pos] = *key;
+        n->rows[pos] = row;
+        n->count++;
+        if (n->count < BTREE_ORDER) return NULL;
+
+        BTreeNode* right = node_new(1);
+        int half = n->count / 2;
+        right->count = n->count - half;
+        memcpy(right->keys, &n->keys[half], sizeof(Value) * (size_t)right->count);
+        memcpy(right->rows, &n->rows[half], sizeof(int) * (size_t)right->count);
+        n->count = half;
+        right->next = n->next;
+        n->next = right;
+        *sep_key = right->keys[0];
+        *sep_row = right->rows[0];
+        return right;
+    }
+
+    int ci = child_slot(n, key, row);
+    Value up_key;
+    int up_row;
+    BTreeNode* split = insert_rec(n->children[ci], key, row, &up_key, &up_row);
+    if (!split) return NULL;
+
+    // Separator ci goes in front of child ci + 1
+    int nsep = n->count - 1;
+    memmove(&n->keys[ci + 1], &n->keys[ci], sizeof(Value) * (size_t)(nsep - ci));
+    memmove(&n->rows[ci + 1], &n->rows[ci], sizeof(int) * (size_t)(nsep - ci));
+    memmove(&n->children[ci + 2], &n->children[ci + 1], sizeof(BTreeNode*) * (size_t)(n->count - ci - 1));
+    n->keys[ci] = up_key;
+    n->rows[ci] = up_row;
+    n->children[ci + 1] = split;
+    n->count++;
+    if (n->count <= BTREE_ORDER) return NULL;
+
+    // Split the internal node; the middle separator moves up
+    BTreeNode* right = node_new(0);
+    int left_children = n->count / 2;
+    right->count = n->count - left_children;
+    memcpy(right->children, &n->children[left_children], sizeof(BTreeNode*) * (size_t)right->count);
+    memcpy(right->keys, &n->keys[left_children], sizeof(Value) * (size_t)(right->count - 1));
+    memcpy(right->rows, &n->rows[left_children], sizeof(int) * (size_t)(right->count - 1));
+    *sep_key = n->keys[left_children - 1];
+    *sep_row = n->rows[left_children - 1];
+    n->count = left_children;
+    return right;
+}
+
+void btree_insert(BTreeNode** root, const Value* key, int row) {
+    if (!*root) *root = node_new(1);
+    Value sep_key;
+    int sep_row;
+    BTreeNode* split = insert_rec(*root, key, row, &sep_key, &sep_row);
+    if (!split) return;
+    BTreeNode* top = node_new(0);
+    top->children[0] = *root;
+    top->children[1] = split;
+    top->keys[0] = sep_key;
+    top->rows[0] = sep_row;
+    top->count = 2;
+    *root = top;
+}
+
+static BTreeNode* find_leaf(BTreeNode* n, const Value* key, int row) {
+    while (n && !n->leaf) n = n->children[child_slot(n, key, row)];
+    return n;
+}
+
+void btree_remove(BTreeNode* root, const Value* key, int row) {
+    BTreeNode* leaf = find_leaf(root, key, row);
+    if (!leaf) return;
+    int pos = leaf_slot(leaf, key, row);
+    if (pos >= leaf->count || leaf->rows[pos] != row) return;
+    memmove(&leaf->keys[pos], &leaf->keys[pos + 1], sizeof(Value) * (size_t)(leaf->count - pos - 1));
+    memmove(&leaf->rows[pos], &leaf->rows[pos + 1], sizeof(int) * (size_t)(leaf->count - pos - 1));
+    leaf->count--;
+}
+
+int btree_range(const BTreeNode* root, const KeyRange* range, int max, int* out) {
+    if (!root) return 0;
+    const BTreeNode* leaf;
+    int pos;
+    if (range->has_lo) {
+        // Row INT_MIN sorts before every real row with the same key
+        leaf = find_leaf((BTreeNode*)root, &range->lo, INT_MIN);
+        pos = leaf_slot(leaf, &range->lo, INT_MIN);
+    } else {
+        leaf = root;
+        while (!leaf->leaf) leaf = leaf->children[0];
+        pos = 0;
+    }
+
+    int n = 0;
+    for (; leaf; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->count; pos++) {
+            const Value* k = &leaf->keys[pos];
+            if (range->has_lo && !range->lo_incl && value_compare(k, &range->lo) == 0) continue;
+            if (range->has_hi) {
+                int c = value_compare(k, &range->hi);
+                if (c > 0 || (c == 0 && !range->hi_incl)) return n;
+            }
+            if (n == max) return n;
+            out[n++] = leaf->rows[pos];
+        }
+    }
+    return n;
+}
+
+/* ===== Ordered walk ===== */
+
+/* Pushes n and its first (or last) descendants down to a leaf. */
+static void walk_descend(BTreeCursor* c, const BTreeNode* n, int desc) {
+    for (;;) {
+        int slot = desc ? n->count - 1 : 0;
+        c->path[c->depth] = n;
+        c->slot[c->depth++] = slot;
+        if (n->leaf) return;
+        n = n->children[slot];
+    }
+}
+
+int btree_walk(const BTreeNode* root, int desc, BTreeCursor* c, int max, int* out) {
+    int step = desc ? -1 : 1;
+    if (!c->started) {
+        c->started = 1;
+        c->depth = 0;
+        if (root) walk_descend(c, root, desc);
+    }
+
+    int n = 0;
+    while (n < max && c->depth > 0) {
+        int d = c->depth - 1;
+        const BTreeNode* leaf = c->path[d];
+        int pos = c->slot[d];
+        if (pos >= 0 && pos < leaf->count) {
+            out[n++] = leaf->rows[pos];
+            c->slot[d] = pos + step;
+            continue;
+        }
+        // Leaf used up (or left empty by removals): climb to the next sibling subtree
+        int next = 0;
+        do {
+            c->depth--;
+            d = c->depth - 1;
+            if (d >= 0) next = c->slot[d] + step;
+        } while (d >= 0 && (next < 0 || next >= c->path[d]->count));
+        if (d < 0) break;
+        c->slot[d] = next;
+        walk_descend(c, c->path[d]->children[next], desc);
+    }
+    return n;
+}
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   RESULT CACHE — printed SELECT output reused until a table changes
+   ============================================================
+   With .cache on, a SELECT's output is captured as the writer prints it
+   and kept under a key: the output mode and the statement text with
+   whitespace outside "quoted" literals collapsed. Next to it the entry
+   records the schema version and the write version of every table named
+   after FROM or JOIN. A later SELECT with the same key whose tables are
+   all unchanged prints the stored bytes and runs nothing.
+
+   Tables bump their write version on every insert, update, delete and
+   layout change, and on CREATE INDEX and ANALYZE, which can change the
+   order an unordered result comes back in. Drop and create move the
+   schema version. Entries are therefore never updated in place: one
+   found stale is dropped on lookup, and the rest age out of the LRU list
+   once the cached bytes pass the memory cap. A failed SELECT, or one
+   whose output alone passes the cap, is not kept. */
+
+#define CACHE_MAX_TABLES 4
+#define CACHE_MIN_BUCKETS 64
+
+typedef struct CacheEntry {
+    char* key;
+    uint32_t hash;
+    unsigned schema_version;
+    int num_tables;
+    char tables[CACHE_MAX_TABLES][MAX_NAME_LEN];
+    uint64_t versions[CACHE_MAX_TABLES];
+    char* result;
+    size_t result_len;
+    size_t bytes;                    // charged against the cap
+    struct CacheEntry* chain;        // next in its hash bucket
+    struct CacheEntry *prev, *next;  // LRU list, most recent first
+} CacheEntry;
+
+struct ResultCache {
+    size_t cap;
+    size_t used;
+    CacheEntry** buckets;
+    int num_buckets;  // power of two
+    int count;
+    CacheEntry* head;
+    CacheEntry* tail;
+    int64_t hits, misses, stale, evictions;
+};
+
+/* ===== Keys ===== */
+
+static uint32_t key_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* "mode:statement", whitespace runs outside quotes folded to one space and
+   a trailing ';' dropped. NULL on out of memory. */
+static char* make_key(OutputMode mode, const char* sql) {
+    const char* prefix = output_mode_name(mode);
+    size_t plen = strlen(prefix);
+    char* key = malloc(plen + 1 + strlen(sql) + 1);
+    if (!key) return NULL;
+    memcpy(key, prefix, plen);
+    char* w = key + plen;
+    *w++ = ':';
+    char* body = w;
+    int quoted = 0;
+    for (const char* p = sql; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        if (!quoted && isspace((unsigned char)*p)) {
+            if (w > body && w[-1] != ' ') *w++ = ' ';
+            continue;
+        }
+        *w++ = *p;
+    }
+    while (w > body && (w[-1] == ' ' || w[-1] == ';')) w--;
+    *w = '\0';
+    return key;
+}
+
+/* Copies the names following FROM and JOIN; -1 if there are more than
+   CACHE_MAX_TABLES. */
+static int key_tables(const char* key, char names[][MAX_NAME_LEN]) {
+    int n = 0;
+    int quoted = 0;
+    for (const char* p = key; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        if (quoted || (p != key && (isalnum((unsigned char)p[-1]) || p[-1] == '_'))) continue;
+        size_t kw = 0;
+        if (strncasecmp(p, "FROM ", 5) == 0) kw = 5;
+        else if (strncasecmp(p, "JOIN ", 5) == 0) kw = 5;
+        if (kw == 0) continue;
+        if (n == CACHE_MAX_TABLES) return -1;
+        p += kw;
+        size_t i = 0;
+        while (p[i] && !isspace((unsigned char)p[i]) && !strchr(";(", p[i]) && i < MAX_NAME_LEN - 1) {
+            names[n][i] = p[i];
+            i++;
+        }
+        names[n++][i] = '\0';
+        p += i - (i > 0);
+    }
+    return n;
+}
+
+/* ===== Entries ===== */
+
+static void unlink_lru(ResultCache* c, CacheEntry* e) {
+    if (e->prev) e->prev->next = e->next;
+    else c->head = e->next;
+    if (e->next) e->next->prev = e->prev;
+    else c->tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void push_front(ResultCache* c, CacheEntry* e) {
+    e->prev = NULL;
+    e->next = c->head;
+    if (c->head) c->head->prev = e;
+    c->head = e;
+    if (!c->tail) c->tail = e;
+}
+
+static void remove_entry(ResultCache* c, CacheEntry* e) {
+    CacheEntry** link = &c->buckets[e->hash & (uint32_t)(c->num_buckets - 1)];
+    while (*link != e) link = &(*link)->chain;
+    *link = e->chain;
+    unlink_lru(c, e);
+    c->used -= e->bytes;
+    c->count--;
+    free(e->key);
+    free(e->result);
+    free(e);
+}
+
+static CacheEntry* find_entry(const ResultCache* c, const char* key, uint32_t h) {
+    for (CacheEntry* e = c->buckets[h & (uint32_t)(c->num_buckets - 1)]; e; e = e->chain) {
+        if (e->hash == h && strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+static int entry_current(Database* db, const CacheEntry* e) {
+    if (e->schema_version != db->schema_version) return 0;
+    for (int i = 0; i < e->num_tables; i++) {
+        Table* t = find_table(db, e->tables[i]);
+        if (!t || t->write_version != e->versions[i]) return 0;
+    }
+    return 1;
+}
+
+static void evict_to(ResultCache* c, size_t cap) {
+    while (c->tail && c->used > cap) {
+        remove_entry(c, c->tail);
+        c->evictions++;
+    }
+}
+
+//Doubles the bucket array once entries outnumber buckets; keeps the old one on failure
+static void grow_buckets(ResultCache* c) {
+    int n = c->num_buckets * 2;
+    CacheEntry** b = calloc((size_t)n, sizeof(CacheEntry*));
+    if (!b) return;
+    for (int i = 0; i < c->num_buckets; i++) {
+        CacheEntry* e = c->buckets[i];
+        while (e) {
+            CacheEntry* next = e->chain;
+            CacheEntry** slot = &b[e->hash & (uint32_t)(n - 1)];
+            e->chain = *slot;
+            *slot = e;
+            e = next;
+        }
+    }
+    free(c->buckets);
+    c->buckets = b;
+    c->num_buckets = n;
+}
+
+/* ===== Cache ===== */
+
+int cache_enable(Database* db, size_t cap) {
+    ResultCache* c = db->cache;
+    if (!c) {
+        c = calloc(1, sizeof(ResultCache));
+        if (!c) return 0;
+        c->buckets = calloc(CACHE_MIN_BUCKETS, sizeof(CacheEntry*));
+        if (!c->buckets) {
+            free(c);
+            return 0;
+        }
+        c->num_buckets = CACHE_MIN_BUCKETS;
+        db->cache = c;
+    }
+    c->cap = cap;
+    evict_to(c, cap);
+    return 1;
+}
+
+void cache_free(ResultCache* c) {
+    if (!c) return;
+    while (c->head) remove_entry(c, c->head);
+    free(c->buckets);
+    free(c);
+}
+
+int cache_replay(Database* db, const char* sql) {
+    ResultCache* c = db->cache;
+    char* key = make_key(db->output_mode, sql);
+    if (!key) return 0;
+    uint32_t h = key_hash(key);
+    CacheEntry* e = find_entry(c, key, h);
+    free(key);
+    if (e && !entry_current(db, e)) {
+        remove_entry(c, e);
+        c->stale++;
+        e = NULL;
+    }
+    if (!e) {
+        c->misses++;
+        writer_capture_start(c->cap);
+        return 0;
+    }
+    c->hits++;
+    unlink_lru(c, e);
+    push_front(c, e);
+    fwrite(e->result, 1, e->result_len, stdout);
+    return 1;
+}
+
+void cache_store(Database* db, const char* sql, int ok) {
+    ResultCache* c = db->cache;
+    size_t len = 0;
+    char* result = writer_capture_take(&len);
+    CacheEntry* e = NULL;
+    char* key = NULL;
+    if (!ok || !result || !(key = make_key(db->output_mode, sql)) ||
+        !(e = calloc(1, sizeof(CacheEntry)))) {
+        free(result);
+        free(key);
+        return;
+    }
+    e->num_tables = key_tables(key, e->tables);
+    e->bytes = sizeof(CacheEntry) + strlen(key) + 1 + len;
+    if (e->num_tables <= 0 || e->bytes > c->cap) {
+        free(result);
+        free(key);
+        free(e);
+        return;
+    }
+    for (int i = 0; i < e->num_tables; i++) {
+        Table* t = find_table(db, e->tables[i]);
+        e->versions[i] = t ? t->write_version : 0;
+    }
+    char* shrunk = realloc(result, len);
+    e->key = key;
+    e->hash = key_hash(key);
+    e->schema_version = db->schema_version;
+    e->result = shrunk ? shrunk : result;
+    e->result_len = len;
+
+    CacheEntry* old = find_entry(c, key, e->hash);
+    if (old) remove_entry(c, old);
+    evict_to(c, c->cap - e->bytes);
+    if (c->count >= c->num_buckets) grow_buckets(c);
+    CacheEntry** slot = &c->buckets[e->hash & (uint32_t)(c->num_buckets - 1)];
+    e->chain = *slot;
+    *slot = e;
+    push_front(c, e);
+    c->used += e->bytes;
+    c->count++;
+}
+
+void print_cache_stats(const Database* db) {
+    const ResultCache* c = db->cache;
+    if (!c) {
+        printf("Result cache: off\n");
+        return;
+    }
+    printf("Result cache: %d result(s), %zu of %zu KB; %" PRId64 " hit(s), %" PRId64
+           " miss(es), %" PRId64 " stale, %" PRId64 " evicted\n",
+           c->count, (c->used + 1023) / 1024, c->cap / 1024, c->hits, c->misses, c->stale,
+           c->evictions);
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   CURSORS — SELECT results pulled a batch or a row at a time
+   ============================================================
+   A cursor is a planned SELECT over the serial pipeline in pull form.
+   cursor_next_batch hands out each projected batch as the pipeline made
+   it: the selection vector plus views that read column-major vectors in
+   place or point at row-major cells, so nothing is copied or formatted.
+   cursor_step walks those same batches a row at a time, and the typed
+   readers go straight to the table.
+
+   Whatever the result size, a cursor holds one batch and its views. The
+   one exception is an index probe, which plans its matching row list up
+   front. The REPL prints through pipeline_run instead, so a large scan
+   can still use the morsel pool; cursors are the embedder's pull form. */
+
+Cursor* cursor_open(Database* db, const char* table_name, char** cols, int num_cols,
+                    const Expr* where, const RowLimit* limit) {
+    Table* t = find_table(db, table_name);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", table_name);
+        return NULL;
+    }
+    Cursor* c = calloc(1, sizeof(Cursor));
+    if (!c) {
+        fprintf(stderr, "Out of memory opening a cursor on '%s'.\n", table_name);
+        return NULL;
+    }
+    c->t = t;
+    c->num_cols = cols ? num_cols : t->num_columns;
+    c->cols = resolve_columns(t, cols, c->num_cols);
+    if (!c->cols) {
+        free(c);
+        return NULL;
+    }
+
+    if (!plan_limited(t, where, limit, &c->spec, &c->prog)) {
+        free(c->cols);
+        free(c);
+        return NULL;
+    }
+    c->spec.cols = c->cols;
+    c->spec.num_cols = c->num_cols;
+    c->pipe = pipeline_open(t, &c->spec);
+    if (!c->pipe) {
+        fprintf(stderr, "Out of memory opening a cursor on '%s'.\n", table_name);
+        cursor_close(c);
+        return NULL;
+    }
+    return c;
+}
+
+const Batch* cursor_next_batch(Cursor* c, const VectorView** cols) {
+    c->pos = 0;
+    c->batch = c->pipe ? pipeline_next(c->pipe, &c->views) : NULL;
+    if (cols) *cols = c->views;
+    return c->batch;
+}
+
+int cursor_step(Cursor* c) {
+    if (c->batch && c->pos < c->batch->count) {
+        c->pos++;
+        return 1;
+    }
+    if (!cursor_next_batch(c, NULL)) return 0;
+    c->pos = 1;
+    return 1;
+}
+
+int cursor_column_count(const Cursor* c) {
+    return c->num_cols;
+}
+
+const char* cursor_column_name(const Cursor* c, int i) {
+    return c->t->columns[c->cols[i]].name;
+}
+
+ColumnType cursor_column_type(const Cursor* c, int i) {
+    return c->t->columns[c->cols[i]].type;
+}
+
+void cursor_value(const Cursor* c, int i, Value* out) {
+    table_cell_value(c->t, c->batch->sel[c->pos - 1], c->cols[i], out);
+}
+
+const char* cursor_text(Cursor* c, int i) {
+    return vector_cell_text(&c->views[i], c->batch, c->pos - 1, c->text_buf, sizeof(c->text_buf));
+}
+
+void cursor_close(Cursor* c) {
+    if (!c) return;
+    pipeline_close(c->pipe);
+    release_plan(&c->spec, &c->prog);
+    free(c->cols);
+    free(c);
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   TEXT DICTIONARY — code <-> string map for encoded columns
+   ============================================================ */
+
+#define DICT_MIN_SLOTS 16
+
+static uint32_t hash_text(const char* s) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+TextDict* dict_create(void) {
+    TextDict* d = calloc(1, sizeof(TextDict));
+    if (!d) return NULL;
+    d->slot_count = DICT_MIN_SLOTS;
+    d->slots = malloc(sizeof(int) * (size_t)d->slot_count);
+    if (!d->slots) {
+        free(d);
+        return NULL;
+    }
+    memset(d->slots, 0xff, sizeof(int) * (size_t)d->slot_count);  // -1 = empty
+    return d;
+}
+
+void dict_free(TextDict* d) {
+    if (!d) return;
+    free(d->strings);
+    free(d->slots);
+    free(d);
+}
+
+int dict_lookup(const TextDict* d, const char* s) {
+    uint32_t mask = (uint32_t)d->slot_count - 1;
+    for (uint32_t i = hash_text(s) & mask;; i = (i + 1) & mask) {
+        int code = d->slots[i];
+        if (code < 0) return -1;
+        if (strcmp(d->strings[code], s) == 0) return code;
+    }
+}
+
+static int dict_rehash(TextDict* d, int slot_count) {
+    int* slots = malloc(sizeof(int) * (size_t)slot_count);
+    if (!slots) return 0;
+    memset(slots, 0xff, sizeof(int) * (size_t)slot_count);
+    uint32_t mask = (uint32_t)slot_count - 1;
+    for (int code = 0; code < d->count; code++) {
+        uint32_t i = hash_text(d->strings[code]) & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = code;
+    }
+    free(d->slots);
+    d->slots = slots;
+    d->slot_count = slot_count;
+    return 1;
+}
+
+int dict_intern(TextDict* d, Arena* arena, const char* s) {
+    int code = dict_lookup(d, s);
+    if (code >= 0) return code;
+
+    // Keep the probe table at most half full
+    if ((d->count + 1) * 2 > d->slot_count && !dict_rehash(d, d->slot_count * 2)) return -1;
+    if (d->count >= d->capacity) {
+        int cap = d->capacity ? d->capacity * 2 : 16;
+        char** tmp = realloc(d->strings, sizeof(char*) * (size_t)cap);
+        if (!tmp) return -1;
+        d->strings = tmp;
+        d->capacity = cap;
+    }
+
+    code = d->count++;
+    d->strings[code] = arena_strdup(arena, s);
+    uint32_t mask = (uint32_t)d->slot_count - 1;
+    uint32_t i = hash_text(s) & mask;
+    while (d->slots[i] >= 0) i = (i + 1) & mask;
+    d->slots[i] = code;
+    return code;
+}
+
+void dict_move_strings(TextDict* d, Arena* arena) {
+    for (int code = 0; code < d->count; code++) {
+        d->strings[code] = arena_strdup(arena, d->strings[code]);
+    }
+}
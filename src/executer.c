@@ -2,11 +2,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
 #include "miniqlite.h"
 
-static void free_table(Table* t);
-static int column_index(Table* t, const char* name);
-
 /* ===== Utility ===== */
 
 char* str_duplicate(const char* s) {
@@ -29,6 +29,230 @@ ColumnType parse_column_type(const char* s) {
     return COL_TEXT; // default
 }
 
+int parse_int_value(const char* s, int64_t* out) {
+    if (!s || *s == '\0') return 0;
+    char* end = NULL;
+    errno = 0;
+    long long v = strtoll(s, &end, 10);
+    if (errno != 0 || *end != '\0') return 0;
+    *out = (int64_t)v;
+    return 1;
+}
+
+int parse_float_value(const char* s, double* out) {
+    if (!s || *s == '\0') return 0;
+    char* end = NULL;
+    errno = 0;
+    double v = strtod(s, &end);
+    if (errno != 0 || *end != '\0') return 0;
+    *out = v;
+    return 1;
+}
+
+void format_float_value(double v, char* buf, size_t buf_sz) {
+    // %.15g is exact for most literals; fall back to %.17g when it does not round-trip
+    snprintf(buf, buf_sz, "%.15g", v);
+    if (strtod(buf, NULL) != v) snprintf(buf, buf_sz, "%.17g", v);
+}
+
+int check_typed_value(ColumnType type, const char* s) {
+    int64_t i;
+    double f;
+    switch (type) {
+        case COL_INT:   return parse_int_value(s, &i);
+        case COL_FLOAT: return parse_float_value(s, &f);
+        default:        return 1;
+    }
+}
+
+const char* column_cell_text(const ColumnStorage* col, int row, char* buf, size_t buf_sz) {
+    switch (col->type) {
+        case COL_INT:
+            snprintf(buf, buf_sz, "%" PRId64, col->ints[row]);
+            return buf;
+        case COL_FLOAT:
+            format_float_value(col->floats[row], buf, buf_sz);
+            return buf;
+        default:
+            if (col->dict) return col->dict->strings[col->codes[row]];
+            return col->values[row] ? col->values[row] : "NULL";
+    }
+}
+
+int column_store_value(Arena* arena, ColumnStorage* col, int row, const char* s) {
+    switch (col->type) {
+        case COL_INT:   return parse_int_value(s, &col->ints[row]);
+        case COL_FLOAT: return parse_float_value(s, &col->floats[row]);
+        default:
+            if (col->dict) {
+                int code = dict_intern(col->dict, arena, s);
+                if (code < 0) return 0;
+                col->codes[row] = (uint32_t)code;
+                return 1;
+            }
+            col->values[row] = arena_strdup(arena, s);
+            return 1;
+    }
+}
+
+/* Typed counterpart of column_store_value: v is already in the column's type. */
+static int column_store_typed(Arena* arena, ColumnStorage* col, int row, const Value* v) {
+    switch (col->type) {
+        case COL_INT:   col->ints[row] = v->i; return 1;
+        case COL_FLOAT: col->floats[row] = v->f; return 1;
+        default:
+            if (col->dict) {
+                int code = dict_intern(col->dict, arena, v->s);
+                if (code < 0) return 0;
+                col->codes[row] = (uint32_t)code;
+                return 1;
+            }
+            col->values[row] = arena_strdup(arena, v->s);
+            return 1;
+    }
+}
+
+int value_parse(ColumnType type, const char* s, Value* out) {
+    out->type = type;
+    out->i = 0;
+    out->f = 0.0;
+    out->s = s;
+    switch (type) {
+        case COL_INT:   return parse_int_value(s, &out->i);
+        case COL_FLOAT: return parse_float_value(s, &out->f);
+        default:        return s != NULL;
+    }
+}
+
+void table_cell_value(const Table* t, int row, int col, Value* out) {
+    if (!t->column_major) {
+        // Row-major cells were validated on the way in, so this parse succeeds
+        value_parse(t->columns[col].type, t->rows[row].values[col], out);
+        return;
+    }
+    const ColumnStorage* cs = &t->column_data[col];
+    out->type = cs->type;
+    out->i = 0;
+    out->f = 0.0;
+    out->s = NULL;
+    switch (cs->type) {
+        case COL_INT:   out->i = cs->ints[row]; break;
+        case COL_FLOAT: out->f = cs->floats[row]; break;
+        default:
+            out->s = cs->dict ? cs->dict->strings[cs->codes[row]] : cs->values[row];
+            break;
+    }
+}
+
+int value_equals(const Value* a, const Value* b) {
+    switch (a->type) {
+        case COL_INT:   return a->i == b->i;
+        case COL_FLOAT: return a->f == b->f;
+        default:        return a->s && b->s && strcmp(a->s, b->s) == 0;
+    }
+}
+
+void compare_range(CompareOp op, const Value* v, const Value* v2, KeyRange* out) {
+    memset(out, 0, sizeof(KeyRange));
+    switch (op) {
+        case CMP_EQ:
+        case CMP_NE:
+            out->has_lo = out->has_hi = out->lo_incl = out->hi_incl = 1;
+            out->exclude = op == CMP_NE;
+            out->lo = out->hi = *v;
+            break;
+        case CMP_LT:
+        case CMP_LE:
+            out->has_hi = 1;
+            out->hi_incl = op == CMP_LE;
+            out->hi = *v;
+            break;
+        case CMP_GT:
+        case CMP_GE:
+            out->has_lo = 1;
+            out->lo_incl = op == CMP_GE;
+            out->lo = *v;
+            break;
+        case CMP_BETWEEN:
+            out->has_lo = out->has_hi = out->lo_incl = out->hi_incl = 1;
+            out->lo = *v;
+            out->hi = *v2;
+            break;
+    }
+}
+
+int condition_range(ColumnType type, const Condition* cond, KeyRange* out) {
+    Value v, v2;
+    memset(&v2, 0, sizeof(Value));
+    if (!value_parse(type, cond->value, &v)) return 0;
+    if (cond->op == CMP_BETWEEN && !value_parse(type, cond->value2, &v2)) return 0;
+    compare_range(cond->op, &v, &v2, out);
+    return 1;
+}
+
+int value_in_range(const Value* v, const KeyRange* r) {
+    if (r->has_lo) {
+        int c = value_compare(v, &r->lo);
+        if (c < 0 || (c == 0 && !r->lo_incl)) return r->exclude;
+    }
+    if (r->has_hi) {
+        int c = value_compare(v, &r->hi);
+        if (c > 0 || (c == 0 && !r->hi_incl)) return r->exclude;
+    }
+    return !r->exclude;
+}
+
+static int grow_capacity(int cap, int min_rows) {
+    if (cap < 16) cap = 16;
+    while (cap < min_rows) cap *= 2;
+    return cap;
+}
+
+int table_reserve(Table* t, int column_major, int min_rows) {
+    if (!column_major) {
+        if (t->row_capacity >= min_rows) return 1;
+        int cap = grow_capacity(t->row_capacity, min_rows);
+        Row* tmp = realloc(t->rows, sizeof(Row) * (size_t)cap);
+        if (!tmp) return 0;
+        t->rows = tmp;
+        t->row_capacity = cap;
+        return 1;
+    }
+
+    for (int c = 0; c < t->num_columns; c++) {
+        ColumnStorage* col = &t->column_data[c];
+        if (col->capacity >= min_rows) continue;
+        int cap = grow_capacity(col->capacity, min_rows);
+        void* tmp;
+        switch (col->type) {
+            case COL_INT:
+                tmp = realloc(col->ints, sizeof(int64_t) * (size_t)cap);
+                if (!tmp) return 0;
+                col->ints = tmp;
+                break;
+            case COL_FLOAT:
+                tmp = realloc(col->floats, sizeof(double) * (size_t)cap);
+                if (!tmp) return 0;
+                col->floats = tmp;
+                break;
+            default:
+                if (col->dict) {
+                    tmp = realloc(col->codes, sizeof(uint32_t) * (size_t)cap);
+                    if (!tmp) return 0;
+                    col->codes = tmp;
+                    break;
+                }
+                tmp = realloc(col->values, sizeof(char*) * (size_t)cap);
+                if (!tmp) return 0;
+                col->values = tmp;
+                break;
+        }
+        if (!zone_reserve(col, cap)) return 0;
+        col->capacity = cap;
+    }
+    return 1;
+}
+
 const char* column_type_to_string(ColumnType t) {
     switch (t) {
         case COL_INT:   return "INT";
@@ -43,6 +267,13 @@ const char* column_type_to_string(ColumnType t) {
 void init_database(Database* db) {
     db->num_tables = 0;
     db->tables = NULL;
+    db->binary_mode = 0;
+    db->column_store = 0;
+    db->schema_version = 0;
+    db->output_mode = OUTPUT_LIST;
+    db->cache = NULL;
+    db->views = NULL;
+    db->num_views = 0;
 }
 
 void free_database(Database* db) {
@@ -53,21 +284,44 @@ void free_database(Database* db) {
     free(db->tables);
     db->tables = NULL;
     db->num_tables = 0;
+    cache_free(db->cache);
+    db->cache = NULL;
+    for (int i = 0; i < db->num_views; i++) view_free(db->views[i]);
+    free(db->views);
+    db->views = NULL;
+    db->num_views = 0;
 }
 
-static void free_table(Table* t) {
+void free_table(Table* t) {
     if (!t) return;
     free(t->columns);
-    for (int r = 0; r < t->num_rows; r++) {
-        if (t->rows[r].values) {
-            for (int c = 0; c < t->num_columns; c++) {
-                free(t->rows[r].values[c]);
-            }
-            free(t->rows[r].values);
+    // Cell strings and row value arrays live in the arena: O(chunks) to release
+    arena_free(&t->arena);
+    free(t->rows);
+    free(t->deleted);
+    for (int i = 0; i < t->num_indexes; i++) index_free(&t->indexes[i]);
+    free(t->indexes);
+    t->indexes = NULL;
+    t->num_indexes = 0;
+    free(t->views);  // the views themselves belong to the database
+    t->views = NULL;
+    t->num_views = 0;
+    stats_free(t);
+    if (t->column_data) {
+        for (int c = 0; c < t->num_columns; c++) {
+            ColumnStorage* col = &t->column_data[c];
+            free(col->values);
+            free(col->codes);
+            dict_free(col->dict);
+            free(col->ints);
+            free(col->floats);
+            free(col->zones);
         }
+        free(t->column_data);
     }
-    free(t->rows);
     t->rows = NULL;
+    t->deleted = NULL;
+    t->column_data = NULL;
     t->columns = NULL;
     t->num_columns = 0;
     t->num_rows = 0;
@@ -81,10 +335,21 @@ Table* find_table(Database* db, const char* name) {
             return &db->tables[i];
         }
     }
+    // Materialized views read like tables
+    for (int i = 0; i < db->num_views; i++) {
+        if (strcmp(db->views[i]->table.name, name) == 0) return &db->views[i]->table;
+    }
     return NULL;
 }
 
-static int column_index(Table* t, const char* name) {
+/* Materialized views change only through their base table. */
+static int check_writable(const Table* t) {
+    if (!t->view) return 1;
+    printf("Error: '%s' is a materialized view and cannot be changed directly.\n", t->name);
+    return 0;
+}
+
+int column_index(Table* t, const char* name) {
     for (int i = 0; i < t->num_columns; i++) {
         if (strcmp(t->columns[i].name, name) == 0) {
             return i;
@@ -124,9 +389,13 @@ int create_table(Database* db, const char* name, ColumnDef* cols, int num_cols)
         t->columns[i] = cols[i];
     }
 
+    // --- Storage layout: new tables follow the session default ---
+    t->column_major = db->column_store;
+
     // --- Initialize row-major fields ---
     t->num_rows = 0;
     t->rows = NULL;
+    arena_init(&t->arena);
 
     // --- Initialize column-major fields ---
     t->column_data = calloc(num_cols, sizeof(ColumnStorage));
@@ -140,9 +409,28 @@ int create_table(Database* db, const char* name, ColumnDef* cols, int num_cols)
         strncpy(t->column_data[i].name, cols[i].name, MAX_NAME_LEN - 1);
         t->column_data[i].type = cols[i].type;
         t->column_data[i].values = NULL;  // will grow as rows are inserted
+        if (cols[i].type == COL_TEXT && (cols[i].flags & COLUMN_DICT)) {
+            t->column_data[i].dict = dict_create();
+            if (!t->column_data[i].dict) {
+                fprintf(stderr, "Out of memory for column dictionary\n");
+                return 0;
+            }
+        }
     }
 
     db->num_tables++;
+    db->schema_version++;
+
+    // --- UNIQUE / PRIMARY KEY columns get a hash index that enforces them ---
+    for (int i = 0; i < num_cols; i++) {
+        if (!(cols[i].flags & COLUMN_UNIQUE)) continue;
+        char iname[MAX_NAME_LEN * 2 + 8];  // create_index keeps the first MAX_NAME_LEN - 1
+        snprintf(iname, sizeof(iname), "%s_%s_%s", name, cols[i].name,
+                 (cols[i].flags & COLUMN_PRIMARY_KEY) ? "pkey" : "key");
+        if (!create_index(db, iname, name, cols[i].name, INDEX_HASH)) return 0;
+        t->indexes[t->num_indexes - 1].unique = 1;
+    }
+
     printf("Table '%s' created with %d columns.\n", name, num_cols);
     return 1;
 }
@@ -151,11 +439,17 @@ int create_table(Database* db, const char* name, ColumnDef* cols, int num_cols)
 int drop_table(Database* db, const char* name) {
     for (int i = 0; i < db->num_tables; i++) {
         if (strcmp(db->tables[i].name, name) == 0) {
+            if (db->tables[i].num_views > 0) {
+                printf("Error: table '%s' has %d materialized view(s); drop them first.\n", name,
+                       db->tables[i].num_views);
+                return 0;
+            }
             free_table(&db->tables[i]);
             for (int j = i + 1; j < db->num_tables; j++) {
                 db->tables[j - 1] = db->tables[j];
             }
             db->num_tables--;
+            db->schema_version++;
 
             if (db->num_tables == 0) {
                 free(db->tables);
@@ -169,331 +463,856 @@ int drop_table(Database* db, const char* name) {
             return 1;
         }
     }
+    if (find_table(db, name)) {
+        printf("Error: '%s' is a materialized view; use DROP MATERIALIZED VIEW.\n", name);
+        return 0;
+    }
     printf("Error: table '%s' not found.\n", name);
     return 0;
 }
 
-int insert_row(Database* db, const char* table_name, char** values, int num_values) {
-    Table* t = find_table(db, table_name);
-    if (!t) {
-        printf("Error: table '%s' not found.\n", table_name);
-        return 0;
-    }
-    if (num_values != t->num_columns) {
-        printf("Error: expected %d values, got %d.\n", t->num_columns, num_values);
-        return 0;
+static int check_row_values(Table* t, char** values) {
+    for (int i = 0; i < t->num_columns; i++) {
+        if (!check_typed_value(t->columns[i].type, values[i])) {
+            printf("Error: '%s' is not a valid %s value for column '%s'.\n",
+                   values[i], column_type_to_string(t->columns[i].type), t->columns[i].name);
+            return 0;
+        }
     }
+    return 1;
+}
 
-    /* ======================================================
-       ROW-MAJOR MODE (original behavior)
-       ====================================================== */
-    if (db->column_store == 0) {
-        Row* new_rows = realloc(t->rows, sizeof(Row) * (t->num_rows + 1));
-        if (!new_rows) {
-            fprintf(stderr, "Out of memory inserting row\n");
+/* Rejects a row whose UNIQUE columns collide with a live row, including
+   rows appended earlier in the same batch. One hash probe per constraint. */
+static int check_unique(Table* t, char** values) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        Index* ix = &t->indexes[i];
+        if (!ix->unique) continue;
+        Value key;
+        value_parse(t->columns[ix->column].type, values[ix->column], &key);
+        if (index_contains(t, ix, &key, -1)) {
+            printf("Error: duplicate value '%s' for %s column '%s'.\n", values[ix->column],
+                   (t->columns[ix->column].flags & COLUMN_PRIMARY_KEY) ? "PRIMARY KEY" : "UNIQUE",
+                   t->columns[ix->column].name);
             return 0;
         }
-        t->rows = new_rows;
+    }
+    return 1;
+}
+
+/* check_unique for a typed row. */
+static int check_unique_values(Table* t, const Value* values) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        Index* ix = &t->indexes[i];
+        if (!ix->unique || !index_contains(t, ix, &values[ix->column], -1)) continue;
+        char buf[64];
+        printf("Error: duplicate value '%s' for %s column '%s'.\n",
+               value_text(&values[ix->column], buf, sizeof(buf)),
+               (t->columns[ix->column].flags & COLUMN_PRIMARY_KEY) ? "PRIMARY KEY" : "UNIQUE",
+               t->columns[ix->column].name);
+        return 0;
+    }
+    return 1;
+}
+
+static int has_unique(const Table* t) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        if (t->indexes[i].unique) return 1;
+    }
+    return 0;
+}
+
+/* Undoes a partially appended batch: rows from first on leave every index
+   and the row count drops back. Their bytes stay in the arena. */
+static void truncate_rows(Table* t, int first) {
+    for (int r = first; r < t->num_rows; r++) {
+        for (int i = 0; i < t->num_indexes; i++) index_remove(t, &t->indexes[i], r);
+    }
+    t->num_rows = first;
+    if (t->column_major && first % ZONE_ROWS != 0) {
+        for (int c = 0; c < t->num_columns; c++) zone_refresh_block(t, c, first / ZONE_ROWS);
+    }
+}
+
+//Folds rows appended from first on into the table's views
+static void view_new_rows(Table* t, int first) {
+    for (int r = first; t->num_views > 0 && r < t->num_rows; r++) views_note_row(t, r, 1, -1);
+}
 
-        Row* r = &t->rows[t->num_rows];
-        r->values = malloc(sizeof(char*) * t->num_columns);
-        if (!r->values) {
-            fprintf(stderr, "Out of memory inserting row values\n");
+//Adds row to every index; 0 on out of memory, with the indexes before it already holding the row
+static int index_new_row(Table* t, int row) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        if (!index_insert(t, &t->indexes[i], row)) {
+            fprintf(stderr, "Out of memory maintaining index '%s'.\n", t->indexes[i].name);
             return 0;
         }
+    }
+    return 1;
+}
 
-        for (int i = 0; i < t->num_columns; i++) {
-            r->values[i] = str_duplicate(values[i]);
-        }
+/* Appends already validated rows in the active layout, from text cells or,
+   when typed is set instead, from values in each column's type. Capacity is
+   reserved once for the whole batch, so each row is a plain store. A UNIQUE
+   violation, or an index running out of memory, rolls the whole batch back. */
+static int append_rows(Table* t, char*** rows, Value** typed, int nrows) {
+    if (!table_reserve(t, t->column_major, t->num_rows + nrows)) {
+        fprintf(stderr, "Out of memory inserting into '%s'.\n", t->name);
+        return 0;
+    }
+    int first = t->num_rows;
+    int unique = has_unique(t);
+    t->write_version++;
 
-        t->num_rows++;
-        printf("1 row inserted into '%s' (row-major mode).\n", table_name);
+    /* ======================================================
+       ROW-MAJOR MODE (original behavior)
+       ====================================================== */
+    if (!t->column_major) {
+        char buf[64];
+        for (int k = 0; k < nrows; k++) {
+            if (unique && !(typed ? check_unique_values(t, typed[k]) : check_unique(t, rows[k]))) {
+                truncate_rows(t, first);
+                return 0;
+            }
+            Row* r = &t->rows[t->num_rows];
+            r->values = arena_alloc(&t->arena, sizeof(char*) * (size_t)t->num_columns);
+            for (int i = 0; i < t->num_columns; i++) {
+                // Row-major cells are text, so typed values are rendered once here
+                const char* cell = typed ? value_text(&typed[k][i], buf, sizeof(buf)) : rows[k][i];
+                r->values[i] = arena_strdup(&t->arena, cell);
+            }
+            // Counted first so truncate_rows also takes it out of the indexes
+            t->num_rows++;
+            if (!index_new_row(t, t->num_rows - 1)) {
+                truncate_rows(t, first);
+                return 0;
+            }
+        }
+        view_new_rows(t, first);
         return 1;
     }
 
     /* ======================================================
-       COLUMN-MAJOR MODE (new cache-friendly layout)
+       COLUMN-MAJOR MODE (typed, contiguous vectors)
        ====================================================== */
-    else {
-        if (!t->column_data) {
-            fprintf(stderr, "Error: column storage not initialized for table '%s'.\n", t->name);
+    for (int k = 0; k < nrows; k++) {
+        if (unique && !(typed ? check_unique_values(t, typed[k]) : check_unique(t, rows[k]))) {
+            truncate_rows(t, first);
             return 0;
         }
-
         for (int i = 0; i < t->num_columns; i++) {
-            ColumnStorage* col = &t->column_data[i];
-
-            // Grow the column array by one entry
-            char** new_vals = realloc(col->values, sizeof(char*) * (t->num_rows + 1));
-            if (!new_vals) {
-                fprintf(stderr, "Out of memory inserting into column '%s'.\n", col->name);
-                return 0;
+            if (typed) {
+                column_store_typed(&t->arena, &t->column_data[i], t->num_rows, &typed[k][i]);
+            } else {
+                column_store_value(&t->arena, &t->column_data[i], t->num_rows, rows[k][i]);
             }
-            col->values = new_vals;
-
-            // Copy the new value into the column
-            col->values[t->num_rows] = str_duplicate(values[i]);
+            zone_note_row(&t->column_data[i], t->num_rows);
         }
-
         t->num_rows++;
-        printf("1 row inserted into '%s' (column-major mode).\n", table_name);
-        return 1;
+        if (!index_new_row(t, t->num_rows - 1)) {
+            truncate_rows(t, first);
+            return 0;
+        }
     }
+    view_new_rows(t, first);
+    return 1;
 }
 
+int insert_row(Database* db, const char* table_name, char** values, int num_values) {
+    Table* t = find_table(db, table_name);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", table_name);
+        return 0;
+    }
+    if (!check_writable(t)) return 0;
+    if (num_values != t->num_columns) {
+        printf("Error: expected %d values, got %d.\n", t->num_columns, num_values);
+        return 0;
+    }
+    if (!check_row_values(t, values)) return 0;
+    if (!append_rows(t, &values, NULL, 1)) return 0;
 
-/* ===== SELECT ===== */
+    printf("1 row inserted into '%s' (%s mode).\n", table_name,
+           t->column_major ? "column-major" : "row-major");
+    return 1;
+}
 
-static void print_header(Table* t, int* cols, int num_cols) {
-    for (int i = 0; i < num_cols; i++) {
-        int idx = cols[i];
-        printf("%s", t->columns[idx].name);
-        if (i < num_cols - 1) printf(" | ");
+int insert_rows_quiet(Table* t, char*** rows, int nrows) {
+    if (!check_writable(t)) return 0;
+    // The whole batch is validated up front so a bad row inserts nothing
+    for (int k = 0; k < nrows; k++) {
+        if (!check_row_values(t, rows[k])) {
+            printf("Error: row %d rejected, no rows inserted.\n", k + 1);
+            return 0;
+        }
     }
-    printf("\n");
+    return append_rows(t, rows, NULL, nrows);
 }
 
-static void print_row(Table* t, Row* r, int* cols, int num_cols) {
-    (void)t;
-    for (int i = 0; i < num_cols; i++) {
-        int idx = cols[i];
-        printf("%s", r->values[idx] ? r->values[idx] : "NULL");
-        if (i < num_cols - 1) printf(" | ");
-    }
-    printf("\n");
+int insert_values_quiet(Table* t, Value** rows, int nrows) {
+    if (!check_writable(t)) return 0;
+    return append_rows(t, NULL, rows, nrows);
 }
 
-int select_all(Database* db, const char* table_name) {
+int insert_rows(Database* db, const char* table_name, char*** rows, int nrows) {
     Table* t = find_table(db, table_name);
     if (!t) {
         printf("Error: table '%s' not found.\n", table_name);
         return 0;
     }
-    if (db->column_store == 1) {
-    // --- COLUMN-MAJOR FAST PATH ---
-    Table* t = find_table(db, table_name);
-    if (!t) return;
+    if (!insert_rows_quiet(t, rows, nrows)) return 0;
 
-    for (int r = 0; r < t->num_rows; r++) {
-        for (int c = 0; c < t->num_columns; c++) {
-            printf("%s\t", t->column_data[c].values[r]);
-        }
-        printf("\n");
+    printf("%d row(s) inserted into '%s' (%s mode).\n", nrows, table_name,
+           t->column_major ? "column-major" : "row-major");
+    return 1;
+}
+
+
+/* ===== SELECT ===== */
+
+static void print_header(ResultWriter* w, OutputMode mode, const Table* t, const int* cols, int num_cols) {
+    writer_begin(w, mode, num_cols);
+    for (int i = 0; i < num_cols; i++) writer_column(w, t->columns[cols[i]].name, t->columns[cols[i]].type);
+}
+
+static void print_rows(ResultWriter* w, const Table* t, const Batch* b, const int* cols, int num_cols) {
+    for (int k = 0; k < b->count; k++) {
+        for (int i = 0; i < num_cols; i++) writer_cell(w, t, b->sel[k], cols[i]);
     }
-    return;
+}
+
+//Where print_batch sends its rows
+typedef struct {
+    ResultWriter* w;
+    const int* cols;
+} PrintState;
+
+static int print_batch(BatchSink* self, const Table* t, const Batch* b,
+                       const VectorView* cols, int num_cols) {
+    (void)cols;
+    PrintState* ps = self->state;
+    print_rows(ps->w, t, b, ps->cols, num_cols);
+    return 1;
+}
+
+//Row ids gathered by collect_batch, sized for every row slot
+typedef struct {
+    int* rows;
+    int count;
+} CollectState;
+
+static int collect_batch(BatchSink* self, const Table* t, const Batch* b,
+                         const VectorView* cols, int num_cols) {
+    (void)t;
+    (void)cols;
+    (void)num_cols;
+    CollectState* st = self->state;
+    memcpy(st->rows + st->count, b->sel, sizeof(int) * (size_t)b->count);
+    st->count += b->count;
+    return 1;
+}
+
+/* Resolves column names to positions; prints the error and returns NULL on
+   an unknown name. */
+int* resolve_columns(Table* t, char** cols, int num_cols) {
+    int* idxs = malloc(sizeof(int) * (size_t)(num_cols > 0 ? num_cols : 1));
+    if (!idxs) return NULL;
+    for (int i = 0; i < num_cols; i++) {
+        int idx = cols ? column_index(t, cols[i]) : i;
+        if (idx < 0) {
+            printf("Error: unknown column '%s'.\n", cols[i]);
+            free(idxs);
+            return NULL;
+        }
+        idxs[i] = idx;
     }
-    int* cols = malloc(sizeof(int) * t->num_columns);
-    if (!cols) return 0;
-    for (int i = 0; i < t->num_columns; i++) cols[i] = i;
+    return idxs;
+}
 
-    print_header(t, cols, t->num_columns);
-    for (int r = 0; r < t->num_rows; r++) {
-        print_row(t, &t->rows[r], cols, t->num_columns);
+static void init_spec(ScanSpec* spec) {
+    memset(spec, 0, sizeof(ScanSpec));
+    spec->filter_col = -1;
+    spec->limit = -1;
+}
+
+/* Plans a scan narrowed to col's range: an index probe when plan_access
+   picks one (spec->rows then owns the allocated row list), otherwise a
+   filtered table scan. valid = 0 (a literal the column type can never hold) plans no rows.
+   A B+tree range probe stops after cap keys (-1 = all) when the caller
+   needs no more. Returns 0 if memory runs out. */
+static int plan_range(Table* t, int col, const KeyRange* range, int valid, int64_t cap, ScanSpec* spec) {
+    if (!valid) {
+        spec->rows = malloc(sizeof(int));
+        spec->num_rows = 0;
+        return spec->rows != NULL;
     }
 
-    free(cols);
+    // The cheaper of an index probe and a scan, or any usable index without statistics
+    Index* ix;
+    plan_access(t, col, range, cap, &ix);
+    if (ix) {
+        int point = range->has_lo && range->has_hi && range->lo_incl && range->hi_incl &&
+                    value_equals(&range->lo, &range->hi);
+        int* rows = malloc(sizeof(int) * (size_t)(t->num_rows > 0 ? t->num_rows : 1));
+        if (!rows) return 0;
+        int max = cap >= 0 && cap < t->num_rows ? (int)cap : -1;
+        spec->num_rows = point ? index_lookup(t, ix, &range->lo, rows)
+                               : index_range(t, ix, range, max, rows);
+        spec->rows = rows;
+        return 1;
+    }
+    spec->filter_col = col;
+    spec->filter = *range;
     return 1;
 }
 
-int select_columns(Database* db, const char* table_name, char** cols, int num_cols) {
-    Table* t = find_table(db, table_name);
-    if (!t) {
-        printf("Error: table '%s' not found.\n", table_name);
+/* plan_range for a parsed comparison; 0 also if its column is unknown. */
+static int plan_condition(Table* t, const Condition* cond, int64_t cap, ScanSpec* spec) {
+    init_spec(spec);
+    if (!cond) return 1;
+
+    int where_idx = column_index(t, cond->column);
+    if (where_idx < 0) {
+        printf("Error: unknown column '%s' in WHERE.\n", cond->column);
         return 0;
     }
-    if (db->column_store == 1) {
-    Table* t = find_table(db, table_name);
-    if (!t) return;
+    KeyRange range;
+    int valid = condition_range(t->columns[where_idx].type, cond, &range);
+    return plan_range(t, where_idx, &range, valid, cap, spec);
+}
 
-    // 1. Print header
-    for (int i = 0; i < num_cols; i++) {
-        printf("%s\t", cols[i]);
+/* Plans a compiled program from its predicates' current bounds: the
+   driving predicate (one reachable through AND only, whose matches are a
+   superset of the result) narrows the scan through an index, the zone maps
+   or a kernel, and the program filters what remains. A conjunction may be
+   driven by any of its predicates; plan_order picks one and the refine
+   order. A lone predicate is the whole filter, so its range probe may stop
+   at cap keys. */
+static int plan_compiled(Table* t, WhereProgram* prog, int64_t cap, ScanSpec* spec) {
+    init_spec(spec);
+    plan_order(t, prog);
+    prog->driven = 0;
+    int drive = prog->conjunctive ? prog->order[0] : prog->drive;
+    if (drive >= 0) {
+        const Predicate* d = &prog->preds[drive];
+        int lone = prog->num_code == 1;
+        if (!plan_range(t, d->col, &d->range, !d->empty, lone ? cap : -1, spec)) return 0;
+        if (lone) return 1;
+        // A conjunction's driver runs first in its order, exactly what the plan applies
+        prog->driven = prog->conjunctive;
     }
-    printf("\n");
+    spec->where = prog;
+    return 1;
+}
 
-    // 2. Locate each requested column
-    int col_idx[num_cols];
-    for (int i = 0; i < num_cols; i++) {
-        col_idx[i] = find_column_index(t, cols[i]);  // you must already have this helper
-        if (col_idx[i] < 0) {
-            printf("Unknown column: %s\n", cols[i]);
-            return;
-        }
-    }
+static void apply_limit(ScanSpec* spec, const RowLimit* limit) {
+    if (!limit) return;
+    spec->offset = limit->offset;
+    spec->limit = limit->count;
+}
 
-    // 3. Print rows
-    for (int r = 0; r < t->num_rows; r++) {
-        for (int i = 0; i < num_cols; i++) {
-            printf("%s\t", t->column_data[col_idx[i]].values[r]);
+/* Plans a WHERE expression. A lone comparison goes through plan_condition;
+   a compound one compiles into prog, which runs on every batch, while its
+   driving comparison may still narrow the scan. With limit, the spec
+   carries OFFSET and LIMIT and a lone comparison's range probe reads only
+   the keys they can reach. Release with release_plan. */
+int plan_limited(Table* t, const Expr* where, const RowLimit* limit,
+                 ScanSpec* spec, WhereProgram* prog) {
+    memset(prog, 0, sizeof(WhereProgram));
+    int64_t cap = limit && limit->count >= 0 ? limit->offset + limit->count : -1;
+    if (!where || where->kind == EXPR_CMP) {
+        if (!plan_condition(t, where ? &where->cmp : NULL, cap, spec)) return 0;
+    } else {
+        if (!where_compile(t, where, prog)) return 0;
+        if (!plan_compiled(t, prog, cap, spec)) {
+            where_free(prog);
+            return 0;
         }
-        printf("\n");
     }
+    apply_limit(spec, limit);
+    return 1;
+}
+
+int plan_program(Table* t, WhereProgram* prog, const RowLimit* limit, ScanSpec* spec) {
+    int64_t cap = limit && limit->count >= 0 ? limit->offset + limit->count : -1;
+    if (!prog) init_spec(spec);
+    else if (!plan_compiled(t, prog, cap, spec)) return 0;
+    apply_limit(spec, limit);
+    return 1;
+}
 
-    return;
+int plan_where(Table* t, const Expr* where, ScanSpec* spec, WhereProgram* prog) {
+    return plan_limited(t, where, NULL, spec, prog);
+}
+
+void release_plan(ScanSpec* spec, WhereProgram* prog) {
+    free((int*)spec->rows);
+    spec->rows = NULL;
+    where_free(prog);
+}
+
+/* Finds the live rows matching where: an index probe when one applies,
+   otherwise the batch pipeline with a collecting sink. *out is allocated
+   for the caller; returns the match count, or -1 on a bad column or out of
+   memory. */
+static int match_where(Table* t, const Expr* where, int** out) {
+    *out = NULL;
+    ScanSpec spec;
+    WhereProgram prog;
+    if (!plan_where(t, where, &spec, &prog)) return -1;
+    if (spec.rows && !spec.where) {
+        *out = (int*)spec.rows;
+        return spec.num_rows;
     }
-    int* idxs = malloc(sizeof(int) * num_cols);
-    if (!idxs) return 0;
 
-    for (int i = 0; i < num_cols; i++) {
-        int idx = column_index(t, cols[i]);
-        if (idx < 0) {
-            printf("Error: unknown column '%s'.\n", cols[i]);
-            free(idxs);
-            return 0;
-        }
-        idxs[i] = idx;
+    CollectState st = { malloc(sizeof(int) * (size_t)(t->num_rows > 0 ? t->num_rows : 1)), 0 };
+    BatchSink sink = { collect_batch, &st, NULL, NULL };
+    if (!st.rows || !pipeline_run(t, &spec, &sink)) {
+        free(st.rows);
+        release_plan(&spec, &prog);
+        return -1;
     }
+    release_plan(&spec, &prog);
+    *out = st.rows;
+    return st.count;
+}
 
-    print_header(t, idxs, num_cols);
-    for (int r = 0; r < t->num_rows; r++) {
-        print_row(t, &t->rows[r], idxs, num_cols);
+static void fill_where_eq(Expr* e, const char* col, const char* val) {
+    memset(e, 0, sizeof(Expr));
+    e->kind = EXPR_CMP;
+    strncpy(e->cmp.column, col, MAX_NAME_LEN - 1);
+    strncpy(e->cmp.value, val, MAX_VALUE_LEN - 1);
+    e->cmp.op = CMP_EQ;
+}
+
+/* The shared SELECT core: plan, print the header, stream batches to the
+   writer. A large scan runs on the morsel pool, whose in-order merge keeps
+   the rows in table order. */
+static int run_select(Database* db, const char* table_name, char** cols, int num_cols,
+                      const Expr* where, const RowLimit* limit) {
+    Table* t = find_table(db, table_name);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", table_name);
+        return 0;
     }
+    if (!cols) num_cols = t->num_columns;
+    int* idxs = resolve_columns(t, cols, num_cols);
+    if (!idxs) return 0;
 
+    ScanSpec spec;
+    WhereProgram prog;
+    int ok = plan_limited(t, where, limit, &spec, &prog);
+    if (ok) {
+        spec.cols = idxs;
+        spec.num_cols = num_cols;
+        ResultWriter w;
+        print_header(&w, db->output_mode, t, idxs, num_cols);
+        PrintState ps = { &w, idxs };
+        BatchSink sink = { print_batch, &ps, NULL, NULL };
+        ok = pipeline_run(t, &spec, &sink);
+        writer_end(&w);
+        if (!ok) fprintf(stderr, "Out of memory scanning '%s'.\n", table_name);
+        release_plan(&spec, &prog);
+    }
     free(idxs);
-    return 1;
+    return ok;
+}
+
+int select_all(Database* db, const char* table_name, const RowLimit* limit) {
+    return run_select(db, table_name, NULL, 0, NULL, limit);
+}
+
+int select_columns(Database* db, const char* table_name, char** cols, int num_cols,
+                   const RowLimit* limit) {
+    return run_select(db, table_name, cols, num_cols, NULL, limit);
 }
 
 int select_where_eq(Database* db, const char* table_name,
                     char** cols, int num_cols,
-                    const char* where_col, const char* where_val) {
-    if (db->column_store == 1) {
+                    const char* where_col, const char* where_val, const RowLimit* limit) {
+    Expr where;
+    fill_where_eq(&where, where_col, where_val);
+    return select_where(db, table_name, cols, num_cols, &where, limit);
+}
+
+int select_where(Database* db, const char* table_name,
+                 char** cols, int num_cols, const Expr* where, const RowLimit* limit) {
+    return run_select(db, table_name, cols, num_cols, where, limit);
+}
+
+int select_ordered(Database* db, const char* table_name, char** cols, int num_cols,
+                   const Expr* where, const OrderBy* order, const RowLimit* limit) {
     Table* t = find_table(db, table_name);
-    if (!t) return;
+    if (!t) {
+        printf("Error: table '%s' not found.\n", table_name);
+        return 0;
+    }
+    int key = column_index(t, order->column);
+    if (key < 0) {
+        printf("Error: unknown column '%s' in ORDER BY.\n", order->column);
+        return 0;
+    }
+    int* idxs = resolve_columns(t, cols, num_cols);
+    if (!idxs) return 0;
 
-    int where_col = find_column_index(t, where_col);
-    if (where_col < 0) {
-        printf("Unknown WHERE column: %s\n", where_col);
-        return;
+    ScanSpec spec;
+    WhereProgram prog;
+    // A range probe comes back in the WHERE column's order, so it is not capped here
+    int ok = plan_where(t, where, &spec, &prog);
+    if (ok) {
+        spec.cols = idxs;
+        spec.num_cols = num_cols;
+        if (limit) {
+            spec.offset = limit->offset;
+            spec.limit = limit->count;
+        }
+        /* A B+tree on the key already holds the rows in order. Its walk pays
+           off under a LIMIT, where it stops early, or when nothing is
+           filtered; a selective scan sorts fewer rows than the tree holds. */
+        Index* ix = spec.rows ? NULL : table_find_ordered_index(t, key);
+        if (ix && spec.limit < 0 && (spec.filter_col >= 0 || spec.where)) ix = NULL;
+        ResultWriter w;
+        print_header(&w, db->output_mode, t, idxs, num_cols);
+        PrintState ps = { &w, idxs };
+        BatchSink sink = { print_batch, &ps, NULL, NULL };
+        ok = ix ? pipeline_run_indexed(t, &spec, ix, order->desc, &sink)
+                : pipeline_run_sorted(t, &spec, key, order->desc, &sink);
+        writer_end(&w);
+        if (!ok) fprintf(stderr, "Out of memory or temporary file error sorting '%s'.\n", table_name);
+        release_plan(&spec, &prog);
     }
+    free(idxs);
+    return ok;
+}
 
-    // Map selected columns
-    int col_idx[num_cols];
-    for (int i = 0; i < num_cols; i++) {
-        col_idx[i] = find_column_index(t, cols[i]);
-        if (col_idx[i] < 0) {
-            printf("Unknown column: %s\n", cols[i]);
-            return;
+/* ===== DELETE / UPDATE ===== */
+
+static void mark_deleted(Table* t, int r) {
+    if (!table_row_deleted(t, r)) {
+        t->deleted[r >> 6] |= (uint64_t)1 << (r & 63);
+        t->num_deleted++;
+    }
+}
+
+/* Makes sure the deletion bitmap covers every row slot. */
+static int ensure_deleted_bitmap(Table* t) {
+    int words = (t->num_rows + 63) / 64;
+    if (t->deleted && t->deleted_words >= words) return 1;
+    if (words < 1) words = 1;
+    uint64_t* tmp = realloc(t->deleted, sizeof(uint64_t) * (size_t)words);
+    if (!tmp) return 0;
+    memset(tmp + t->deleted_words, 0, sizeof(uint64_t) * (size_t)(words - t->deleted_words));
+    t->deleted = tmp;
+    t->deleted_words = words;
+    return 1;
+}
+
+int vacuum_table(Table* t) {
+    if (t->num_deleted == 0) return 0;
+
+    // One sweep: live rows slide down and their bytes move to a fresh arena
+    Arena fresh;
+    arena_init(&fresh);
+    int w = 0;
+    if (!t->column_major) {
+        for (int r = 0; r < t->num_rows; r++) {
+            if (table_row_deleted(t, r)) continue;
+            char** vals = arena_alloc(&fresh, sizeof(char*) * (size_t)t->num_columns);
+            for (int c = 0; c < t->num_columns; c++) {
+                vals[c] = arena_strdup(&fresh, t->rows[r].values[c]);
+            }
+            t->rows[w++].values = vals;
+        }
+    } else {
+        for (int c = 0; c < t->num_columns; c++) {
+            ColumnStorage* col = &t->column_data[c];
+            if (col->dict) dict_move_strings(col->dict, &fresh);
+            w = 0;
+            for (int r = 0; r < t->num_rows; r++) {
+                if (table_row_deleted(t, r)) continue;
+                switch (col->type) {
+                    case COL_INT:   col->ints[w] = col->ints[r]; break;
+                    case COL_FLOAT: col->floats[w] = col->floats[r]; break;
+                    default:
+                        if (col->dict) {
+                            col->codes[w] = col->codes[r];
+                        } else {
+                            col->values[w] = arena_strdup(&fresh, col->values[r]);
+                        }
+                        break;
+                }
+                w++;
+            }
         }
     }
 
-    // Print matching rows
-    for (int r = 0; r < t->num_rows; r++) {
-        if (strcmp(t->column_data[where_col].values[r], where_val) == 0) {
-            for (int i = 0; i < num_cols; i++) {
-                printf("%s\t", t->column_data[col_idx[i]].values[r]);
+    int removed = t->num_rows - w;
+    arena_free(&t->arena);
+    t->arena = fresh;
+    t->num_rows = w;
+    t->num_deleted = 0;
+    memset(t->deleted, 0, sizeof(uint64_t) * (size_t)t->deleted_words);
+    table_rebuild_zones(t);
+    table_rebuild_indexes(t);  // row ids moved
+    return removed;
+}
+
+int set_table_layout(Table* t, int column_major) {
+    if (t->column_major == column_major) return 1;
+    if (!table_reserve(t, column_major, t->num_rows)) return 0;
+    t->write_version++;  // cells print differently once typed
+
+    // Single transpose pass over the live rows; cell bytes stay in the arena
+    int w = 0;
+    char buf[64];
+    if (column_major) {
+        for (int r = 0; r < t->num_rows; r++) {
+            if (table_row_deleted(t, r)) continue;
+            char** vals = t->rows[r].values;
+            for (int c = 0; c < t->num_columns; c++) {
+                ColumnStorage* col = &t->column_data[c];
+                if (col->type == COL_TEXT && !col->dict) {
+                    col->values[w] = vals[c];
+                } else if (!column_store_value(&t->arena, col, w, vals[c])) {
+                    return 0;
+                }
+            }
+            w++;
+        }
+        free(t->rows);
+        t->rows = NULL;
+        t->row_capacity = 0;
+    } else {
+        for (int r = 0; r < t->num_rows; r++) {
+            if (table_row_deleted(t, r)) continue;
+            char** vals = arena_alloc(&t->arena, sizeof(char*) * (size_t)t->num_columns);
+            for (int c = 0; c < t->num_columns; c++) {
+                ColumnStorage* col = &t->column_data[c];
+                const char* v = column_cell_text(col, r, buf, sizeof(buf));
+                // TEXT cells are already arena strings; only numbers need formatting
+                vals[c] = col->type == COL_TEXT ? (char*)v : arena_strdup(&t->arena, v);
             }
-            printf("\n");
+            t->rows[w++].values = vals;
+        }
+        for (int c = 0; c < t->num_columns; c++) {
+            ColumnStorage* col = &t->column_data[c];
+            free(col->values);
+            free(col->codes);
+            free(col->ints);
+            free(col->floats);
+            free(col->zones);
+            col->zones = NULL;
+            col->values = NULL;
+            col->codes = NULL;
+            col->ints = NULL;
+            col->floats = NULL;
+            col->capacity = 0;
         }
     }
 
-    return;
-}  
+    t->num_rows = w;
+    t->num_deleted = 0;
+    if (t->deleted) memset(t->deleted, 0, sizeof(uint64_t) * (size_t)t->deleted_words);
+    t->column_major = column_major;
+    table_rebuild_zones(t);
+    return table_rebuild_indexes(t);
+}
+
+int delete_where_eq(Database* db, const char* table_name,
+                    const char* where_col, const char* where_val) {
+    Expr where;
+    fill_where_eq(&where, where_col, where_val);
+    return delete_where(db, table_name, &where);
+}
+
+int delete_where(Database* db, const char* table_name, const Expr* where) {
     Table* t = find_table(db, table_name);
     if (!t) {
         printf("Error: table '%s' not found.\n", table_name);
         return 0;
     }
-    int where_idx = column_index(t, where_col);
-    if (where_idx < 0) {
-        printf("Error: unknown column '%s' in WHERE.\n", where_col);
+    if (!check_writable(t)) return 0;
+    if (!ensure_deleted_bitmap(t)) {
+        fprintf(stderr, "Out of memory deleting from '%s'.\n", table_name);
         return 0;
     }
 
-    int* idxs = malloc(sizeof(int) * num_cols);
-    if (!idxs) return 0;
-    for (int i = 0; i < num_cols; i++) {
-        int idx = column_index(t, cols[i]);
-        if (idx < 0) {
-            printf("Error: unknown column '%s'.\n", cols[i]);
-            free(idxs);
-            return 0;
-        }
-        idxs[i] = idx;
+    // Deleting only sets tombstone bits; rows are reclaimed by vacuum_table
+    int* matches = NULL;
+    int removed = match_where(t, where, &matches);
+    if (removed < 0) {
+        free(matches);
+        return 0;
     }
-
-    print_header(t, idxs, num_cols);
-    for (int r = 0; r < t->num_rows; r++) {
-        char* v = t->rows[r].values[where_idx];
-        if (v && strcmp(v, where_val) == 0) {
-            print_row(t, &t->rows[r], idxs, num_cols);
-        }
+    for (int k = 0; k < removed; k++) {
+        for (int i = 0; i < t->num_indexes; i++) index_remove(t, &t->indexes[i], matches[k]);
+        views_note_row(t, matches[k], -1, -1);
+        mark_deleted(t, matches[k]);
     }
+    if (removed > 0) t->write_version++;
+    table_refresh_zones(t, -1, matches, removed);
+    free(matches);
 
-    free(idxs);
+    printf("%d row(s) deleted from '%s'.\n", removed, table_name);
+
+    // Compact once dead rows make up a large enough share of the table
+    if (t->num_deleted >= AUTO_VACUUM_MIN_DEAD &&
+        t->num_deleted >= t->num_rows / AUTO_VACUUM_DEAD_FRACTION) {
+        vacuum_table(t);
+    }
     return 1;
 }
 
-/* ===== DELETE / UPDATE ===== */
-
-int delete_where_eq(Database* db, const char* table_name,
+int update_where_eq(Database* db, const char* table_name,
+                    const char* set_col, const char* set_val,
                     const char* where_col, const char* where_val) {
+    Expr where;
+    fill_where_eq(&where, where_col, where_val);
+    return update_where(db, table_name, set_col, set_val, &where);
+}
+
+int update_where(Database* db, const char* table_name,
+                 const char* set_col, const char* set_val, const Expr* where) {
     Table* t = find_table(db, table_name);
     if (!t) {
         printf("Error: table '%s' not found.\n", table_name);
         return 0;
     }
 
-    int where_idx = column_index(t, where_col);
-    if (where_idx < 0) {
-        printf("Error: unknown column '%s' in WHERE.\n", where_col);
+    if (!check_writable(t)) return 0;
+    int set_idx = column_index(t, set_col);
+    if (set_idx < 0) {
+        printf("Error: unknown column in UPDATE.\n");
         return 0;
     }
 
-    int removed = 0;
-    for (int r = 0; r < t->num_rows; ) {
-        char* v = t->rows[r].values[where_idx];
-        if (v && strcmp(v, where_val) == 0) {
-            for (int c = 0; c < t->num_columns; c++) {
-                free(t->rows[r].values[c]);
-            }
-            free(t->rows[r].values);
+    if (!check_typed_value(t->columns[set_idx].type, set_val)) {
+        printf("Error: '%s' is not a valid %s value for column '%s'.\n",
+               set_val, column_type_to_string(t->columns[set_idx].type), set_col);
+        return 0;
+    }
 
-            for (int j = r + 1; j < t->num_rows; j++) {
-                t->rows[j - 1] = t->rows[j];
-            }
-            t->num_rows--;
-            removed++;
-        } else {
-            r++;
+    int* matches = NULL;
+    int n = match_where(t, where, &matches);
+    if (n < 0) {
+        free(matches);
+        return 0;
+    }
+
+    // A UNIQUE column can take the new value on one row, and only if no other row holds it
+    if (t->columns[set_idx].flags & COLUMN_UNIQUE) {
+        Index* ux = NULL;
+        for (int i = 0; i < t->num_indexes; i++) {
+            if (t->indexes[i].unique && t->indexes[i].column == set_idx) ux = &t->indexes[i];
+        }
+        Value key;
+        value_parse(t->columns[set_idx].type, set_val, &key);
+        if (n > 1 || (n == 1 && ux && index_contains(t, ux, &key, matches[0]))) {
+            printf("Error: duplicate value '%s' for %s column '%s'.\n", set_val,
+                   (t->columns[set_idx].flags & COLUMN_PRIMARY_KEY) ? "PRIMARY KEY" : "UNIQUE",
+                   set_col);
+            free(matches);
+            return 0;
         }
     }
 
-    if (removed > 0) {
-        Row* tmp = realloc(t->rows, sizeof(Row) * t->num_rows);
-        if (tmp || t->num_rows == 0) t->rows = tmp;
+    // The new value is converted once: parsed, interned or copied
+    ColumnStorage* col = &t->column_data[set_idx];
+    int64_t iv = 0;
+    double fv = 0.0;
+    int code = 0;
+    char* sv = NULL;
+    if (n > 0) {
+        parse_int_value(set_val, &iv);
+        parse_float_value(set_val, &fv);
+        int oom = 0;
+        if (t->column_major && col->dict) {
+            code = dict_intern(col->dict, &t->arena, set_val);
+            oom = code < 0;
+        } else if (!t->column_major || col->type == COL_TEXT) {
+            // Old values are abandoned in the arena until the next vacuum
+            sv = arena_strdup(&t->arena, set_val);
+            oom = set_val && !sv;
+        }
+        if (oom) {
+            fprintf(stderr, "Out of memory updating '%s'.\n", table_name);
+            free(matches);
+            return 0;
+        }
     }
 
-    printf("%d row(s) deleted from '%s'.\n", removed, table_name);
+    for (int k = 0; k < n; k++) {
+        int r = matches[k];
+        views_note_row(t, r, -1, set_idx);
+        for (int i = 0; i < t->num_indexes; i++) {
+            if (t->indexes[i].column == set_idx) index_remove(t, &t->indexes[i], r);
+        }
+        if (!t->column_major) {
+            t->rows[r].values[set_idx] = sv;
+        } else {
+            switch (col->type) {
+                case COL_INT:   col->ints[r] = iv; break;
+                case COL_FLOAT: col->floats[r] = fv; break;
+                default:
+                    if (col->dict) {
+                        col->codes[r] = (uint32_t)code;
+                    } else {
+                        col->values[r] = sv;
+                    }
+                    break;
+            }
+        }
+        for (int i = 0; i < t->num_indexes; i++) {
+            if (t->indexes[i].column == set_idx) index_insert(t, &t->indexes[i], r);
+        }
+        views_note_row(t, r, 1, set_idx);
+    }
+    table_refresh_zones(t, set_idx, matches, n);
+    free(matches);
+    if (n > 0) t->write_version++;
+
+    printf("%d row(s) updated in '%s'.\n", n, table_name);
     return 1;
 }
 
-int update_where_eq(Database* db, const char* table_name,
-                    const char* set_col, const char* set_val,
-                    const char* where_col, const char* where_val) {
+int create_index(Database* db, const char* index_name, const char* table_name,
+                 const char* col_name, int kind) {
+    for (int i = 0; i < db->num_tables; i++) {
+        for (int j = 0; j < db->tables[i].num_indexes; j++) {
+            if (strcmp(db->tables[i].indexes[j].name, index_name) == 0) {
+                printf("Error: index '%s' already exists.\n", index_name);
+                return 0;
+            }
+        }
+    }
     Table* t = find_table(db, table_name);
     if (!t) {
         printf("Error: table '%s' not found.\n", table_name);
         return 0;
     }
-
-    int where_idx = column_index(t, where_col);
-    int set_idx   = column_index(t, set_col);
-    if (where_idx < 0 || set_idx < 0) {
-        printf("Error: unknown column in UPDATE.\n");
+    if (!check_writable(t)) return 0;
+    int col = column_index(t, col_name);
+    if (col < 0) {
+        printf("Error: unknown column '%s'.\n", col_name);
         return 0;
     }
 
-    int updated = 0;
-    for (int r = 0; r < t->num_rows; r++) {
-        char* v = t->rows[r].values[where_idx];
-        if (v && strcmp(v, where_val) == 0) {
-            free(t->rows[r].values[set_idx]);
-            t->rows[r].values[set_idx] = str_duplicate(set_val);
-            updated++;
-        }
+    Index* tmp = realloc(t->indexes, sizeof(Index) * (size_t)(t->num_indexes + 1));
+    if (!tmp) {
+        fprintf(stderr, "Out of memory creating index\n");
+        return 0;
     }
-
-    printf("%d row(s) updated in '%s'.\n", updated, table_name);
+    t->indexes = tmp;
+    Index* ix = &t->indexes[t->num_indexes];
+    memset(ix, 0, sizeof(Index));
+    strncpy(ix->name, index_name, MAX_NAME_LEN - 1);
+    ix->column = col;
+    ix->kind = kind;
+    if (!index_build(t, ix)) {
+        fprintf(stderr, "Out of memory building index '%s'\n", index_name);
+        return 0;
+    }
+    t->num_indexes++;
+    t->write_version++;  // a probe can return rows in another order
     return 1;
 }
 
@@ -502,9 +1321,15 @@ int update_where_eq(Database* db, const char* table_name,
 void list_tables(Database* db) {
     printf("Tables:\n");
     for (int i = 0; i < db->num_tables; i++) {
-        printf("  %s (%d columns, %d rows)\n",
+        printf("  %s (%d columns, %d rows, %s)\n",
                db->tables[i].name,
                db->tables[i].num_columns,
-               db->tables[i].num_rows);
+               db->tables[i].num_rows - db->tables[i].num_deleted,
+               db->tables[i].column_major ? "column-major" : "row-major");
+    }
+    for (int i = 0; i < db->num_views; i++) {
+        const MatView* v = db->views[i];
+        printf("  %s (materialized view of %s, %d columns, %d groups)\n",
+               v->table.name, v->base, v->table.num_columns, v->table.num_rows);
     }
 }
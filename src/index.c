@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   HASH INDEX — open addressing over row ids
+   ============================================================
+   Slots hold row ids; the key is read back from the table when probing, so
+   the index costs 8 bytes per slot no matter how wide the column is. Equal
+   keys share a probe sequence, so a lookup walks until the first empty slot
+   and collects every live match. INDEX_BTREE indexes share these entry
+   points and keep their entries in btree.c. */
+
+#define INDEX_MIN_SLOTS 64
+#define SLOT_EMPTY   -1
+#define SLOT_REMOVED -2
+
+static uint32_t hash_bytes(const void* data, size_t len, uint32_t h) {
+    const unsigned char* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t value_hash(const Value* v) {
+    uint32_t h = 2166136261u;
+    switch (v->type) {
+        case COL_INT:
+            return hash_bytes(&v->i, sizeof(v->i), h);
+        case COL_FLOAT: {
+            double f = v->f == 0.0 ? 0.0 : v->f;  // -0.0 and 0.0 compare equal
+            return hash_bytes(&f, sizeof(f), h);
+        }
+        default:
+            return hash_bytes(v->s, strlen(v->s), h);
+    }
+}
+
+static int alloc_slots(Index* ix, int slot_count) {
+    ix->slots = malloc(sizeof(int) * (size_t)slot_count);
+    ix->hashes = malloc(sizeof(uint32_t) * (size_t)slot_count);
+    if (!ix->slots || !ix->hashes) {
+        free(ix->slots);
+        free(ix->hashes);
+        ix->slots = NULL;
+        ix->hashes = NULL;
+        return 0;
+    }
+    for (int i = 0; i < slot_count; i++) ix->slots[i] = SLOT_EMPTY;
+    ix->slot_count = slot_count;
+    ix->used = 0;
+    ix->live = 0;
+    return 1;
+}
+
+static void place(Index* ix, int row, uint32_t h) {
+    uint32_t mask = (uint32_t)ix->slot_count - 1;
+    uint32_t i = h & mask;
+    while (ix->slots[i] >= 0) i = (i + 1) & mask;
+    if (ix->slots[i] == SLOT_EMPTY) ix->used++;
+    ix->slots[i] = row;
+    ix->hashes[i] = h;
+    ix->live++;
+}
+
+static int rehash(Index* ix, int slot_count) {
+    int* old_slots = ix->slots;
+    uint32_t* old_hashes = ix->hashes;
+    int old_count = ix->slot_count;
+    if (!alloc_slots(ix, slot_count)) {
+        ix->slots = old_slots;
+        ix->hashes = old_hashes;
+        return 0;
+    }
+    for (int i = 0; i < old_count; i++) {
+        if (old_slots[i] >= 0) place(ix, old_slots[i], old_hashes[i]);
+    }
+    free(old_slots);
+    free(old_hashes);
+    return 1;
+}
+
+void index_free(Index* ix) {
+    btree_free(ix->root);
+    ix->root = NULL;
+    free(ix->slots);
+    free(ix->hashes);
+    ix->slots = NULL;
+    ix->hashes = NULL;
+    ix->slot_count = 0;
+    ix->used = 0;
+    ix->live = 0;
+}
+
+int index_insert(const Table* t, Index* ix, int row) {
+    if (ix->kind == INDEX_BTREE) {
+        Value v;
+        table_cell_value(t, row, ix->column, &v);
+        btree_insert(&ix->root, &v, row);
+        return 1;
+    }
+    // Keep occupied slots (including removed markers) under half the table
+    if ((ix->used + 1) * 2 > ix->slot_count) {
+        // Mostly removed markers: rehash in place; otherwise double
+        int slots = ix->slot_count;
+        if ((ix->live + 1) * 4 > slots) slots *= 2;
+        if (!rehash(ix, slots)) return 0;
+    }
+    Value v;
+    table_cell_value(t, row, ix->column, &v);
+    place(ix, row, value_hash(&v));
+    return 1;
+}
+
+void index_remove(const Table* t, Index* ix, int row) {
+    Value v;
+    table_cell_value(t, row, ix->column, &v);
+    if (ix->kind == INDEX_BTREE) {
+        btree_remove(ix->root, &v, row);
+        return;
+    }
+    uint32_t mask = (uint32_t)ix->slot_count - 1;
+    for (uint32_t i = value_hash(&v) & mask; ix->slots[i] != SLOT_EMPTY; i = (i + 1) & mask) {
+        if (ix->slots[i] == row) {
+            ix->slots[i] = SLOT_REMOVED;
+            ix->live--;
+            return;
+        }
+    }
+}
+
+int index_build(const Table* t, Index* ix) {
+    index_free(ix);
+    if (ix->kind == INDEX_BTREE) {
+        for (int r = 0; r < t->num_rows; r++) {
+            if (!table_row_deleted(t, r)) index_insert(t, ix, r);
+        }
+        return 1;
+    }
+    int slots = INDEX_MIN_SLOTS;
+    while (slots / 2 < t->num_rows) slots *= 2;
+    if (!alloc_slots(ix, slots)) return 0;
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        Value v;
+        table_cell_value(t, r, ix->column, &v);
+        place(ix, r, value_hash(&v));
+    }
+    return 1;
+}
+
+static int cmp_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int index_lookup(const Table* t, const Index* ix, const Value* key, int* out) {
+    if (ix->kind == INDEX_BTREE) {
+        KeyRange range = { 1, 1, 1, 1, *key, *key, 0 };
+        return btree_range(ix->root, &range, -1, out);
+    }
+    uint32_t h = value_hash(key);
+    uint32_t mask = (uint32_t)ix->slot_count - 1;
+    int n = 0;
+    for (uint32_t i = h & mask; ix->slots[i] != SLOT_EMPTY; i = (i + 1) & mask) {
+        int row = ix->slots[i];
+        if (row < 0 || ix->hashes[i] != h) continue;
+        Value v;
+        table_cell_value(t, row, ix->column, &v);
+        if (value_equals(&v, key)) out[n++] = row;
+    }
+    // Report matches in table order, the same order a full scan produces
+    qsort(out, (size_t)n, sizeof(int), cmp_int);
+    return n;
+}
+
+int index_contains(const Table* t, const Index* ix, const Value* key, int except_row) {
+    if (ix->kind == INDEX_BTREE) {
+        KeyRange range = { 1, 1, 1, 1, *key, *key, 0 };
+        // Two entries settle it: any row besides except_row
+        int rows[2];
+        int n = btree_range(ix->root, &range, 2, rows);
+        return n > 1 || (n == 1 && rows[0] != except_row);
+    }
+    uint32_t h = value_hash(key);
+    uint32_t mask = (uint32_t)ix->slot_count - 1;
+    for (uint32_t i = h & mask; ix->slots[i] != SLOT_EMPTY; i = (i + 1) & mask) {
+        int row = ix->slots[i];
+        if (row < 0 || row == except_row || ix->hashes[i] != h) continue;
+        Value v;
+        table_cell_value(t, row, ix->column, &v);
+        if (value_equals(&v, key)) return 1;
+    }
+    return 0;
+}
+
+int index_range(const Table* t, const Index* ix, const KeyRange* range, int max, int* out) {
+    (void)t;
+    return btree_range(ix->root, range, max, out);
+}
+
+int index_ordered_rows(const Table* t, const Index* ix, int desc, BTreeCursor* c, int max, int* out) {
+    (void)t;
+    return btree_walk(ix->root, desc, c, max, out);
+}
+
+Index* table_find_index(Table* t, int column) {
+    // Hash indexes answer equality in O(1); fall back to any index on the column
+    Index* any = NULL;
+    for (int i = 0; i < t->num_indexes; i++) {
+        if (t->indexes[i].column != column) continue;
+        if (t->indexes[i].kind == INDEX_HASH) return &t->indexes[i];
+        any = &t->indexes[i];
+    }
+    return any;
+}
+
+Index* table_find_ordered_index(Table* t, int column) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        if (t->indexes[i].column == column && t->indexes[i].kind == INDEX_BTREE) return &t->indexes[i];
+    }
+    return NULL;
+}
+
+int table_rebuild_indexes(Table* t) {
+    for (int i = 0; i < t->num_indexes; i++) {
+        if (!index_build(t, &t->indexes[i])) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   HASH JOIN — FROM a JOIN b ON a.x = b.y
+   ============================================================
+   The build side is the one expected to yield fewer rows (its live rows,
+   narrowed by its share of the WHERE once ANALYZE has run on it): its
+   matching rows are hashed on the join key into chained buckets (kept in
+   row order). The other side streams through the batch pipeline and
+   probes each row's key,
+   printing one output row per match, so output follows probe order and
+   then build order. Each side reads its own layout through
+   table_cell_value, so row-major and column-major tables mix freely.
+
+   WHERE is split at its top-level ANDs; every term must name columns of
+   one table only and is pushed down to that side's scan, where it can use
+   that table's indexes, zone maps and kernels.
+
+   LIMIT and OFFSET count output rows; the probe scan stops once LIMIT rows
+   have printed. */
+
+//A column of either join input
+typedef struct {
+    int side;  // 0 = left table, 1 = right table
+    int col;
+} JoinRef;
+
+typedef struct {
+    Table* tables[2];
+    JoinRef key[2];       // ON left.x = right.y, as [left, right]
+    ColumnType key_type;  // common comparison type of the two keys
+    JoinRef* out;
+    int num_out;
+    int build;            // side hashed into buckets
+    int* heads;           // first entry per bucket, -1 = empty
+    int* tails;
+    int slot_count;       // power of two
+    int* next;            // chain link per entry
+    int* rows;            // build row per entry
+    uint32_t* hashes;
+    int num_entries;
+    int64_t matches;
+    int64_t skip;         // OFFSET output rows still to drop
+    int64_t left;         // LIMIT output rows still to print, -1 = no LIMIT
+    ResultWriter w;
+} JoinState;
+
+/* Resolves "table.col", or a bare column name found in exactly one table. */
+static int resolve_ref(const JoinState* js, const char* ref, JoinRef* out) {
+    const char* dot = strchr(ref, '.');
+    if (dot) {
+        for (int s = 0; s < 2; s++) {
+            const char* name = js->tables[s]->name;
+            if (strlen(name) == (size_t)(dot - ref) && strncmp(name, ref, (size_t)(dot - ref)) == 0) {
+                out->side = s;
+                out->col = column_index(js->tables[s], dot + 1);
+                if (out->col >= 0) return 1;
+            }
+        }
+        printf("Error: unknown column '%s'.\n", ref);
+        return 0;
+    }
+    int found = 0;
+    for (int s = 0; s < 2; s++) {
+        int c = column_index(js->tables[s], ref);
+        if (c >= 0) {
+            out->side = s;
+            out->col = c;
+            found++;
+        }
+    }
+    if (found == 1) return 1;
+    if (found == 0) printf("Error: unknown column '%s'.\n", ref);
+    else printf("Error: column '%s' is ambiguous; qualify it with a table name.\n", ref);
+    return 0;
+}
+
+/* ===== WHERE pushdown ===== */
+
+/* The one side every comparison under e refers to: 0 or 1, 2 for both,
+   -1 after a reported error. */
+static int expr_side(const JoinState* js, const Expr* e) {
+    if (e->kind == EXPR_CMP) {
+        JoinRef r;
+        return resolve_ref(js, e->cmp.column, &r) ? r.side : -1;
+    }
+    int a = expr_side(js, e->left);
+    if (a < 0 || !e->right) return a;
+    int b = expr_side(js, e->right);
+    if (b < 0) return b;
+    return a == b ? a : 2;
+}
+
+/* Copies e with every column rewritten to its bare name on its table. */
+static Expr* clone_for_side(const JoinState* js, const Expr* e) {
+    Expr* c = calloc(1, sizeof(Expr));
+    if (!c) return NULL;
+    c->kind = e->kind;
+    c->cmp = e->cmp;
+    if (e->kind == EXPR_CMP) {
+        JoinRef r;
+        resolve_ref(js, e->cmp.column, &r);
+        snprintf(c->cmp.column, sizeof(c->cmp.column), "%s", js->tables[r.side]->columns[r.col].name);
+        return c;
+    }
+    c->left = clone_for_side(js, e->left);
+    c->right = e->right ? clone_for_side(js, e->right) : NULL;
+    if (!c->left || (e->right && !c->right)) {
+        expr_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+/* ANDs the top-level terms of e into per-side filters. Returns 0 on an
+   error (reported), including a term that spans both tables. */
+static int push_down(const JoinState* js, const Expr* e, Expr** sides) {
+    if (e->kind == EXPR_AND) return push_down(js, e->left, sides) && push_down(js, e->right, sides);
+    int s = expr_side(js, e);
+    if (s < 0) return 0;
+    if (s == 2) {
+        printf("Error: each AND term of a JOIN's WHERE must use columns of one table.\n");
+        return 0;
+    }
+    Expr* term = clone_for_side(js, e);
+    if (!term) return 0;
+    if (!sides[s]) {
+        sides[s] = term;
+        return 1;
+    }
+    Expr* both = calloc(1, sizeof(Expr));
+    if (!both) {
+        expr_free(term);
+        return 0;
+    }
+    both->kind = EXPR_AND;
+    both->left = sides[s];
+    both->right = term;
+    sides[s] = both;
+    return 1;
+}
+
+/* ===== Build and probe ===== */
+
+/* Reads a join key in the shared comparison type; 0 for a NULL key. */
+static int read_key(const JoinState* js, int side, int row, Value* v) {
+    const JoinRef* k = &js->key[side];
+    table_cell_value(js->tables[side], row, k->col, v);
+    if (js->key_type == COL_FLOAT && v->type == COL_INT) {
+        v->f = (double)v->i;
+        v->type = COL_FLOAT;
+    }
+    return v->type != COL_TEXT || v->s != NULL;
+}
+
+static int build_batch(BatchSink* self, const Table* t, const Batch* b,
+                       const VectorView* cols, int num_cols) {
+    (void)t;
+    (void)cols;
+    (void)num_cols;
+    JoinState* js = self->state;
+    uint32_t mask = (uint32_t)js->slot_count - 1;
+    for (int k = 0; k < b->count; k++) {
+        Value v;
+        if (!read_key(js, js->build, b->sel[k], &v)) continue;
+        int e = js->num_entries++;
+        uint32_t h = value_hash(&v);
+        js->rows[e] = b->sel[k];
+        js->hashes[e] = h;
+        js->next[e] = -1;
+        // Append, so each chain stays in build row order
+        uint32_t slot = h & mask;
+        if (js->heads[slot] < 0) js->heads[slot] = e;
+        else js->next[js->tails[slot]] = e;
+        js->tails[slot] = e;
+    }
+    return 1;
+}
+
+static int probe_batch(BatchSink* self, const Table* t, const Batch* b,
+                       const VectorView* cols, int num_cols) {
+    (void)t;
+    (void)cols;
+    (void)num_cols;
+    JoinState* js = self->state;
+    int probe = 1 - js->build;
+    uint32_t mask = (uint32_t)js->slot_count - 1;
+    for (int k = 0; k < b->count; k++) {
+        Value v;
+        int prow = b->sel[k];
+        if (!read_key(js, probe, prow, &v)) continue;
+        uint32_t h = value_hash(&v);
+        for (int e = js->heads[h & mask]; e >= 0; e = js->next[e]) {
+            if (js->hashes[e] != h) continue;
+            Value bv;
+            read_key(js, js->build, js->rows[e], &bv);
+            if (!value_equals(&v, &bv)) continue;
+            if (js->skip > 0) {
+                js->skip--;
+                continue;
+            }
+            if (js->left == 0) return 0;
+            if (js->left > 0) js->left--;
+
+            int row_of[2];
+            row_of[probe] = prow;
+            row_of[js->build] = js->rows[e];
+            for (int i = 0; i < js->num_out; i++) {
+                const JoinRef* r = &js->out[i];
+                writer_cell(&js->w, js->tables[r->side], row_of[r->side], r->col);
+            }
+            js->matches++;
+        }
+    }
+    return js->left != 0;
+}
+
+/* Scans one side with its pushed-down filter into sink. */
+static int scan_side(Table* t, const Expr* where, BatchSink* sink) {
+    ScanSpec spec;
+    WhereProgram prog;
+    if (!plan_where(t, where, &spec, &prog)) return 0;
+    int ok = pipeline_run(t, &spec, sink);
+    release_plan(&spec, &prog);
+    return ok;
+}
+
+static int setup_output(JoinState* js, char** cols, int num_cols) {
+    if (!cols) {
+        num_cols = js->tables[0]->num_columns + js->tables[1]->num_columns;
+    }
+    js->out = malloc(sizeof(JoinRef) * (size_t)(num_cols > 0 ? num_cols : 1));
+    if (!js->out) return 0;
+    js->num_out = 0;
+    if (!cols) {
+        for (int s = 0; s < 2; s++) {
+            for (int c = 0; c < js->tables[s]->num_columns; c++) {
+                js->out[js->num_out].side = s;
+                js->out[js->num_out++].col = c;
+            }
+        }
+        return 1;
+    }
+    for (int i = 0; i < num_cols; i++) {
+        if (!resolve_ref(js, cols[i], &js->out[js->num_out++])) return 0;
+    }
+    return 1;
+}
+
+int select_join(Database* db, const JoinSpec* join, char** cols, int num_cols, const Expr* where,
+                const RowLimit* limit) {
+    JoinState js;
+    memset(&js, 0, sizeof(JoinState));
+    js.skip = limit ? limit->offset : 0;
+    js.left = limit ? limit->count : -1;
+    const char* names[2] = { join->left, join->right };
+    for (int s = 0; s < 2; s++) {
+        js.tables[s] = find_table(db, names[s]);
+        if (!js.tables[s]) {
+            printf("Error: table '%s' not found.\n", names[s]);
+            return 0;
+        }
+    }
+    if (js.tables[0] == js.tables[1]) {
+        printf("Error: a table cannot be joined with itself.\n");
+        return 0;
+    }
+
+    // ON may name the two sides in either order
+    JoinRef a, b;
+    if (!resolve_ref(&js, join->left_col, &a) || !resolve_ref(&js, join->right_col, &b)) return 0;
+    if (a.side == b.side) {
+        printf("Error: ON must compare a column of each table.\n");
+        return 0;
+    }
+    js.key[a.side] = a;
+    js.key[b.side] = b;
+    ColumnType ta = js.tables[0]->columns[js.key[0].col].type;
+    ColumnType tb = js.tables[1]->columns[js.key[1].col].type;
+    if ((ta == COL_TEXT) != (tb == COL_TEXT)) {
+        printf("Error: cannot join %s column with %s column.\n",
+               column_type_to_string(ta), column_type_to_string(tb));
+        return 0;
+    }
+    js.key_type = ta == tb ? ta : COL_FLOAT;
+
+    Expr* sides[2] = { NULL, NULL };
+    int ok = setup_output(&js, cols, num_cols) && (!where || push_down(&js, where, sides));
+
+    // Hash the smaller input
+    if (ok) {
+        double rows_l = stats_estimate_rows(js.tables[0], sides[0]);
+        double rows_r = stats_estimate_rows(js.tables[1], sides[1]);
+        js.build = rows_r < rows_l ? 1 : 0;
+        const Table* bt = js.tables[js.build];
+        int live = bt->num_rows - bt->num_deleted;
+        js.slot_count = 16;
+        while (js.slot_count < live * 2) js.slot_count *= 2;
+        js.heads = malloc(sizeof(int) * (size_t)js.slot_count);
+        js.tails = malloc(sizeof(int) * (size_t)js.slot_count);
+        js.next = malloc(sizeof(int) * (size_t)(live > 0 ? live : 1));
+        js.rows = malloc(sizeof(int) * (size_t)(live > 0 ? live : 1));
+        js.hashes = malloc(sizeof(uint32_t) * (size_t)(live > 0 ? live : 1));
+        ok = js.heads && js.tails && js.next && js.rows && js.hashes;
+        if (ok) {
+            memset(js.heads, -1, sizeof(int) * (size_t)js.slot_count);
+            BatchSink build = { build_batch, &js, NULL, NULL };
+            ok = scan_side(js.tables[js.build], sides[js.build], &build);
+        } else {
+            fprintf(stderr, "Out of memory building join hash table.\n");
+        }
+    }
+
+    if (ok) {
+        writer_begin(&js.w, db->output_mode, js.num_out);
+        for (int i = 0; i < js.num_out; i++) {
+            const JoinRef* r = &js.out[i];
+            const Table* side = js.tables[r->side];
+            char name[2 * MAX_NAME_LEN + 2];
+            snprintf(name, sizeof(name), "%s.%s", side->name, side->columns[r->col].name);
+            writer_column(&js.w, name, side->columns[r->col].type);
+        }
+        BatchSink probe = { probe_batch, &js, NULL, NULL };
+        ok = scan_side(js.tables[1 - js.build], sides[1 - js.build], &probe);
+        writer_end(&js.w);
+    }
+
+    expr_free(sides[0]);
+    expr_free(sides[1]);
+    free(js.out);
+    free(js.heads);
+    free(js.tails);
+    free(js.next);
+    free(js.rows);
+    free(js.hashes);
+    return ok;
+}
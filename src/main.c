@@ -34,6 +34,7 @@ int main(int argc, char** argv) {
 
     save_database(&db, default_file);
     free_database(&db);
+    parallel_shutdown();
 
     return 0;
 }
@@ -3,9 +3,12 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define MAX_NAME_LEN 64
 #define MAX_VALUE_LEN 256 
+#define AUTO_VACUUM_MIN_DEAD 1024     // tombstones needed before DELETE compacts on its own
+#define AUTO_VACUUM_DEAD_FRACTION 4   // ...and they must be at least 1/N of the row slots
 
 //enum of all column types
 typedef enum {
@@ -14,41 +17,473 @@ typedef enum {
     COL_FLOAT
 } ColumnType;
 
+//Bump allocator chunk; cell bytes are carved from data[]
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t used;
+    size_t cap;
+    char data[];
+} ArenaChunk;
+
+//Per-table arena: cells are never freed one by one, only all chunks at once
+typedef struct {
+    ArenaChunk* head;        // newest chunk, allocation happens here
+    size_t next_chunk_size;  // grows geometrically up to a cap
+    size_t bytes_reserved;   // total chunk capacity, for .meminfo-style stats
+} Arena;
+
+//Dictionary for an encoded TEXT column: each distinct value gets a dense code
+typedef struct {
+    char** strings;  // code -> value, bytes live in the table arena
+    int count;
+    int capacity;
+    int* slots;      // open-addressing hash of codes, -1 = empty
+    int slot_count;  // power of two
+} TextDict;
+
+#define ZONE_ROWS 4096  // rows summarized by one zone map entry
+
+//Min/max summary of one block of a numeric column; bounds cover live rows only
+typedef struct {
+    int64_t imin, imax;  // COL_INT bounds
+    double fmin, fmax;   // COL_FLOAT bounds
+    int live;            // live rows in the block, 0 = skip entirely
+} ZoneMap;
+
 typedef struct {
     char name[MAX_NAME_LEN];
     ColumnType type;
-    char** values;  // array of strings for this column (column-major)
+    char** values;   // COL_TEXT cells (column-major)
+    uint32_t* codes; // dictionary-encoded COL_TEXT cells, used instead of values
+    TextDict* dict;  // non-NULL when the column is dictionary-encoded
+    int64_t* ints;   // COL_INT cells, parsed once at insert
+    double* floats;  // COL_FLOAT cells, parsed once at insert
+    int capacity;    // allocated slots in the active vector
+    ZoneMap* zones;  // COL_INT/COL_FLOAT: one entry per ZONE_ROWS block
 } ColumnStorage;
 
+//Column modifier flags stored in ColumnDef.flags
+#define COLUMN_DICT 0x1         // TEXT column is dictionary-encoded in column-major mode
+#define COLUMN_UNIQUE 0x2       // no two live rows share a value, enforced by a hash index
+#define COLUMN_PRIMARY_KEY 0x4  // UNIQUE, at most one per table
+
 //Defines a column type in a table
 typedef struct {
     char name[MAX_NAME_LEN];
     ColumnType type;
+    int flags;  // COLUMN_* modifiers
 } ColumnDef;
 
+//A typed cell value; s points at stored bytes and is never owned
+typedef struct {
+    ColumnType type;
+    int64_t i;      // COL_INT
+    double f;       // COL_FLOAT
+    const char* s;  // COL_TEXT
+} Value;
+
+//Kinds of secondary index
+#define INDEX_HASH 0
+#define INDEX_BTREE 1
+
+#define BTREE_ORDER 64  // max entries per leaf, max children per internal node
+
+//B+tree node; leaves are chained left to right for range scans
+typedef struct BTreeNode {
+    int leaf;
+    int count;                                 // leaf: entries, internal: children
+    Value keys[BTREE_ORDER];                   // leaf entries or separators
+    int rows[BTREE_ORDER];                     // row ids, tie-break for equal keys
+    struct BTreeNode* children[BTREE_ORDER + 1];
+    struct BTreeNode* next;                    // next leaf
+} BTreeNode;
+
+#define BTREE_MAX_DEPTH 32  // levels a walk can descend; splits keep the tree far shallower
+
+//Position of a walk over B+tree entries; zeroed = before the first entry
+typedef struct {
+    const BTreeNode* path[BTREE_MAX_DEPTH];  // root down to the current leaf
+    int slot[BTREE_MAX_DEPTH];               // child taken, or next entry in the leaf
+    int depth;                               // nodes on the path, 0 once the walk is done
+    int started;
+} BTreeCursor;
+
+//Comparison operators understood in WHERE
+typedef enum {
+    CMP_EQ,
+    CMP_NE,
+    CMP_LT,
+    CMP_LE,
+    CMP_GT,
+    CMP_GE,
+    CMP_BETWEEN
+} CompareOp;
+
+//A parsed WHERE predicate: column op value [AND value2]
+typedef struct {
+    char column[MAX_NAME_LEN];
+    CompareOp op;
+    char value[MAX_VALUE_LEN];
+    char value2[MAX_VALUE_LEN];  // upper bound for BETWEEN
+    int param;                   // ? placeholder for value: 1-based bind slot, 0 = literal
+    int param2;                  // same for value2
+} Condition;
+
+//Aggregate functions in a SELECT list
+typedef enum {
+    AGG_NONE,   // a plain (grouped) column
+    AGG_COUNT,
+    AGG_SUM,
+    AGG_AVG,
+    AGG_MIN,
+    AGG_MAX
+} AggFunc;
+
+//One SELECT list entry: col or FUNC(col); COUNT also takes *
+typedef struct {
+    AggFunc func;
+    char column[MAX_NAME_LEN];
+} SelectItem;
+
+//ORDER BY col [ASC|DESC]
+typedef struct {
+    char column[MAX_NAME_LEN];
+    int desc;
+} OrderBy;
+
+//LIMIT n [OFFSET m]
+typedef struct {
+    int64_t count;   // -1 = no LIMIT
+    int64_t offset;  // matching rows skipped before the first one returned
+} RowLimit;
+
+//FROM left JOIN right ON left_col = right_col (columns as table.col or bare names)
+typedef struct {
+    char left[MAX_NAME_LEN];
+    char right[MAX_NAME_LEN];
+    char left_col[MAX_NAME_LEN];
+    char right_col[MAX_NAME_LEN];
+} JoinSpec;
+
+//Parsed WHERE expression: comparisons combined with AND, OR and NOT
+typedef enum {
+    EXPR_CMP,
+    EXPR_AND,
+    EXPR_OR,
+    EXPR_NOT
+} ExprKind;
+
+typedef struct Expr {
+    ExprKind kind;
+    Condition cmp;       // EXPR_CMP
+    struct Expr* left;   // AND/OR left operand, NOT operand
+    struct Expr* right;  // AND/OR right operand
+} Expr;
+
+//Typed bounds derived from a Condition
+typedef struct {
+    int has_lo, lo_incl;
+    int has_hi, hi_incl;
+    Value lo, hi;
+    int exclude;  // match everything outside the bounds (<>)
+} KeyRange;
+
+//Secondary index on one column. Hash slots hold row ids, -1 empty, -2 removed
+typedef struct {
+    char name[MAX_NAME_LEN];
+    int column;          // indexed column
+    int kind;            // INDEX_*
+    int* slots;          // open-addressing table of row ids
+    uint32_t* hashes;    // key hash per slot, checked before comparing keys
+    int slot_count;      // power of two
+    int used;            // slots not empty (live + removed)
+    int live;            // slots holding a row
+    BTreeNode* root;     // INDEX_BTREE entries
+    int unique;          // backs a UNIQUE/PRIMARY KEY column; implied by the schema, not the catalog
+} Index;
+
+#define STATS_BUCKETS 16  // equi-depth histogram buckets per analyzed column
+
+//ANALYZE summary of one column; TEXT values are owned copies
+typedef struct {
+    int analyzed;
+    int64_t count;     // non-NULL live values
+    int64_t ndv;       // distinct values (estimated when ANALYZE samples)
+    Value min, max;
+    int num_bounds;    // histogram buckets, each holding about count / num_bounds values
+    Value bounds[STATS_BUCKETS];  // inclusive upper bound of each bucket, ascending
+} ColumnStats;
+
 //Defines a row in a table
 typedef struct {
     char** values; //Array of strings representing the values for each column
 } Row;
 
+typedef struct MatView MatView;
+
 //Defines a table in the database
 typedef struct {
     char name[MAX_NAME_LEN];
     int num_columns;
     ColumnDef* columns;
+    int column_major;         // storage layout: 0 = rows, 1 = column_data
     int num_rows;
     Row* rows;                // for row-major mode
+    int row_capacity;         // allocated slots in rows
     ColumnStorage* column_data;  // for column-major mode
+    Arena arena;              // owns all cell strings and row value arrays
+    uint64_t* deleted;        // tombstone bitmap, one bit per row slot (NULL until a delete)
+    int deleted_words;        // 64-bit words allocated in deleted
+    int num_deleted;          // tombstoned rows still occupying slots
+    Index* indexes;           // secondary indexes, kept in sync by insert/update/delete
+    int num_indexes;
+    ColumnStats* stats;       // one per column from ANALYZE, NULL = plan by rule
+    int64_t stats_rows;       // live rows when last analyzed
+    uint64_t write_version;   // bumped by every insert, update, delete, layout change, index and ANALYZE
+    MatView* view;            // non-NULL: this is a materialized view's result, changed only through its base
+    MatView** views;          // materialized views over this table, kept in sync by insert/update/delete
+    int num_views;
 } Table;
 
+//Returns 1 if row slot r was deleted and is waiting for vacuum_table
+static inline int table_row_deleted(const Table* t, int r) {
+    return (r >> 6) < t->deleted_words && ((t->deleted[r >> 6] >> (r & 63)) & 1);
+}
+
+#define BATCH_ROWS 1024  // rows per batch in the SELECT pipeline
+#define MORSEL_ROWS (4 * ZONE_ROWS)  // row slots per unit of parallel scan work
+
+//A batch of selected row ids flowing scan -> filter -> project -> sink
+typedef struct {
+    int sel[BATCH_ROWS];  // selection vector: live, matching row ids in output order
+    int count;
+    int start, span;      // table scans: the row slots [start, start + span) this batch covers
+} Batch;
+
+//One projected column of a batch
+typedef struct {
+    const ColumnStorage* col;  // column-major: read in place at sel[k]
+    char** cells;              // row-major: cell text gathered for sel[k]
+} VectorView;
+
+//Consumer at the end of the pipeline; returning 0 stops the scan early
+typedef struct BatchSink {
+    int (*consume)(struct BatchSink* self, const Table* t, const Batch* b,
+                   const VectorView* cols, int num_cols);
+    void* state;
+    // Optional, for sinks that can work per morsel (parallel scans): fork makes a
+    // private sink fed on a worker without projected columns, join folds it back
+    // on the caller in morsel order and frees it. NULL = consume on the caller in row order.
+    struct BatchSink* (*fork)(struct BatchSink* self);
+    int (*join)(struct BatchSink* self, struct BatchSink* part);
+} BatchSink;
+
+//Work split into morsels: run executes on a worker, merge on the caller in morsel order
+typedef struct MorselJob {
+    void (*run)(struct MorselJob* job, int morsel);
+    int (*merge)(struct MorselJob* job, int morsel);  // 0 marks the job failed; later morsels still merge
+} MorselJob;
+
+//One comparison with its column resolved and its literal converted to the column type
+typedef struct {
+    int col;
+    ColumnType type;
+    KeyRange range;           // typed bounds; TEXT cells compare through it
+    int empty;                // can never match
+    int all;                  // matches every live row (<> a string absent from the dictionary)
+    int invert;               // <>: keep rows outside the bounds
+    int64_t ilo, ihi;         // inclusive COL_INT bounds
+    double flo, fhi;          // inclusive COL_FLOAT bounds
+    int dict_code;            // column-major dictionary point test: the literal's code
+    unsigned char* dict_hit;  // column-major dictionary range: verdict per code
+} Predicate;
+
+//Flat WHERE program over an accumulator: TEST sets it, jumps short-circuit AND/OR
+typedef enum {
+    WOP_TEST,           // acc = preds[arg] holds for the row
+    WOP_NOT,            // acc = !acc
+    WOP_JUMP_IF_FALSE,  // AND: skip the right operand
+    WOP_JUMP_IF_TRUE    // OR: skip the right operand
+} WhereOp;
+
+typedef struct {
+    WhereOp op;
+    int arg;  // predicate index or jump target
+} WhereInstr;
+
+typedef struct {
+    Predicate* preds;
+    int num_preds;
+    WhereInstr* code;
+    int num_code;
+    int conjunctive;  // an AND of comparisons only: each predicate refines the selection in turn
+    int drive;        // predicate that may narrow the scan (reachable through AND only), -1 = none
+    int driven;       // leading predicates (in order) the scan itself already enforces
+    int* order;       // predicates in refine order; a conjunction's driver comes first
+} WhereProgram;
+
+//What to scan: an explicit row list or every live row, an optional range filter, the projection
+typedef struct {
+    const int* rows;   // row ids from an index probe, NULL = scan the table
+    int num_rows;
+    int filter_col;    // -1 = no filter
+    KeyRange filter;
+    const WhereProgram* where;  // compound WHERE run after the filter, NULL = none
+    const int* cols;   // projected columns
+    int num_cols;
+    int64_t offset;    // matches skipped before the sink sees any
+    int64_t limit;     // matches passed to the sink, -1 = all; the scan stops once reached
+} ScanSpec;
+
+//A serial pipeline paused between batches (pipeline_open); private to pipeline.c
+typedef struct Pipeline Pipeline;
+
+//A SELECT read a batch or a row at a time. Cells are read in place, so the
+//table must not change while the cursor is open
+typedef struct {
+    Table* t;
+    int* cols;                // projected column positions
+    int num_cols;
+    ScanSpec spec;
+    WhereProgram prog;
+    Pipeline* pipe;
+    const Batch* batch;       // current batch, NULL before the first and after the last
+    const VectorView* views;  // its projected columns
+    int pos;                  // rows of batch cursor_step has returned
+    char text_buf[64];        // cursor_text rendering of numbers
+} Cursor;
+
+//How result sets are printed (.mode)
+typedef enum {
+    OUTPUT_LIST,    // cells separated by " | "
+    OUTPUT_TSV,
+    OUTPUT_CSV,
+    OUTPUT_BINARY   // length-prefixed cells, numbers as their stored bytes
+} OutputMode;
+
+//Formats one result set into a shared buffer written to stdout in large chunks
+typedef struct {
+    OutputMode mode;
+    char* buf;
+    size_t len;     // bytes of buf not yet written
+    int num_cols;
+    int col;        // column of the next cell within its row
+} ResultWriter;
+
+typedef struct ResultCache ResultCache;
+
+//A materialized view SELECT item resolved against the base table
+typedef struct {
+    AggFunc func;     // AGG_NONE = a GROUP BY column copied into the view
+    int src;          // base column, -1 = COUNT(*)
+    ColumnType type;  // base column type, COL_INT for COUNT(*)
+} ViewItem;
+
+//Running totals of one view item in one group
+typedef struct {
+    int64_t count;  // non-NULL values folded in
+    int64_t isum;   // SUM/AVG over INT
+    double fsum;    // SUM/AVG over FLOAT
+} ViewAcc;
+
+//CREATE MATERIALIZED VIEW name AS SELECT ... FROM base GROUP BY ...: one result
+//row per group, updated in place as the base table changes
+struct MatView {
+    char base[MAX_NAME_LEN];
+    Table table;        // result rows, column-major; table.name is the view's name
+    ViewItem* items;    // one per result column
+    int* group_cols;    // base columns of the GROUP BY
+    int* key_cols;      // result column holding each of them
+    int num_group;
+    int64_t* rows;      // base rows per group; the group goes when it reaches 0
+    ViewAcc* accs;      // table.num_columns per group
+    uint32_t* hashes;   // group key hash per result row
+    int* next;          // hash chain through result rows, -1 = end
+    int* heads;         // first result row per bucket, -1 = empty
+    int num_buckets;    // power of two
+    int group_cap;      // result rows the per-group arrays hold
+};
+
 //Defines the database structure
 typedef struct {
     int num_tables; //Number of tables
     Table* tables; //Pointer to array of tables [num_tables]
     int binary_mode; //Whether to save/load in binary mode 0 = text, 1 = binary
-    int column_store; //0 = row-major, 1 = column-major
+    int column_store; //Layout for new tables: 0 = row-major, 1 = column-major
+    unsigned schema_version; //Bumped when a table is created or dropped; prepared statements re-resolve on change
+    OutputMode output_mode; //How SELECT results are printed
+    ResultCache* cache; //Printed SELECT results kept for reuse, NULL = off (.cache)
+    MatView** views; //Materialized views; find_table resolves their names too
+    int num_views;
 } Database;
 
+//Outcome of stmt_step
+typedef enum {
+    STEP_ERROR,  // reported; fix the cause and step again
+    STEP_ROW,    // a SELECT row is ready for the stmt_column_* readers
+    STEP_DONE    // the INSERT went in, or the SELECT has no rows left
+} StepResult;
+
+typedef enum {
+    STMT_INSERT,
+    STMT_SELECT
+} StatementKind;
+
+//A ? bind slot: the typed value and, when needed, its text form
+typedef struct {
+    int set;
+    Value v;          // v.s points at text once it holds the text form (always for COL_TEXT)
+    char* text;       // owned and reused across binds; numbers are rendered only on a type mismatch
+    size_t text_cap;
+} BindSlot;
+
+//An INSERT value: literal text or a bind slot
+typedef struct {
+    int param;    // 1-based ? slot, 0 = literal
+    char* literal;
+} StmtValue;
+
+//A WHERE comparison, resolved once: its column and, when it has no ?, its bounds
+typedef struct {
+    const Condition* cond;
+    int valid;    // 0 = a literal the column type can never hold
+    KeyRange range;
+} StmtPred;
+
+//A parsed INSERT or SELECT, executed many times with new bindings
+typedef struct {
+    Database* db;
+    StatementKind kind;
+    char table[MAX_NAME_LEN];
+    BindSlot* params;         // num_params, ? numbered from 1 left to right
+    int num_params;
+
+    StmtValue* values;        // INSERT: one per column
+    int num_values;
+    Value* row;               // INSERT: the typed row handed to the table
+
+    char** col_names;         // SELECT list, NULL = *
+    int num_cols;
+    Expr* where;              // NULL = every row
+    RowLimit limit;
+    int limit_param;          // ? slot for the LIMIT count, 0 = literal
+    int offset_param;         // ? slot for the OFFSET, 0 = literal
+
+    unsigned schema_version;  // db->schema_version when last resolved
+    int resolved;
+    Table* t;
+    int* cols;                // SELECT: resolved column positions
+    WhereProgram prog;        // compiled once; predicate bounds refreshed per run
+    StmtPred* preds;          // one per program predicate
+
+    ScanSpec spec;            // SELECT run in progress: its plan
+    Pipeline* pipe;           // streams the run's batches, NULL = not started
+    const Batch* batch;       // current batch; pos of its rows have been stepped
+    const VectorView* views;
+    int pos;
+    char text_buf[64];        // stmt_column_text rendering of numbers
+} Statement;
+
 
 //Funcitons for starting the database
 void init_database(Database* db); //initalizes an empty database
@@ -58,15 +493,34 @@ void free_database(Database* db); //frees all memory associated with the databas
 Table* find_table(Database* db, const char* name); //finds a table by name, returns NULL if not found
 int create_table(Database* db, const char* name, ColumnDef* cols, int num_cols); //Creates a new table with given name and columns
 int drop_table(Database* db, const char* name); //Deletes a table by name
+void free_table(Table* t); //Releases a table's storage, indexes and statistics
 int insert_row(Database* db, const char* table_name, char** values, int num_values); //Inserts a new row into a table
-int select_all(Database* db, const char* table_name); //Selects and prints all rows from a table
-int select_columns(Database* db, const char* table_name, char** cols, int num_cols); //Selects and prints specific columns from a table
-int select_where_eq(Database* db, const char* table_name, char** cols, int num_cols, const char* where_col, const char* where_val); //Prints rows where a column equals a value
+int insert_rows(Database* db, const char* table_name, char*** rows, int nrows); //Inserts a batch of rows with one lookup and one reservation
+int insert_rows_quiet(Table* t, char*** rows, int nrows); //insert_rows without the lookup or summary line
+int insert_values_quiet(Table* t, Value** rows, int nrows); //insert_rows_quiet for rows already in each column's type
+int select_all(Database* db, const char* table_name, const RowLimit* limit); //Selects and prints all rows from a table; limit NULL = every row
+int select_columns(Database* db, const char* table_name, char** cols, int num_cols, const RowLimit* limit); //Selects and prints specific columns from a table
+int select_where_eq(Database* db, const char* table_name, char** cols, int num_cols, const char* where_col, const char* where_val, const RowLimit* limit); //Prints rows where a column equals a value
+int select_where(Database* db, const char* table_name, char** cols, int num_cols, const Expr* where, const RowLimit* limit); //Prints rows matching a WHERE expression
 int delete_where_eq(Database* db, const char* table_name, const char* where_col, const char* where_val); //Deletes rows where a column equals a value
+int select_aggregate(Database* db, const char* table_name, const SelectItem* items, int num_items,
+                     char** group_cols, int num_group, const Expr* where,
+                     const RowLimit* limit); //Prints one row per group, one row without GROUP BY; limit counts groups
+int select_ordered(Database* db, const char* table_name, char** cols, int num_cols,
+                   const Expr* where, const OrderBy* order, const RowLimit* limit); //where and limit may be NULL
+int select_join(Database* db, const JoinSpec* join, char** cols, int num_cols,
+                const Expr* where, const RowLimit* limit); //Hash join; cols NULL = every column of both tables
+int delete_where(Database* db, const char* table_name, const Expr* where);
+int update_where(Database* db, const char* table_name, const char* set_col, const char* set_val, const Expr* where);
+int vacuum_table(Table* t); //Drops tombstoned rows in one sweep, returns how many were reclaimed
+int set_table_layout(Table* t, int column_major); //Transposes a table between row and column storage in one pass
 int update_where_eq(Database* db, const char* table_name, const char* set_col, const char* set_val, const char* where_col, const char* where_val); //Updates rows where a column equals a value
+int create_index(Database* db, const char* index_name, const char* table_name, const char* col_name, int kind); //Builds and registers a secondary index
 void list_tables(Database* db); //Lists all tables in the database
 int load_database(Database* db, const char* filename);
 int save_database(Database* db, const char* filename);
+int save_table_binary(Table* t, FILE* f); //Writes one table blob in binary mode
+int load_table_binary(Database* db, FILE* f, int version); //Reads one table blob and creates the table
 void db_log(const char* fmt, ...);
 
 
@@ -78,5 +532,202 @@ int execute_command(Database* db, char* input); /* Return 1 to request exit, 0 t
 ColumnType parse_column_type(const char* s);
 const char* column_type_to_string(ColumnType t);
 char* str_duplicate(const char* s);
+int parse_int_value(const char* s, int64_t* out); //Returns 1 if s is a whole INT literal
+int parse_float_value(const char* s, double* out); //Returns 1 if s is a whole FLOAT literal
+void format_float_value(double v, char* buf, size_t buf_sz); //Shortest text that reads back as v
+int check_typed_value(ColumnType type, const char* s); //Returns 1 if s is valid for the column type
+const char* column_cell_text(const ColumnStorage* col, int row, char* buf, size_t buf_sz); //Renders a column-major cell
+int column_store_value(Arena* arena, ColumnStorage* col, int row, const char* s); //Parses s into slot row of a reserved column vector
+int table_reserve(Table* t, int column_major, int min_rows); //Grows row or column capacity geometrically
+
+int column_index(Table* t, const char* name); //Column position by name, -1 if unknown
+int value_parse(ColumnType type, const char* s, Value* out); //Converts a literal to a typed value, 0 if invalid
+void table_cell_value(const Table* t, int row, int col, Value* out); //Reads a cell as a typed value in either layout
+int value_equals(const Value* a, const Value* b);
+int value_compare(const Value* a, const Value* b); //Orders by the column type: numeric for INT/FLOAT
+int condition_range(ColumnType type, const Condition* cond, KeyRange* out); //Typed bounds, 0 if a literal is invalid
+void compare_range(CompareOp op, const Value* v, const Value* v2, KeyRange* out); //Bounds of op against typed operands (v2 for BETWEEN)
+int value_in_range(const Value* v, const KeyRange* r);
+
+/* ===== Indexes ===== */
+
+uint32_t value_hash(const Value* v); //Equal values hash equally (-0.0 and 0.0 included)
+int index_build(const Table* t, Index* ix); //(Re)builds from every live row
+int index_insert(const Table* t, Index* ix, int row);
+void index_remove(const Table* t, Index* ix, int row); //Call before the row's key changes
+int index_lookup(const Table* t, const Index* ix, const Value* key, int* out); //Live rows equal to key, in row order
+int index_contains(const Table* t, const Index* ix, const Value* key, int except_row); //1 if a live row other than except_row holds key
+void index_free(Index* ix);
+int index_range(const Table* t, const Index* ix, const KeyRange* range, int max, int* out); //B+tree rows within range, in key order, at most max (-1 = all)
+int index_ordered_rows(const Table* t, const Index* ix, int desc, BTreeCursor* c, int max, int* out); //Next live rows in key order (B+tree), resuming at c; 0 at the end
+Index* table_find_index(Table* t, int column); //Index on a column, NULL if none
+Index* table_find_ordered_index(Table* t, int column); //B+tree index on a column, NULL if none
+void btree_insert(BTreeNode** root, const Value* key, int row);
+void btree_remove(BTreeNode* root, const Value* key, int row);
+int btree_range(const BTreeNode* root, const KeyRange* range, int max, int* out); //max -1 = every key in range
+int btree_walk(const BTreeNode* root, int desc, BTreeCursor* c, int max, int* out); //Up to max rows past c in (key, row) order, or its reverse
+void btree_free(BTreeNode* n);
+int table_rebuild_indexes(Table* t); //After row ids move (vacuum, layout change)
+
+/* ===== Batch pipeline ===== */
+
+int pipeline_run(const Table* t, const ScanSpec* spec, BatchSink* sink); //Streams matching rows to sink in batches, 0 on out of memory
+Pipeline* pipeline_open(const Table* t, const ScanSpec* spec); //Serial pull form of pipeline_run; spec must outlive it; NULL on out of memory
+const Batch* pipeline_next(Pipeline* p, const VectorView** views); //Next non-empty projected batch, NULL when done
+void pipeline_close(Pipeline* p);
+const char* vector_cell_text(const VectorView* v, const Batch* b, int k, char* buf, size_t buf_sz); //Text of row k of a projected batch
+int plan_where(Table* t, const Expr* where, ScanSpec* spec, WhereProgram* prog); //Index probe or filtered scan; where NULL = every row
+int plan_limited(Table* t, const Expr* where, const RowLimit* limit, ScanSpec* spec, WhereProgram* prog); //plan_where carrying OFFSET/LIMIT (limit may be NULL)
+int* resolve_columns(Table* t, char** cols, int num_cols); //Column positions by name (cols NULL = the first num_cols); NULL on an unknown one (reported)
+int plan_program(Table* t, WhereProgram* prog, const RowLimit* limit, ScanSpec* spec); //Plans a compiled program (NULL = every row) from its predicates' current bounds; free spec->rows after
+void release_plan(ScanSpec* spec, WhereProgram* prog);
+
+/* ===== Cursors ===== */
+
+Cursor* cursor_open(Database* db, const char* table_name, char** cols, int num_cols,
+                    const Expr* where, const RowLimit* limit); //cols NULL = every column; NULL on error (reported)
+const Batch* cursor_next_batch(Cursor* c, const VectorView** cols); //Next batch of matches (projected as cols), NULL when done
+int cursor_step(Cursor* c); //Moves to the next row: 1 = a row is ready, 0 = done
+int cursor_column_count(const Cursor* c);
+const char* cursor_column_name(const Cursor* c, int i);
+ColumnType cursor_column_type(const Cursor* c, int i);
+void cursor_value(const Cursor* c, int i, Value* out); //Current row's cell; TEXT points into the table
+const char* cursor_text(Cursor* c, int i); //Current row's cell as text, valid until the next call
+void cursor_close(Cursor* c);
+
+/* ===== Result output ===== */
+
+void writer_begin(ResultWriter* w, OutputMode mode, int num_cols); //Starts a result; follow with num_cols writer_column calls, then the cells row by row
+void writer_column(ResultWriter* w, const char* name, ColumnType type);
+void writer_text(ResultWriter* w, const char* s); //s NULL = NULL
+void writer_int(ResultWriter* w, int64_t v);
+void writer_float(ResultWriter* w, double v);
+void writer_null(ResultWriter* w);
+void writer_value(ResultWriter* w, const Value* v);
+void writer_cell(ResultWriter* w, const Table* t, int row, int col); //A stored cell, read in place
+void writer_end(ResultWriter* w); //Writes out whatever is buffered
+const char* output_mode_name(OutputMode mode);
+int parse_output_mode(const char* s); //-1 if s names no mode
+void writer_capture_start(size_t limit); //Also keeps what the writers print next, up to limit bytes
+char* writer_capture_take(size_t* len); //Ends the capture; its bytes (malloc'd) or NULL if it went past the limit
+
+/* ===== Result cache ===== */
+
+#define CACHE_DEFAULT_KB 16384  // cap for .cache on
+
+int cache_enable(Database* db, size_t cap); //Turns the cache on or changes its cap in bytes; 0 on out of memory
+void cache_free(ResultCache* c);
+int cache_replay(Database* db, const char* sql); //Prints sql's cached result: 1 = hit; a miss starts capturing the output
+void cache_store(Database* db, const char* sql, int ok); //After a miss: keeps the captured output if the SELECT succeeded
+void print_cache_stats(const Database* db);
+
+/* ===== Materialized views ===== */
+
+int create_view(Database* db, const char* name, const char* base, const SelectItem* items, char** names,
+                int num_items, char** group_cols, int num_group); //Builds from every live base row; names[i] NULL = default name
+int drop_view(Database* db, const char* name);
+void view_free(MatView* v);
+void views_note_row(Table* t, int row, int sign, int col); //Folds a base row into (sign 1) or out of (-1) its views; col >= 0 = only views reading it
+
+/* ===== Statistics and planning ===== */
+
+int analyze_table(Table* t); //Collects per-column statistics (ANALYZE), 0 on out of memory
+ColumnStats* stats_reserve(Table* t); //The table's stats array, allocated empty if needed
+void stats_clear_column(ColumnStats* s); //Frees a column's copies and marks it unanalyzed
+void stats_free(Table* t);
+double stats_selectivity(const Table* t, int col, const KeyRange* range); //Share of live rows within range; 1 without statistics
+double stats_estimate_rows(Table* t, const Expr* where); //Live rows expected to match where (NULL = every row)
+double plan_access(Table* t, int col, const KeyRange* range, int64_t cap, Index** ix); //Cheapest path for range: *ix to probe or NULL to scan; returns its cost, -1 without statistics
+void plan_order(Table* t, WhereProgram* prog); //Puts a conjunction's cheapest driver first and the rest by selectivity
+void print_table_stats(const Table* t);
+const char* value_text(const Value* v, char* buf, size_t buf_sz); //Renders a typed value; TEXT is returned as is
+
+/* ===== Parallel scans ===== */
+
+int parallel_run(MorselJob* job, int num_morsels); //Runs every morsel on the worker pool; serial below 2 threads
+int parallel_threads(void);
+void parallel_set_threads(int n); //0 = one per online CPU
+void parallel_shutdown(void); //Joins the workers
+
+/* ===== ORDER BY ===== */
+
+int pipeline_run_sorted(const Table* t, const ScanSpec* spec, int key_col, int desc,
+                        BatchSink* sink); //Top-N heap under spec's LIMIT, else in-memory or external merge sort
+int pipeline_run_indexed(const Table* t, const ScanSpec* spec, const Index* ix, int desc,
+                         BatchSink* sink); //Walks B+tree ix on the sort key instead; stops at spec's LIMIT
+void sort_set_budget(size_t bytes); //Memory for sort entries before runs spill to temporary files
+size_t sort_budget(void);
+
+/* ===== WHERE programs ===== */
+
+void expr_free(Expr* e);
+int predicate_prepare(const Table* t, int col, const KeyRange* range, Predicate* p); //Resolves bounds once, 0 on out of memory
+void predicate_free(Predicate* p);
+int predicate_test_row(const Table* t, const Predicate* p, int row);
+int where_compile(const Table* t, const Expr* e, WhereProgram* prog); //0 on unknown column (reported) or out of memory
+void where_free(WhereProgram* prog);
+int where_eval_row(const Table* t, const WhereProgram* prog, int row);
+void where_filter_batch(const Table* t, const WhereProgram* prog, Batch* b); //Compacts b->sel to rows where prog holds
+
+/* ===== Prepared statements ===== */
+
+Statement* stmt_prepare(Database* db, const char* sql); //INSERT ... VALUES or SELECT ... [WHERE] [LIMIT] with ? placeholders; NULL on error (reported)
+int parse_prepared(char* sql, Statement* st); //Fills the parsed parts of st; 0 on a syntax error (reported)
+int stmt_bind_int(Statement* st, int param, int64_t v); //param counts from 1; 0 if out of range
+int stmt_bind_float(Statement* st, int param, double v);
+int stmt_bind_text(Statement* st, int param, const char* s); //Copies s
+StepResult stmt_step(Statement* st); //Runs an INSERT once, or returns the next SELECT row
+void stmt_reset(Statement* st); //Rewinds a SELECT; bindings stay
+int stmt_column_count(const Statement* st);
+const char* stmt_column_name(const Statement* st, int i);
+void stmt_column_value(const Statement* st, int i, Value* out); //Current row's cell; TEXT points into the table
+const char* stmt_column_text(Statement* st, int i); //Current row's cell as text, valid until the next call
+void stmt_finalize(Statement* st);
+
+/* ===== SIMD filter kernels ===== */
+
+typedef enum {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2
+} SimdLevel;
+
+SimdLevel simd_detect(void); //Best level this CPU supports (CPUID)
+SimdLevel simd_level(void); //Level the kernels currently dispatch to
+SimdLevel simd_set_level(SimdLevel level); //Caps at simd_detect(); returns the level in effect
+const char* simd_level_name(SimdLevel level);
+//Kernels set bit k of mask when lo <= v[k] <= hi (or v[k] == key), flipped by invert; bits past n are 0
+void filter_range_i64(const int64_t* v, int n, int64_t lo, int64_t hi, int invert, uint64_t* mask);
+void filter_range_f64(const double* v, int n, double lo, double hi, int invert, uint64_t* mask);
+void filter_eq_u32(const uint32_t* v, int n, uint32_t key, int invert, uint64_t* mask);
+int mask_to_selection(const uint64_t* mask, int n, const int* ids, int base, int* sel); //Set bit k -> ids[k], or base + k without ids
+
+/* ===== Zone maps ===== */
+
+int zone_block_count(int num_rows);
+int zone_reserve(ColumnStorage* col, int capacity); //Sizes the zone array for capacity rows
+void zone_note_row(ColumnStorage* col, int row); //Widens the block summary for an appended row
+void zone_widen(ColumnStorage* col, int row); //Widens the block summary over a cell rewritten in place
+void zone_refresh_block(const Table* t, int c, int block); //Recomputes one block from its live rows
+void table_rebuild_zones(Table* t); //Recomputes every block of every numeric column
+void table_refresh_zones(Table* t, int only_col, const int* rows, int n); //Blocks touched by rows; only_col -1 = all columns
+int zone_may_match(const ColumnStorage* col, int block, const KeyRange* range); //0 if no live row in the block can match
+
+/* ===== Dictionary encoding ===== */
+
+TextDict* dict_create(void);
+void dict_free(TextDict* d);
+int dict_lookup(const TextDict* d, const char* s); //Returns the code for s, or -1 if absent
+int dict_intern(TextDict* d, Arena* arena, const char* s); //Returns the code for s, adding it if needed
+void dict_move_strings(TextDict* d, Arena* arena); //Re-homes every entry into arena (used by vacuum)
+
+/* ===== Arena ===== */
+
+void arena_init(Arena* a);
+void arena_free(Arena* a); //Releases every chunk at once
+void* arena_alloc(Arena* a, size_t size); //Pointer-aligned allocation
+void* arena_alloc_bytes(Arena* a, size_t size); //Unaligned allocation for string bytes
+char* arena_strdup(Arena* a, const char* s);
+char* arena_strndup(Arena* a, const char* s, size_t len);
 
 #endif
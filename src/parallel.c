@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   MORSEL POOL — work-stealing workers for parallel scans
+   ============================================================
+   A parallel job is cut into morsels (fixed slices of the row range).
+   Each worker starts with an equal, contiguous share of the morsels and
+   takes them from the front; once its share is gone it steals single
+   morsels from the back of the busiest other share, so a skewed predicate
+   that makes one region expensive still spreads out. The caller thread
+   does no scanning: it waits for morsel 0, 1, 2, ... in turn and merges
+   each one as soon as it is done, which keeps output in row order.
+
+   One job runs at a time (statements execute one after another); workers
+   sleep on a condition variable between jobs. */
+
+#define MAX_THREADS 256
+
+//A worker's remaining morsels: owner pops lo, thieves pop hi - 1
+typedef struct {
+    int lo, hi;
+} MorselRange;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;   // a new job, or shutdown
+    pthread_cond_t done_cv;   // a morsel finished, or a worker went idle
+    pthread_t* threads;
+    int num_threads;          // workers started
+    int shutdown;
+    unsigned generation;      // bumped per job
+    MorselJob* job;
+    MorselRange* ranges;      // one per worker
+    unsigned char* done;      // one per morsel
+    int idle;                 // workers finished with the current job
+} Pool;
+
+static Pool pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                     NULL, 0, 0, 0, NULL, NULL, NULL, 0 };
+static int wanted_threads = 0;  // 0 = one per online CPU
+
+int parallel_threads(void) {
+    if (wanted_threads > 0) return wanted_threads;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    return cpus > MAX_THREADS ? MAX_THREADS : (int)cpus;
+}
+
+/* Takes the next morsel for worker id, stealing if its own range is empty.
+   Call with the pool lock held; -1 when no morsel is left anywhere. */
+static int claim_morsel(int id) {
+    MorselRange* own = &pool.ranges[id];
+    if (own->lo < own->hi) return own->lo++;
+    int victim = -1;
+    int most = 0;
+    for (int i = 0; i < pool.num_threads; i++) {
+        int left = pool.ranges[i].hi - pool.ranges[i].lo;
+        if (left > most) {
+            most = left;
+            victim = i;
+        }
+    }
+    if (victim < 0) return -1;
+    return --pool.ranges[victim].hi;
+}
+
+static void* worker_main(void* arg) {
+    int id = (int)(intptr_t)arg;
+    unsigned seen = 0;
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (!pool.shutdown && pool.generation == seen) pthread_cond_wait(&pool.work_cv, &pool.lock);
+        if (pool.shutdown) break;
+        seen = pool.generation;
+
+        MorselJob* job = pool.job;
+        int m;
+        while ((m = claim_morsel(id)) >= 0) {
+            pthread_mutex_unlock(&pool.lock);
+            job->run(job, m);
+            pthread_mutex_lock(&pool.lock);
+            pool.done[m] = 1;
+            pthread_cond_broadcast(&pool.done_cv);
+        }
+        pool.idle++;
+        pthread_cond_broadcast(&pool.done_cv);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+void parallel_shutdown(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.work_cv);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < pool.num_threads; i++) pthread_join(pool.threads[i], NULL);
+    free(pool.threads);
+    free(pool.ranges);
+    pool.threads = NULL;
+    pool.ranges = NULL;
+    pool.num_threads = 0;
+    pool.shutdown = 0;
+}
+
+void parallel_set_threads(int n) {
+    if (n < 0) n = 0;
+    if (n > MAX_THREADS) n = MAX_THREADS;
+    wanted_threads = n;
+    // Restarted lazily at the next parallel job
+    if (pool.num_threads != parallel_threads()) parallel_shutdown();
+}
+
+/* Starts the workers if needed; 0 if no thread could be created. */
+static int pool_start(void) {
+    int n = parallel_threads();
+    if (pool.num_threads == n) return 1;
+    parallel_shutdown();
+    pool.threads = malloc(sizeof(pthread_t) * (size_t)n);
+    pool.ranges = malloc(sizeof(MorselRange) * (size_t)n);
+    if (!pool.threads || !pool.ranges) {
+        parallel_shutdown();
+        return 0;
+    }
+    pool.generation = 0;
+    for (int i = 0; i < n; i++) {
+        if (pthread_create(&pool.threads[i], NULL, worker_main, (void*)(intptr_t)i) != 0) break;
+        pool.num_threads++;
+    }
+    if (pool.num_threads == 0) {
+        parallel_shutdown();
+        return 0;
+    }
+    // Settle for the workers we got rather than respawning on every job
+    if (pool.num_threads < n) wanted_threads = pool.num_threads;
+    return 1;
+}
+
+int parallel_run(MorselJob* job, int num_morsels) {
+    // Kernel dispatch is picked lazily; settle it before workers race for it
+    simd_level();
+
+    unsigned char* done = calloc((size_t)(num_morsels > 0 ? num_morsels : 1), 1);
+    if (!done || parallel_threads() < 2 || !pool_start()) {
+        // Serial fallback: same callbacks, same order
+        free(done);
+        int ok = 1;
+        for (int m = 0; m < num_morsels; m++) {
+            job->run(job, m);
+            ok = job->merge(job, m) && ok;
+        }
+        return ok;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    int workers = pool.num_threads;
+    for (int i = 0; i < workers; i++) {
+        pool.ranges[i].lo = (int)((int64_t)num_morsels * i / workers);
+        pool.ranges[i].hi = (int)((int64_t)num_morsels * (i + 1) / workers);
+    }
+    pool.job = job;
+    pool.done = done;
+    pool.idle = 0;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.work_cv);
+
+    int ok = 1;
+    for (int m = 0; m < num_morsels; m++) {
+        while (!done[m]) pthread_cond_wait(&pool.done_cv, &pool.lock);
+        pthread_mutex_unlock(&pool.lock);
+        ok = job->merge(job, m) && ok;
+        pthread_mutex_lock(&pool.lock);
+    }
+    while (pool.idle < workers) pthread_cond_wait(&pool.done_cv, &pool.lock);
+    pool.job = NULL;
+    pool.done = NULL;
+    pthread_mutex_unlock(&pool.lock);
+    free(done);
+    return ok;
+}
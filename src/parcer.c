@@ -1,10 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 #include <ctype.h>
+#include <inttypes.h>
 #include "miniqlite.h"
 
+#define MAX_SELECT_ITEMS 64  // entries in an aggregate SELECT list or GROUP BY
+
 typedef void (*CommandHandler)(Database*, char*);
 
 typedef struct {
@@ -18,21 +22,31 @@ static void handle_select(Database* db, char* input);
 static void handle_update(Database* db, char* input);
 static void handle_delete(Database* db, char* input);
 static void handle_drop(Database* db, char* input);
+static void handle_alter(Database* db, char* input);
+static void handle_create_index(Database* db, char* input);
+static void handle_analyze(Database* db, char* input);
+static void handle_create_view(Database* db, char* input);
+static void handle_drop_view(Database* db, char* input);
 
 static const Command command_table[] = {
     { "CREATE TABLE", handle_create },
+    { "CREATE INDEX", handle_create_index },
+    { "CREATE MATERIALIZED VIEW", handle_create_view },
     { "INSERT INTO",  handle_insert },
     { "SELECT",       handle_select },
     { "UPDATE",       handle_update },
     { "DELETE FROM",  handle_delete },
     { "DROP TABLE",   handle_drop },
+    { "DROP MATERIALIZED VIEW", handle_drop_view },
+    { "ALTER TABLE",  handle_alter },
+    { "ANALYZE",      handle_analyze },
     { NULL, NULL }
 };
 
 static int handle_meta(Database* db, char* line);
 static void parse_create_table(Database* db, char* line);
 static void parse_insert(Database* db, char* line);
-static void parse_select(Database* db, char* line);
+static int parse_select(Database* db, char* line);
 static void parse_delete(Database* db, char* line);
 static void parse_update(Database* db, char* line);
 
@@ -104,6 +118,29 @@ static char** parse_values_list(char* s, int* out_count) {
     return vals;
 }
 
+/* Returns the ')' closing the group opened at *open, skipping quoted text. */
+static char* find_group_end(char* open) {
+    int depth = 0;
+    for (char* p = open; *p; p++) {
+        if (*p == '"') {
+            p = strchr(p + 1, '"');
+            if (!p) return NULL;
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')') {
+            if (--depth == 0) return p;
+        }
+    }
+    return NULL;
+}
+
+/* Maps ROW/COLUMN to 0/1, -1 if neither. */
+static int parse_layout(const char* s) {
+    if (strcasecmp(s, "ROW") == 0) return 0;
+    if (strcasecmp(s, "COLUMN") == 0) return 1;
+    return -1;
+}
+
 /* Parse simple condition: col = value */
 static int parse_condition_eq(char* s, char* col_buf, size_t col_buf_sz,
                               char* val_buf, size_t val_buf_sz) {
@@ -129,6 +166,190 @@ static int parse_condition_eq(char* s, char* col_buf, size_t col_buf_sz,
     return 1;
 }
 
+/* Copies one literal starting at *p into buf: a "quoted" string or a bare
+   word, without a trailing ';' or ')'. Advances *p past it; 0 if nothing is
+   there. */
+static int parse_literal(char** p, char* buf, size_t buf_sz) {
+    char* s = *p;
+    while (isspace((unsigned char)*s)) s++;
+    char* start = s;
+    size_t len;
+    if (*s == '"') {
+        start = ++s;
+        while (*s && *s != '"') s++;
+        len = (size_t)(s - start);
+        if (*s == '"') s++;
+    } else {
+        while (*s && !isspace((unsigned char)*s) && !strchr(";()", *s)) s++;
+        len = (size_t)(s - start);
+        if (len == 0) return 0;
+    }
+    if (len > buf_sz - 1) len = buf_sz - 1;
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    *p = s;
+    return 1;
+}
+
+/* True when only whitespace and an optional ';' remain. */
+static int at_statement_end(const char* p) {
+    while (isspace((unsigned char)*p)) p++;
+    if (*p == ';') p++;
+    while (isspace((unsigned char)*p)) p++;
+    return *p == '\0';
+}
+
+/* Skips whitespace and consumes kw (any case) when it stands as a whole word. */
+static int match_keyword(char** p, const char* kw) {
+    char* s = *p;
+    while (isspace((unsigned char)*s)) s++;
+    size_t n = strlen(kw);
+    if (strncasecmp(s, kw, n) != 0) return 0;
+    if (isalnum((unsigned char)s[n]) || s[n] == '_') return 0;
+    *p = s + n;
+    return 1;
+}
+
+/* A comparison operand: a literal or, when params is given, a bare ?
+   placeholder that takes the next bind slot. */
+static int parse_operand(char** p, char* buf, size_t buf_sz, int* slot, int* params) {
+    char* s = *p;
+    while (isspace((unsigned char)*s)) s++;
+    if (params && *s == '?') {
+        *slot = ++*params;
+        buf[0] = '\0';
+        *p = s + 1;
+        return 1;
+    }
+    return parse_literal(p, buf, buf_sz);
+}
+
+/* One comparison: col = v, col <> v (or !=), col < v, col <= v, col > v,
+   col >= v, or col BETWEEN a AND b (inclusive). Advances *p past it. */
+static int parse_comparison(char** pp, Condition* cond, int* params) {
+    memset(cond, 0, sizeof(Condition));
+    char* p = *pp;
+    while (isspace((unsigned char)*p)) p++;
+    size_t i = 0;
+    while (*p && !isspace((unsigned char)*p) && !strchr("<>=!()", *p) && i < MAX_NAME_LEN - 1) {
+        cond->column[i++] = *p++;
+    }
+    cond->column[i] = '\0';
+    if (i == 0) return 0;
+    while (isspace((unsigned char)*p)) p++;
+
+    if (match_keyword(&p, "BETWEEN")) {
+        if (!parse_operand(&p, cond->value, sizeof(cond->value), &cond->param, params)) return 0;
+        if (!match_keyword(&p, "AND")) return 0;
+        if (!parse_operand(&p, cond->value2, sizeof(cond->value2), &cond->param2, params)) return 0;
+        cond->op = CMP_BETWEEN;
+        *pp = p;
+        return 1;
+    }
+
+    if ((p[0] == '<' && p[1] == '>') ||
+        (p[0] == '!' && p[1] == '='))    { cond->op = CMP_NE; p += 2; }
+    else if (p[0] == '<' && p[1] == '=') { cond->op = CMP_LE; p += 2; }
+    else if (p[0] == '>' && p[1] == '=') { cond->op = CMP_GE; p += 2; }
+    else if (p[0] == '<')                { cond->op = CMP_LT; p += 1; }
+    else if (p[0] == '>')                { cond->op = CMP_GT; p += 1; }
+    else if (p[0] == '=')                { cond->op = CMP_EQ; p += 1; }
+    else return 0;
+    if (!parse_operand(&p, cond->value, sizeof(cond->value), &cond->param, params)) return 0;
+    *pp = p;
+    return 1;
+}
+
+static Expr* new_expr(ExprKind kind, Expr* left, Expr* right) {
+    Expr* e = calloc(1, sizeof(Expr));
+    if (!e) {
+        expr_free(left);
+        expr_free(right);
+        return NULL;
+    }
+    e->kind = kind;
+    e->left = left;
+    e->right = right;
+    return e;
+}
+
+static Expr* parse_or(char** p, int* params);
+
+/* not := NOT not | '(' or ')' | comparison */
+static Expr* parse_not(char** p, int* params) {
+    if (match_keyword(p, "NOT")) {
+        Expr* inner = parse_not(p, params);
+        return inner ? new_expr(EXPR_NOT, inner, NULL) : NULL;
+    }
+    char* s = *p;
+    while (isspace((unsigned char)*s)) s++;
+    if (*s == '(') {
+        *p = s + 1;
+        Expr* inner = parse_or(p, params);
+        if (!inner) return NULL;
+        s = *p;
+        while (isspace((unsigned char)*s)) s++;
+        if (*s != ')') {
+            expr_free(inner);
+            return NULL;
+        }
+        *p = s + 1;
+        return inner;
+    }
+    Expr* e = new_expr(EXPR_CMP, NULL, NULL);
+    if (e && !parse_comparison(p, &e->cmp, params)) {
+        free(e);
+        return NULL;
+    }
+    return e;
+}
+
+/* and := not (AND not)* */
+static Expr* parse_and(char** p, int* params) {
+    Expr* e = parse_not(p, params);
+    while (e && match_keyword(p, "AND")) {
+        Expr* right = parse_not(p, params);
+        if (!right) {
+            expr_free(e);
+            return NULL;
+        }
+        e = new_expr(EXPR_AND, e, right);
+    }
+    return e;
+}
+
+/* or := and (OR and)* */
+static Expr* parse_or(char** p, int* params) {
+    Expr* e = parse_and(p, params);
+    while (e && match_keyword(p, "OR")) {
+        Expr* right = parse_and(p, params);
+        if (!right) {
+            expr_free(e);
+            return NULL;
+        }
+        e = new_expr(EXPR_OR, e, right);
+    }
+    return e;
+}
+
+/* Parses a whole WHERE clause: comparisons joined by AND and OR, negated
+   with NOT and grouped with parentheses; AND binds tighter than OR. With
+   params, a bare ? operand is a placeholder numbered from *params + 1.
+   Returns NULL on a syntax error; free with expr_free. */
+static Expr* parse_where_params(char* s, int* params) {
+    char* p = s;
+    Expr* e = parse_or(&p, params);
+    if (e && !at_statement_end(p)) {
+        expr_free(e);
+        return NULL;
+    }
+    return e;
+}
+
+static Expr* parse_where(char* s) {
+    return parse_where_params(s, NULL);
+}
+
 //Comand execution dispatcher
 int execute_command(Database* db, char* input) {
     char* line = trim(input);
@@ -203,18 +424,28 @@ static int handle_meta(Database* db, char* line) {
             clock_t start = clock();
             Table* t = find_table(db, "bench");
             if (!t) {
-                ColumnDef cols[2] = { {"id", COL_INT}, {"value", COL_TEXT} };
+                ColumnDef cols[2] = { {"id", COL_INT, 0}, {"value", COL_TEXT, 0} };
                 create_table(db, "bench", cols, 2);
                 t = find_table(db, "bench");
             }
 
-            char idbuf[32], valbuf[32];
+            // Generate the rows up front and ingest them as one batch
+            if (n < 0) n = 0;
+            Arena scratch;
+            arena_init(&scratch);
+            char*** rows = malloc(sizeof(char**) * (size_t)(n > 0 ? n : 1));
+            if (!rows) return 0;
+            char buf[32];
             for (int i = 0; i < n; i++) {
-                snprintf(idbuf, sizeof(idbuf), "%d", i);
-                snprintf(valbuf, sizeof(valbuf), "%d", rand() % 1000);
-                char* vals[2] = { idbuf, valbuf };
-                insert_row(db, "bench", vals, 2);
+                rows[i] = arena_alloc(&scratch, sizeof(char*) * 2);
+                snprintf(buf, sizeof(buf), "%d", i);
+                rows[i][0] = arena_strdup(&scratch, buf);
+                snprintf(buf, sizeof(buf), "%d", rand() % 1000);
+                rows[i][1] = arena_strdup(&scratch, buf);
             }
+            insert_rows(db, "bench", rows, n);
+            free(rows);
+            arena_free(&scratch);
             clock_t end = clock();
             double ms = 1000.0 * (end - start) / CLOCKS_PER_SEC;
             printf("Inserted %d rows in %.2f ms (%s mode)\n",
@@ -226,6 +457,37 @@ static int handle_meta(Database* db, char* line) {
         return 0;
     }
 
+    if (strncmp(line, ".vacuum", 7) == 0) {
+        char tname[MAX_NAME_LEN];
+        int has_name = sscanf(line + 7, "%63s", tname) == 1;
+        // A named materialized view is handled like its own table
+        Table* only = has_name ? find_table(db, tname) : NULL;
+        if (has_name && !only) {
+            printf("Error: table '%s' not found.\n", tname);
+            return 0;
+        }
+        for (int i = 0; i < (only ? 1 : db->num_tables); i++) {
+            Table* t = only ? only : &db->tables[i];
+            int removed = vacuum_table(t);
+            printf("Vacuumed '%s': %d row(s) reclaimed.\n", t->name, removed);
+        }
+        return 0;
+    }
+    if (strncmp(line, ".stats", 6) == 0) {
+        char tname[MAX_NAME_LEN];
+        int has_name = sscanf(line + 6, "%63s", tname) == 1;
+        Table* only = has_name ? find_table(db, tname) : NULL;
+        if (has_name && !only) {
+            printf("Error: table '%s' not found.\n", tname);
+            return 0;
+        }
+        for (int i = 0; i < (only ? 1 : db->num_tables); i++) {
+            Table* t = only ? only : &db->tables[i];
+            print_table_stats(t);
+        }
+        if (!has_name && db->cache) print_cache_stats(db);
+        return 0;
+    }
     if (strncmp(line, ".load", 5) == 0) {
         char fname[256];
         if (sscanf(line + 5, "%255s", fname) == 1) {
@@ -243,18 +505,48 @@ static int handle_meta(Database* db, char* line) {
     if (sscanf(line + 12, "%15s", mode) == 1) {
         if (strcmp(mode, "on") == 0) {
             db->column_store = 1;
-            printf("Column-major storage mode ON.\n");
+            printf("New tables default to column-major storage.\n");
         } else if (strcmp(mode, "off") == 0) {
             db->column_store = 0;
-            printf("Row-major storage mode ON.\n");
+            printf("New tables default to row-major storage.\n");
         } else {
             printf("Usage: .columnstore [on|off]\n");
         }
     } else {
-        printf("Current storage mode: %s\n", db->column_store ? "column-major" : "row-major");
+        printf("Default storage layout: %s\n", db->column_store ? "column-major" : "row-major");
     }
     return 0;
     }
+    if (strncmp(line, ".cache", 6) == 0) {
+        char arg[16];
+        if (sscanf(line + 6, "%15s", arg) == 1) {
+            if (strcmp(arg, "off") == 0) {
+                cache_free(db->cache);
+                db->cache = NULL;
+            } else {
+                char* end = NULL;
+                long kb = strcmp(arg, "on") == 0 ? CACHE_DEFAULT_KB : strtol(arg, &end, 10);
+                if ((end && *end != '\0') || kb <= 0) {
+                    printf("Usage: .cache [on|off|kilobytes]\n");
+                    return 0;
+                }
+                if (!cache_enable(db, (size_t)kb * 1024)) fprintf(stderr, "Out of memory creating the result cache.\n");
+            }
+        }
+        print_cache_stats(db);
+        return 0;
+    }
+    if (strncmp(line, ".mode", 5) == 0) {
+        char mode[16];
+        if (sscanf(line + 5, "%15s", mode) == 1) {
+            int m = parse_output_mode(mode);
+            if (m < 0) printf("Usage: .mode [list|tsv|csv|binary]\n");
+            else db->output_mode = (OutputMode)m;
+        } else {
+            printf("Output mode: %s\n", output_mode_name(db->output_mode));
+        }
+        return 0;
+    }
     if (strcmp(line, ".meminfo") == 0) {
     static int global_var = 42;   // global/static region
     int local_var = 123;          // stack
@@ -276,6 +568,53 @@ static int handle_meta(Database* db, char* line) {
     free(heap_var);
     return 0;
     }
+    if (strncmp(line, ".simd", 5) == 0) {
+    char mode[16];
+    if (sscanf(line + 5, "%15s", mode) == 1) {
+        SimdLevel want;
+        if (strcmp(mode, "auto") == 0 || strcmp(mode, "avx2") == 0) want = SIMD_AVX2;
+        else if (strcmp(mode, "sse2") == 0) want = SIMD_SSE2;
+        else if (strcmp(mode, "scalar") == 0) want = SIMD_SCALAR;
+        else {
+            printf("Usage: .simd [auto|avx2|sse2|scalar]\n");
+            return 0;
+        }
+        printf("Filter kernels: %s\n", simd_level_name(simd_set_level(want)));
+    } else {
+        printf("Filter kernels: %s (CPU supports %s)\n",
+               simd_level_name(simd_level()), simd_level_name(simd_detect()));
+    }
+    return 0;
+    }
+    if (strncmp(line, ".threads", 8) == 0) {
+    char mode[16];
+    if (sscanf(line + 8, "%15s", mode) == 1) {
+        char* end = NULL;
+        long n = strtol(mode, &end, 10);
+        if (strcmp(mode, "auto") == 0) {
+            parallel_set_threads(0);
+        } else if (*end != '\0' || n < 1) {
+            printf("Usage: .threads [N|auto]\n");
+            return 0;
+        } else {
+            parallel_set_threads((int)n);
+        }
+    }
+    printf("Scan threads: %d\n", parallel_threads());
+    return 0;
+    }
+    if (strncmp(line, ".sortmem", 8) == 0) {
+    long kb;
+    if (sscanf(line + 8, "%ld", &kb) == 1) {
+        if (kb <= 0) {
+            printf("Usage: .sortmem [kilobytes]\n");
+            return 0;
+        }
+        sort_set_budget((size_t)kb * 1024);
+    }
+    printf("Sort memory budget: %zu KB\n", sort_budget() / 1024);
+    return 0;
+    }
     if (strncmp(line, ".binary", 7) == 0) {
     char mode[16];
     if (sscanf(line + 7, "%15s", mode) == 1) {
@@ -336,23 +675,70 @@ static void parse_create_table(Database* db, char* line) {
     }
     *end_paren = '\0';
 
+    // Optional trailing LAYOUT ROW|COLUMN, otherwise the session default
+    int column_major = db->column_store;
+    char* tail = trim(end_paren + 1);
+    if (*tail && *tail != ';') {
+        char kw[16], mode[16];
+        if (sscanf(tail, "%15s %15[A-Za-z]", kw, mode) != 2 || strcasecmp(kw, "LAYOUT") != 0 ||
+            (column_major = parse_layout(mode)) < 0) {
+            printf("Syntax error: expected LAYOUT ROW|COLUMN after column list.\n");
+            return;
+        }
+    }
+
     int cap = 8;
     int num_cols = 0;
     ColumnDef* cols = malloc(sizeof(ColumnDef) * cap);
     if (!cols) return;
 
+    int has_primary_key = 0;
     char* tok = strtok(p, ",");
     while (tok) {
         char* def = trim(tok);
         if (*def) {
             char cname[MAX_NAME_LEN];
             char ctype[32];
-            if (sscanf(def, "%63s %31s", cname, ctype) != 2) {
+            int consumed = 0;
+            if (sscanf(def, "%63s %31s%n", cname, ctype, &consumed) != 2) {
                 printf("Syntax error in column definition: '%s'\n", def);
                 free(cols);
                 return;
             }
 
+            // Optional modifiers after the type
+            int flags = 0;
+            char mod[32];
+            int used = 0;
+            char* m = def + consumed;
+            while (sscanf(m, "%31s%n", mod, &used) == 1) {
+                m += used;
+                if (strcasecmp(mod, "DICT") == 0) {
+                    flags |= COLUMN_DICT;
+                } else if (strcasecmp(mod, "UNIQUE") == 0) {
+                    flags |= COLUMN_UNIQUE;
+                } else if (strcasecmp(mod, "PRIMARY") == 0 &&
+                           sscanf(m, "%31s%n", mod, &used) == 1 && strcasecmp(mod, "KEY") == 0) {
+                    m += used;
+                    if (has_primary_key) {
+                        printf("Error: a table can have only one PRIMARY KEY.\n");
+                        free(cols);
+                        return;
+                    }
+                    has_primary_key = 1;
+                    flags |= COLUMN_PRIMARY_KEY | COLUMN_UNIQUE;
+                } else {
+                    printf("Syntax error: unknown column modifier '%s'.\n", mod);
+                    free(cols);
+                    return;
+                }
+            }
+            if ((flags & COLUMN_DICT) && parse_column_type(ctype) != COL_TEXT) {
+                printf("Error: DICT only applies to TEXT columns.\n");
+                free(cols);
+                return;
+            }
+
             if (num_cols >= cap) {
                 cap *= 2;
                 ColumnDef* tmp = realloc(cols, sizeof(ColumnDef) * cap);
@@ -366,6 +752,7 @@ static void parse_create_table(Database* db, char* line) {
             strncpy(cols[num_cols].name, cname, MAX_NAME_LEN - 1);
             cols[num_cols].name[MAX_NAME_LEN - 1] = '\0';
             cols[num_cols].type = parse_column_type(ctype);
+            cols[num_cols].flags = flags;
             num_cols++;
         }
         tok = strtok(NULL, ",");
@@ -377,7 +764,9 @@ static void parse_create_table(Database* db, char* line) {
         return;
     }
 
-    create_table(db, tname, cols, num_cols);
+    if (create_table(db, tname, cols, num_cols)) {
+        set_table_layout(find_table(db, tname), column_major);
+    }
     free(cols);
 }
 
@@ -404,32 +793,334 @@ static void parse_insert(Database* db, char* line) {
         return;
     }
 
-    char* lp = strchr(values_kw, '(');
-    char* rp = strrchr(values_kw, ')');
-    if (!lp || !rp || rp <= lp + 1) {
-        printf("Syntax error: invalid VALUES list.\n");
+    // VALUES (v1, v2, ...)[, (v1, v2, ...)]*
+    int cap = 4;
+    int nrows = 0;
+    int* counts = malloc(sizeof(int) * (size_t)cap);
+    char*** rows = malloc(sizeof(char**) * (size_t)cap);
+    if (!counts || !rows) {
+        free(counts);
+        free(rows);
         return;
     }
-    *rp = '\0';
-    char* vals_str = lp + 1;
 
-    int count = 0;
-    char** vals = parse_values_list(vals_str, &count);
-    if (!vals) {
-        printf("Error parsing values.\n");
-        return;
+    int ok = 1;
+    char* q = values_kw + strlen("VALUES");
+    while (ok) {
+        while (isspace((unsigned char)*q)) q++;
+        if (*q != '(') {
+            ok = 0;
+            break;
+        }
+        char* lp = q;
+        char* rp = find_group_end(lp);
+        if (!rp || rp <= lp + 1) {
+            ok = 0;
+            break;
+        }
+        *rp = '\0';
+
+        if (nrows >= cap) {
+            cap *= 2;
+            int* ctmp = realloc(counts, sizeof(int) * (size_t)cap);
+            if (ctmp) counts = ctmp;
+            char*** rtmp = realloc(rows, sizeof(char**) * (size_t)cap);
+            if (rtmp) rows = rtmp;
+            if (!ctmp || !rtmp) {
+                ok = 0;
+                break;
+            }
+        }
+        rows[nrows] = parse_values_list(lp + 1, &counts[nrows]);
+        if (!rows[nrows]) {
+            printf("Error parsing values.\n");
+            ok = 0;
+            break;
+        }
+        nrows++;
+
+        q = rp + 1;
+        while (isspace((unsigned char)*q)) q++;
+        if (*q == ',') {
+            q++;
+        } else {
+            break;
+        }
+    }
+    if (ok && nrows == 0) ok = 0;
+    if (!ok) printf("Syntax error: invalid VALUES list.\n");
+
+    if (ok && nrows == 1) {
+        insert_row(db, tname, rows[0], counts[0]);
+    } else if (ok) {
+        Table* t = find_table(db, tname);
+        int expected = t ? t->num_columns : 0;
+        for (int r = 0; r < nrows && t; r++) {
+            if (counts[r] != expected) {
+                printf("Error: expected %d values, got %d in row %d.\n", expected, counts[r], r + 1);
+                ok = 0;
+                break;
+            }
+        }
+        if (ok) insert_rows(db, tname, rows, nrows);
+    }
+
+    for (int r = 0; r < nrows; r++) {
+        for (int i = 0; i < counts[r]; i++) free(rows[r][i]);
+        free(rows[r]);
+    }
+    free(rows);
+    free(counts);
+}
+
+/* Parses one SELECT list entry: col, or FUNC(col) for COUNT, SUM, AVG, MIN
+   and MAX, with COUNT(*) counting rows. */
+static int parse_select_item(char* s, SelectItem* item) {
+    memset(item, 0, sizeof(SelectItem));
+    char* open = strchr(s, '(');
+    if (!open) {
+        s = trim(s);
+        if (*s == '\0' || strcmp(s, "*") == 0) return 0;
+        strncpy(item->column, s, MAX_NAME_LEN - 1);
+        return 1;
+    }
+    char* close = strchr(open, ')');
+    if (!close || *trim(close + 1) != '\0') return 0;
+    *open = '\0';
+    *close = '\0';
+    char* fn = trim(s);
+    char* arg = trim(open + 1);
+
+    static const struct { const char* name; AggFunc func; } funcs[] = {
+        { "COUNT", AGG_COUNT }, { "SUM", AGG_SUM }, { "AVG", AGG_AVG },
+        { "MIN", AGG_MIN }, { "MAX", AGG_MAX },
+    };
+    for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+        if (strcasecmp(fn, funcs[i].name) == 0) item->func = funcs[i].func;
+    }
+    if (item->func == AGG_NONE || *arg == '\0') return 0;
+    if (strcmp(arg, "*") == 0 && item->func != AGG_COUNT) return 0;
+    strncpy(item->column, arg, MAX_NAME_LEN - 1);
+    return 1;
+}
+
+/* SELECT with aggregates and/or GROUP BY: items come from cols_str, rest
+   holds an optional WHERE, group_str the GROUP BY list (NULL if absent). */
+static int parse_aggregate_select(Database* db, const char* tname, char* cols_str,
+                                  char* rest, char* group_str, const RowLimit* limit) {
+    SelectItem items[MAX_SELECT_ITEMS];
+    char* group_cols[MAX_SELECT_ITEMS];
+    int num_items = 0;
+    int num_group = 0;
+
+    for (char* tok = strtok(cols_str, ","); tok; tok = strtok(NULL, ",")) {
+        if (num_items == MAX_SELECT_ITEMS || !parse_select_item(tok, &items[num_items])) {
+            printf("Syntax error in SELECT list.\n");
+            return 0;
+        }
+        num_items++;
     }
+    if (group_str) {
+        char* semi = strchr(group_str, ';');
+        if (semi) *semi = '\0';
+        for (char* tok = strtok(group_str, ","); tok; tok = strtok(NULL, ",")) {
+            char* c = trim(tok);
+            if (*c == '\0' || num_group == MAX_SELECT_ITEMS) {
+                printf("Syntax error in GROUP BY.\n");
+                return 0;
+            }
+            group_cols[num_group++] = c;
+        }
+        if (num_group == 0) {
+            printf("Syntax error in GROUP BY.\n");
+            return 0;
+        }
+    }
+
+    Expr* where = NULL;
+    char* where_kw = strstr(rest, "WHERE");
+    if (where_kw) {
+        where = parse_where(where_kw + strlen("WHERE"));
+        if (!where) {
+            printf("Syntax error in WHERE clause.\n");
+            return 0;
+        }
+    }
+    int ok = select_aggregate(db, tname, items, num_items, group_cols, num_group, where, limit);
+    expr_free(where);
+    return ok;
+}
+
+/* Parses "col [ASC|DESC]", the text after ORDER BY. */
+static int parse_order_by(char* s, OrderBy* order) {
+    memset(order, 0, sizeof(OrderBy));
+    char* p = s;
+    while (isspace((unsigned char)*p)) p++;
+    size_t i = 0;
+    while (*p && !isspace((unsigned char)*p) && *p != ';' && i < MAX_NAME_LEN - 1) {
+        order->column[i++] = *p++;
+    }
+    order->column[i] = '\0';
+    if (i == 0) return 0;
+
+    if (match_keyword(&p, "DESC")) order->desc = 1;
+    else match_keyword(&p, "ASC");
+    return at_statement_end(p);
+}
+
+/* One LIMIT or OFFSET operand: a non-negative integer, or ? when q is
+   given (*q is then set). */
+static int parse_limit_operand(char** p, int64_t* out, int* q) {
+    char num[32];
+    if (!parse_literal(p, num, sizeof(num))) return 0;
+    if (q && strcmp(num, "?") == 0) {
+        *q = 1;
+        return 1;
+    }
+    return parse_int_value(num, out) && *out >= 0;
+}
+
+/* Cuts a trailing "LIMIT n [OFFSET m]" off s into limit (count -1 when
+   there is none). LIMIT inside a quoted literal is left alone. With
+   params, n and m may be ?, flagged in params[0] and params[1]. Returns 0
+   on a malformed clause. */
+static int parse_limit(char* s, RowLimit* limit, int* params) {
+    limit->count = -1;
+    limit->offset = 0;
+    char* kw = NULL;
+    int quoted = 0;
+    for (char* p = s; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        else if (!quoted && (p == s || isspace((unsigned char)p[-1])) && strncmp(p, "LIMIT", 5) == 0 &&
+                 (p[5] == '\0' || isspace((unsigned char)p[5]))) kw = p;
+    }
+    if (!kw) return 1;
+    *kw = '\0';
 
-    insert_row(db, tname, vals, count);
-    for (int i = 0; i < count; i++) free(vals[i]);
-    free(vals);
+    char* p = kw + strlen("LIMIT");
+    if (!parse_limit_operand(&p, &limit->count, params ? &params[0] : NULL)) return 0;
+    if (match_keyword(&p, "OFFSET") &&
+        !parse_limit_operand(&p, &limit->offset, params ? &params[1] : NULL)) {
+        return 0;
+    }
+    return at_statement_end(p);
+}
+
+/* Splits a SELECT list into owned column names; * expands to every column
+   of tname. Returns NULL (nothing to free) on an unknown table or out of
+   memory. */
+static char** parse_column_list(Database* db, const char* tname, char* cols_str, int* out_n) {
+    int cap = 8;
+    int n = 0;
+    *out_n = 0;
+    if (strcmp(cols_str, "*") == 0) {
+        Table* t = find_table(db, tname);
+        if (!t) {
+            printf("Error: table '%s' not found.\n", tname);
+            return NULL;
+        }
+        cap = t->num_columns;
+    }
+    char** cols = malloc(sizeof(char*) * (cap > 0 ? cap : 1));
+    if (!cols) return NULL;
+
+    if (strcmp(cols_str, "*") == 0) {
+        Table* t = find_table(db, tname);
+        for (int c = 0; c < t->num_columns; c++) {
+            cols[n++] = str_duplicate(t->columns[c].name);
+        }
+    } else {
+        for (char* tok = strtok(cols_str, ","); tok; tok = strtok(NULL, ",")) {
+            char* c = trim(tok);
+            if (!*c) continue;
+            if (n >= cap) {
+                cap *= 2;
+                char** tmp = realloc(cols, sizeof(char*) * cap);
+                if (!tmp) {
+                    for (int k = 0; k < n; k++) free(cols[k]);
+                    free(cols);
+                    return NULL;
+                }
+                cols = tmp;
+            }
+            cols[n++] = str_duplicate(c);
+        }
+    }
+    *out_n = n;
+    return cols;
+}
+
+static void free_column_list(char** cols, int n) {
+    for (int k = 0; k < n; k++) free(cols[k]);
+    free(cols);
 }
 
-static void parse_select(Database* db, char* line) {
+/* Copies an identifier (table or table.col) up to whitespace, '=' or ';'. */
+static int parse_identifier(char** pp, char* buf, size_t buf_sz) {
+    char* p = *pp;
+    while (isspace((unsigned char)*p)) p++;
+    size_t i = 0;
+    while (*p && !isspace((unsigned char)*p) && !strchr("=;", *p) && i < buf_sz - 1) buf[i++] = *p++;
+    buf[i] = '\0';
+    *pp = p;
+    return i > 0;
+}
+
+/* FROM left JOIN right ON x = y [WHERE ...]; rest starts after JOIN. */
+static int parse_join_select(Database* db, const char* left, char* cols_str, char* rest,
+                             const RowLimit* limit) {
+    JoinSpec join;
+    memset(&join, 0, sizeof(JoinSpec));
+    snprintf(join.left, sizeof(join.left), "%s", left);
+
+    char* p = rest;
+    if (!parse_identifier(&p, join.right, sizeof(join.right)) || !match_keyword(&p, "ON") ||
+        !parse_identifier(&p, join.left_col, sizeof(join.left_col))) {
+        printf("Syntax error: expected JOIN <table> ON <col> = <col>.\n");
+        return 0;
+    }
+    while (isspace((unsigned char)*p)) p++;
+    if (*p++ != '=' || !parse_identifier(&p, join.right_col, sizeof(join.right_col))) {
+        printf("Syntax error: expected JOIN <table> ON <col> = <col>.\n");
+        return 0;
+    }
+    if (strstr(p, "ORDER BY") || strstr(p, "GROUP BY") || strchr(cols_str, '(')) {
+        printf("Error: ORDER BY, GROUP BY and aggregates are not supported with JOIN.\n");
+        return 0;
+    }
+
+    Expr* where = NULL;
+    if (match_keyword(&p, "WHERE")) {
+        where = parse_where(p);
+        if (!where) {
+            printf("Syntax error in WHERE clause.\n");
+            return 0;
+        }
+    } else if (!at_statement_end(p)) {
+        printf("Syntax error after JOIN ... ON.\n");
+        return 0;
+    }
+
+    int ok = 0;
+    if (strcmp(cols_str, "*") == 0) {
+        ok = select_join(db, &join, NULL, 0, where, limit);
+    } else {
+        int n = 0;
+        char** cols = parse_column_list(db, left, cols_str, &n);
+        if (cols) {
+            ok = select_join(db, &join, cols, n, where, limit);
+            free_column_list(cols, n);
+        }
+    }
+    expr_free(where);
+    return ok;
+}
+
+static int parse_select(Database* db, char* line) {
     char* from_kw = strstr(line, "FROM");
     if (!from_kw) {
         printf("Syntax error: missing FROM.\n");
-        return;
+        return 0;
     }
 
     char select_part[512] = {0};
@@ -445,7 +1136,7 @@ static void parse_select(Database* db, char* line) {
 
     if (*cols_str == '\0') {
         printf("Syntax error: missing columns in SELECT.\n");
-        return;
+        return 0;
     }
 
     char tname[MAX_NAME_LEN];
@@ -458,18 +1149,72 @@ static void parse_select(Database* db, char* line) {
 
     if (tname[0] == '\0') {
         printf("Syntax error: missing table name in SELECT.\n");
-        return;
+        return 0;
+    }
+
+    // LIMIT closes the statement; the clauses before it parse without it
+    RowLimit limit;
+    if (!parse_limit(rest, &limit, NULL)) {
+        printf("Syntax error in LIMIT.\n");
+        return 0;
+    }
+
+    if (match_keyword(&rest, "JOIN")) {
+        return parse_join_select(db, tname, cols_str, rest, &limit);
+    }
+
+    // ORDER BY and GROUP BY end the statement; cut them off so WHERE parses on its own
+    OrderBy order;
+    char* order_kw = strstr(rest, "ORDER BY");
+    if (order_kw) {
+        *order_kw = '\0';
+        if (!parse_order_by(order_kw + strlen("ORDER BY"), &order)) {
+            printf("Syntax error in ORDER BY.\n");
+            return 0;
+        }
+    }
+    char* group_str = NULL;
+    char* group_kw = strstr(rest, "GROUP BY");
+    if (group_kw) {
+        *group_kw = '\0';
+        group_str = group_kw + strlen("GROUP BY");
+    }
+    if (group_str || strchr(cols_str, '(')) {
+        if (order_kw) {
+            printf("Error: ORDER BY is not supported with aggregates.\n");
+            return 0;
+        }
+        return parse_aggregate_select(db, tname, cols_str, rest, group_str, &limit);
+    }
+
+    if (order_kw) {
+        Expr* where = NULL;
+        char* where_kw = strstr(rest, "WHERE");
+        if (where_kw && !(where = parse_where(where_kw + strlen("WHERE")))) {
+            printf("Syntax error in WHERE clause.\n");
+            return 0;
+        }
+        int ok = 0;
+        int n = 0;
+        char** cols = parse_column_list(db, tname, cols_str, &n);
+        if (cols) {
+            ok = select_ordered(db, tname, cols, n, where, &order, &limit);
+            free_column_list(cols, n);
+        }
+        expr_free(where);
+        return ok;
     }
 
+    int ok = 0;
     char* where_kw = strstr(rest, "WHERE");
     if (!where_kw) {
         if (strcmp(cols_str, "*") == 0) {
-            select_all(db, tname);
+            ok = select_all(db, tname, &limit);
         } else {
             int cap = 8;
             int n = 0;
             char** cols = malloc(sizeof(char*) * cap);
-            if (!cols) return;
+            if (!cols) return 0;
 
             char* tok = strtok(cols_str, ",");
             while (tok) {
@@ -481,7 +1226,7 @@ static void parse_select(Database* db, char* line) {
                         if (!tmp) {
                             for (int k = 0; k < n; k++) free(cols[k]);
                             free(cols);
-                            return;
+                            return 0;
                         }
                         cols = tmp;
                     }
@@ -490,7 +1235,7 @@ static void parse_select(Database* db, char* line) {
                 tok = strtok(NULL, ",");
             }
 
-            select_columns(db, tname, cols, n);
+            ok = select_columns(db, tname, cols, n, &limit);
             for (int k = 0; k < n; k++) free(cols[k]);
             free(cols);
         }
@@ -499,51 +1244,21 @@ static void parse_select(Database* db, char* line) {
         char* after_where = where_kw + strlen("WHERE");
         after_where = trim(after_where);
 
-        char col[64];
-        char val[256];
-        if (!parse_condition_eq(after_where, col, sizeof(col), val, sizeof(val))) {
+        Expr* where = parse_where(after_where);
+        if (!where) {
             printf("Syntax error in WHERE clause.\n");
-            return;
+            return 0;
         }
 
-        int cap = 8;
         int n = 0;
-        char** cols = malloc(sizeof(char*) * cap);
-        if (!cols) return;
-
-        if (strcmp(cols_str, "*") == 0) {
-            Table* t = find_table(db, tname);
-            if (!t) { free(cols); return; }
-            cap = t->num_columns;
-            cols = realloc(cols, sizeof(char*) * cap);
-            for (int c = 0; c < t->num_columns; c++) {
-                cols[n++] = str_duplicate(t->columns[c].name);
-            }
-        } else {
-            char* tok = strtok(cols_str, ",");
-            while (tok) {
-                char* c = trim(tok);
-                if (*c) {
-                    if (n >= cap) {
-                        cap *= 2;
-                        char** tmp = realloc(cols, sizeof(char*) * cap);
-                        if (!tmp) {
-                            for (int k = 0; k < n; k++) free(cols[k]);
-                            free(cols);
-                            return;
-                        }
-                        cols = tmp;
-                    }
-                    cols[n++] = str_duplicate(c);
-                }
-                tok = strtok(NULL, ",");
-            }
+        char** cols = parse_column_list(db, tname, cols_str, &n);
+        if (cols) {
+            ok = select_where(db, tname, cols, n, where, &limit);
+            free_column_list(cols, n);
         }
-
-        select_where_eq(db, tname, cols, n, col, val);
-        for (int k = 0; k < n; k++) free(cols[k]);
-        free(cols);
+        expr_free(where);
     }
+    return ok;
 }
 
 static void parse_delete(Database* db, char* line) {
@@ -569,16 +1284,14 @@ static void parse_delete(Database* db, char* line) {
         return;
     }
 
-    char* cond = trim(where_kw + strlen("WHERE"));
-    char col[64];
-    char val[256];
-
-    if (!parse_condition_eq(cond, col, sizeof(col), val, sizeof(val))) {
+    Expr* where = parse_where(where_kw + strlen("WHERE"));
+    if (!where) {
         printf("Syntax error in WHERE clause.\n");
         return;
     }
 
-    delete_where_eq(db, tname, col, val);
+    delete_where(db, tname, where);
+    expr_free(where);
 }
 
 static void parse_update(Database* db, char* line) {
@@ -618,16 +1331,14 @@ static void parse_update(Database* db, char* line) {
         return;
     }
 
-    char* where_cond = trim(where_kw + strlen("WHERE"));
-    char where_col[64];
-    char where_val[256];
-    if (!parse_condition_eq(where_cond, where_col, sizeof(where_col),
-                            where_val, sizeof(where_val))) {
+    Expr* where = parse_where(where_kw + strlen("WHERE"));
+    if (!where) {
         printf("Syntax error in WHERE clause.\n");
         return;
     }
 
-    update_where_eq(db, tname, set_col, set_val, where_col, where_val);
+    update_where(db, tname, set_col, set_val, where);
+    expr_free(where);
 }
 
 /* ============================================================
@@ -644,7 +1355,9 @@ static void handle_insert(Database* db, char* input)  {
 }
 static void handle_select(Database* db, char* input)  { 
     db_log("[SELECT] %s", input);
-    parse_select(db, input); 
+    if (db->cache && cache_replay(db, input)) return;
+    int ok = parse_select(db, input);
+    if (db->cache) cache_store(db, input, ok);
 }
 static void handle_update(Database* db, char* input)  { 
     parse_update(db, input); 
@@ -663,3 +1376,326 @@ static void handle_drop(Database* db, char* input) {
         printf("Syntax error in DROP TABLE.\n");
     }
 }
+
+static void handle_alter(Database* db, char* input) {
+    // ALTER TABLE name SET LAYOUT ROW|COLUMN
+    char tname[MAX_NAME_LEN];
+    char mode[16];
+    if (sscanf(input, "ALTER TABLE %63s SET LAYOUT %15[A-Za-z]", tname, mode) != 2) {
+        printf("Syntax error: expected ALTER TABLE <name> SET LAYOUT ROW|COLUMN.\n");
+        return;
+    }
+    int column_major = parse_layout(mode);
+    if (column_major < 0) {
+        printf("Syntax error: unknown layout '%s'.\n", mode);
+        return;
+    }
+    Table* t = find_table(db, tname);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", tname);
+        return;
+    }
+    if (t->view) {
+        printf("Error: '%s' is a materialized view and cannot be changed directly.\n", tname);
+        return;
+    }
+    db_log("[ALTER] %s", input);
+    if (!set_table_layout(t, column_major)) {
+        fprintf(stderr, "Out of memory changing layout of '%s'.\n", tname);
+        return;
+    }
+    printf("Table '%s' is now %s.\n", tname, column_major ? "column-major" : "row-major");
+}
+
+static void handle_create_index(Database* db, char* input) {
+    // CREATE INDEX name ON table(col) [USING HASH|BTREE]
+    char iname[MAX_NAME_LEN], tname[MAX_NAME_LEN], cname[MAX_NAME_LEN];
+    int used = 0;
+    if (sscanf(input, "CREATE INDEX %63s ON %63[^( ] ( %63[^) ] )%n", iname, tname, cname, &used) != 3 ||
+        used == 0) {
+        printf("Syntax error: expected CREATE INDEX <name> ON <table>(<column>).\n");
+        return;
+    }
+    int kind = INDEX_HASH;
+    char* rest = trim(input + used);
+    char using_kw[16], kind_str[16];
+    if (*rest && *rest != ';') {
+        if (sscanf(rest, "%15s %15[A-Za-z]", using_kw, kind_str) != 2 ||
+            strcasecmp(using_kw, "USING") != 0) {
+            printf("Syntax error: expected USING HASH or USING BTREE.\n");
+            return;
+        }
+        if (strcasecmp(kind_str, "BTREE") == 0) {
+            kind = INDEX_BTREE;
+        } else if (strcasecmp(kind_str, "HASH") != 0) {
+            printf("Syntax error: expected USING HASH or USING BTREE.\n");
+            return;
+        }
+    }
+    db_log("[CREATE INDEX] %s", input);
+    if (create_index(db, iname, tname, cname, kind)) {
+        printf("Index '%s' created on %s(%s).\n", iname, tname, cname);
+    }
+}
+
+/* Cuts a trailing "AS name" off a SELECT item; returns the name, or NULL
+   when the item has none. */
+static char* cut_alias(char* s) {
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) end--;
+    char* name = end;
+    while (name > s && !isspace((unsigned char)name[-1])) name--;
+    char* kw = name;
+    while (kw > s && isspace((unsigned char)kw[-1])) kw--;
+    if (name == end || kw - s < 3 || strncasecmp(kw - 2, "AS", 2) != 0 ||
+        !isspace((unsigned char)kw[-3])) {
+        return NULL;
+    }
+    *end = '\0';
+    kw[-2] = '\0';
+    return name;
+}
+
+static void handle_create_view(Database* db, char* input) {
+    // CREATE MATERIALIZED VIEW name AS SELECT item [AS alias], ... FROM table GROUP BY col, ...
+    const char* usage = "Syntax error: expected CREATE MATERIALIZED VIEW <name> AS SELECT ... "
+                        "FROM <table> GROUP BY <columns>.\n";
+    db_log("[CREATE VIEW] %s", input);
+    char vname[MAX_NAME_LEN], tname[MAX_NAME_LEN];
+    char* p = input + strlen("CREATE MATERIALIZED VIEW");
+    char* from_kw = strstr(p, "FROM");
+    if (!parse_identifier(&p, vname, sizeof(vname)) || !match_keyword(&p, "AS") ||
+        !match_keyword(&p, "SELECT") || !from_kw || from_kw < p) {
+        printf("%s", usage);
+        return;
+    }
+    *from_kw = '\0';
+    char* rest = from_kw + strlen("FROM");
+    if (!parse_identifier(&rest, tname, sizeof(tname))) {
+        printf("%s", usage);
+        return;
+    }
+    if (match_keyword(&rest, "WHERE")) {
+        printf("Error: WHERE is not supported in a materialized view.\n");
+        return;
+    }
+
+    SelectItem items[MAX_SELECT_ITEMS];
+    char* names[MAX_SELECT_ITEMS];
+    char* group_cols[MAX_SELECT_ITEMS];
+    int num_items = 0;
+    int num_group = 0;
+    for (char* tok = strtok(p, ","); tok; tok = strtok(NULL, ",")) {
+        if (num_items == MAX_SELECT_ITEMS) {
+            printf("Syntax error in SELECT list.\n");
+            return;
+        }
+        names[num_items] = cut_alias(tok);
+        if (!parse_select_item(tok, &items[num_items])) {
+            printf("Syntax error in SELECT list.\n");
+            return;
+        }
+        num_items++;
+    }
+    if (match_keyword(&rest, "GROUP")) {
+        if (!match_keyword(&rest, "BY")) {
+            printf("Syntax error in GROUP BY.\n");
+            return;
+        }
+        char* semi = strchr(rest, ';');
+        if (semi) *semi = '\0';
+        for (char* tok = strtok(rest, ","); tok; tok = strtok(NULL, ",")) {
+            char* c = trim(tok);
+            if (*c == '\0' || strpbrk(c, " \t") || num_group == MAX_SELECT_ITEMS) {
+                printf("Syntax error in GROUP BY.\n");
+                return;
+            }
+            group_cols[num_group++] = c;
+        }
+    } else if (!at_statement_end(rest)) {
+        printf("%s", usage);
+        return;
+    }
+
+    if (create_view(db, vname, tname, items, names, num_items, group_cols, num_group)) {
+        printf("Materialized view '%s' created with %d group(s).\n", vname, find_table(db, vname)->num_rows);
+    }
+}
+
+static void handle_drop_view(Database* db, char* input) {
+    char vname[MAX_NAME_LEN];
+    if (sscanf(input, "DROP MATERIALIZED VIEW %63s", vname) == 1) {
+        size_t len = strlen(vname);
+        if (len > 0 && vname[len - 1] == ';') vname[len - 1] = '\0';
+        drop_view(db, vname);
+    } else {
+        printf("Syntax error in DROP MATERIALIZED VIEW.\n");
+    }
+}
+
+static void handle_analyze(Database* db, char* input) {
+    // ANALYZE [table]
+    char tname[MAX_NAME_LEN];
+    int has_name = sscanf(input, "ANALYZE %63s", tname) == 1;
+    if (has_name) {
+        size_t len = strlen(tname);
+        if (len > 0 && tname[len - 1] == ';') tname[len - 1] = '\0';
+        has_name = tname[0] != '\0';
+    }
+    Table* only = has_name ? find_table(db, tname) : NULL;
+    if (has_name && !only) {
+        printf("Error: table '%s' not found.\n", tname);
+        return;
+    }
+    for (int i = 0; i < (only ? 1 : db->num_tables); i++) {
+        Table* t = only ? only : &db->tables[i];
+        if (analyze_table(t)) {
+            printf("Analyzed '%s': %" PRId64 " row(s).\n", t->name, t->stats_rows);
+        }
+    }
+}
+
+/* ============================================================
+   PREPARED STATEMENTS (parsed once, see statement.c)
+   ============================================================ */
+
+/* Appends one INSERT value; 0 on out of memory. */
+static int add_stmt_value(Statement* st, int* cap, int param, const char* text, size_t len) {
+    if (st->num_values == *cap) {
+        *cap = *cap ? *cap * 2 : 8;
+        StmtValue* tmp = realloc(st->values, sizeof(StmtValue) * (size_t)*cap);
+        if (!tmp) return 0;
+        st->values = tmp;
+    }
+    StmtValue* v = &st->values[st->num_values];
+    v->param = param;
+    v->literal = NULL;
+    if (!param) {
+        v->literal = malloc(len + 1);
+        if (!v->literal) return 0;
+        memcpy(v->literal, text, len);
+        v->literal[len] = '\0';
+    }
+    st->num_values++;
+    return 1;
+}
+
+/* INSERT INTO t VALUES (v, ?, ...); p starts after INTO. */
+static int parse_prepared_insert(char* p, Statement* st) {
+    if (!parse_identifier(&p, st->table, sizeof(st->table)) || !match_keyword(&p, "VALUES")) {
+        printf("Syntax error: expected INSERT INTO <table> VALUES (...).\n");
+        return 0;
+    }
+    while (isspace((unsigned char)*p)) p++;
+    char* close = *p == '(' ? find_group_end(p) : NULL;
+    if (!close || !at_statement_end(close + 1)) {
+        printf("Syntax error: a prepared INSERT takes one VALUES (...) row.\n");
+        return 0;
+    }
+    *close = '\0';
+
+    int cap = 0;
+    for (char* q = p + 1;;) {
+        while (isspace((unsigned char)*q)) q++;
+        int ok;
+        if (*q == '?') {
+            ok = add_stmt_value(st, &cap, ++st->num_params, NULL, 0);
+            q++;
+        } else if (*q == '"') {
+            char* start = ++q;
+            while (*q && *q != '"') q++;
+            ok = add_stmt_value(st, &cap, 0, start, (size_t)(q - start));
+            if (*q == '"') q++;
+        } else {
+            char* start = q;
+            while (*q && *q != ',') q++;
+            char* end = q;
+            while (end > start && isspace((unsigned char)end[-1])) end--;
+            if (end == start) {
+                printf("Syntax error: empty value in VALUES.\n");
+                return 0;
+            }
+            ok = add_stmt_value(st, &cap, 0, start, (size_t)(end - start));
+        }
+        if (!ok) {
+            fprintf(stderr, "Out of memory preparing statement.\n");
+            return 0;
+        }
+        while (isspace((unsigned char)*q)) q++;
+        if (*q == '\0') return 1;
+        if (*q++ != ',') {
+            printf("Syntax error in VALUES.\n");
+            return 0;
+        }
+    }
+}
+
+/* SELECT cols FROM t [WHERE ...] [LIMIT n [OFFSET m]]; p starts after SELECT. */
+static int parse_prepared_select(char* p, Statement* st) {
+    char* from_kw = strstr(p, "FROM");
+    if (!from_kw) {
+        printf("Syntax error: missing FROM.\n");
+        return 0;
+    }
+    *from_kw = '\0';
+    char* cols_str = trim(p);
+    char* rest = from_kw + strlen("FROM");
+    if (*cols_str == '\0' || !parse_identifier(&rest, st->table, sizeof(st->table))) {
+        printf("Syntax error: expected SELECT <columns> FROM <table>.\n");
+        return 0;
+    }
+    if (strchr(cols_str, '(') || strstr(rest, "JOIN") || strstr(rest, "ORDER BY") || strstr(rest, "GROUP BY")) {
+        printf("Error: a prepared SELECT takes columns, WHERE and LIMIT only.\n");
+        return 0;
+    }
+    int limit_q[2] = { 0, 0 };
+    if (!parse_limit(rest, &st->limit, limit_q)) {
+        printf("Syntax error in LIMIT.\n");
+        return 0;
+    }
+    if (match_keyword(&rest, "WHERE")) {
+        st->where = parse_where_params(rest, &st->num_params);
+        if (!st->where) {
+            printf("Syntax error in WHERE clause.\n");
+            return 0;
+        }
+    } else if (!at_statement_end(rest)) {
+        printf("Syntax error after SELECT ... FROM %s.\n", st->table);
+        return 0;
+    }
+    // LIMIT and OFFSET placeholders come after the WHERE's, left to right
+    if (limit_q[0]) st->limit_param = ++st->num_params;
+    if (limit_q[1]) st->offset_param = ++st->num_params;
+
+    if (strcmp(cols_str, "*") == 0) return 1;
+    int cap = 0;
+    for (char* tok = strtok(cols_str, ","); tok; tok = strtok(NULL, ",")) {
+        char* c = trim(tok);
+        if (*c == '\0') continue;
+        if (st->num_cols == cap) {
+            cap = cap ? cap * 2 : 8;
+            char** tmp = realloc(st->col_names, sizeof(char*) * (size_t)cap);
+            if (!tmp) return 0;
+            st->col_names = tmp;
+        }
+        st->col_names[st->num_cols] = str_duplicate(c);
+        if (!st->col_names[st->num_cols]) return 0;
+        st->num_cols++;
+    }
+    return 1;
+}
+
+int parse_prepared(char* sql, Statement* st) {
+    char* p = trim(sql);
+    if (match_keyword(&p, "INSERT") && match_keyword(&p, "INTO")) {
+        st->kind = STMT_INSERT;
+        return parse_prepared_insert(p, st);
+    }
+    p = trim(sql);
+    if (match_keyword(&p, "SELECT")) {
+        st->kind = STMT_SELECT;
+        return parse_prepared_select(p, st);
+    }
+    printf("Error: only INSERT and SELECT can be prepared.\n");
+    return 0;
+}
@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   BATCH PIPELINE — scan -> filter -> project -> sink
+   ============================================================
+   Every SELECT runs through here. The scan hands out up to BATCH_ROWS live
+   row ids at a time as a selection vector; the filter compacts that vector
+   with a SIMD kernel (bitmask, then selection vector) or a typed loop, and
+   a compound WHERE program, if any, refines it; projection exposes the wanted
+   columns (column-major vectors are read in place, row-major cells are
+   gathered from Row*); the sink consumes the batch. An AND-only WHERE runs
+   one predicate at a time over the shrinking selection vector, through the
+   same kernels, so no column is read for a row an earlier predicate
+   rejected, and nothing is materialized before every predicate has run. A table scan walks row
+   slots in BATCH_ROWS steps, so each batch sits inside one zone map block.
+
+   Table scans of at least two morsels run on the worker pool: each morsel
+   is scanned and filtered on a worker, and the caller hands the matches to
+   the sink morsel by morsel, in row order. A sink that can fork gets a
+   private copy per morsel instead, fed on the worker and joined back in
+   morsel order (parallel aggregation).
+
+   OFFSET and LIMIT trim filtered batches before projection, and the scan
+   ends as soon as LIMIT rows have reached the sink. A limited scan stays
+   serial so it reads no further than it must; an unfiltered OFFSET is a
+   jump straight to its first row when no tombstone is in the way.
+
+   The serial pipeline also runs in pull form: pipeline_next returns one
+   projected batch per call and keeps its place in between, so a cursor
+   reads any result in the memory of a single batch. pipeline_run drives
+   the same loop into a sink. */
+
+//Which bitmask kernel evaluates the filter, if any
+enum { KERNEL_NONE, KERNEL_I64, KERNEL_F64, KERNEL_U32 };
+
+//The scan's range filter: a resolved predicate plus the kernel that runs it
+typedef struct {
+    int active;               // 0 = no filter, or one every live row passes
+    int kernel;               // KERNEL_* for numeric and dictionary-equality filters
+    Predicate p;
+    int64_t ints[BATCH_ROWS]; // gather buffers for kernels over a selection
+    double floats[BATCH_ROWS];
+    uint32_t codes[BATCH_ROWS];
+} Filter;
+
+/* Loads p into f and picks the kernel that evaluates it. */
+static void load_filter(Filter* f, const Predicate* p) {
+    f->p = *p;
+    f->active = !p->all;
+    f->kernel = KERNEL_NONE;
+    switch (p->type) {
+        case COL_INT:   f->kernel = KERNEL_I64; break;
+        case COL_FLOAT: f->kernel = KERNEL_F64; break;
+        default:
+            if (p->dict_code >= 0) f->kernel = KERNEL_U32;
+            break;
+    }
+}
+
+static int prepare_filter(const Table* t, const ScanSpec* spec, Filter* f) {
+    f->active = 0;
+    f->kernel = KERNEL_NONE;
+    memset(&f->p, 0, sizeof(Predicate));
+    if (spec->filter_col < 0) return 1;
+    Predicate p;
+    if (!predicate_prepare(t, spec->filter_col, &spec->filter, &p)) return 0;
+    load_filter(f, &p);
+    return 1;
+}
+
+/* Fills b with the next live row ids from slots before limit. Returns 0
+   once the source is done.
+   Column-major kernel filters read the slot range directly, so for them
+   the selection vector is left to apply_filter. */
+static int scan_next(const Table* t, const ScanSpec* spec, const Filter* f, int* pos, int limit, Batch* b) {
+    b->count = 0;
+    b->start = 0;
+    b->span = 0;
+    if (spec->rows) {
+        if (*pos >= spec->num_rows) return 0;
+        int n = spec->num_rows - *pos;
+        if (n > BATCH_ROWS) n = BATCH_ROWS;
+        memcpy(b->sel, spec->rows + *pos, sizeof(int) * (size_t)n);
+        b->count = n;
+        *pos += n;
+        return 1;
+    }
+
+    int kernel_scan = f->active && !f->p.empty && f->kernel != KERNEL_NONE && t->column_major;
+    while (*pos < limit) {
+        int start = *pos;
+        int end = start + BATCH_ROWS;
+        if (end > limit) end = limit;
+        *pos = end;
+
+        // Column-major numeric filters skip whole blocks ruled out by the zone map
+        if (f->active && t->column_major && f->p.type != COL_TEXT &&
+            !zone_may_match(&t->column_data[f->p.col], start / ZONE_ROWS, &f->p.range)) {
+            continue;
+        }
+        b->start = start;
+        b->span = end - start;
+        if (kernel_scan) return 1;
+
+        int n = 0;
+        if (t->num_deleted == 0) {
+            for (int r = start; r < end; r++) b->sel[n++] = r;
+        } else {
+            for (int r = start; r < end; r++) {
+                if (!table_row_deleted(t, r)) b->sel[n++] = r;
+            }
+        }
+        if (n == 0) continue;
+        b->count = n;
+        return 1;
+    }
+    return 0;
+}
+
+static void run_kernel(const Filter* f, const void* v, int n, uint64_t* mask) {
+    const Predicate* p = &f->p;
+    switch (f->kernel) {
+        case KERNEL_I64: filter_range_i64(v, n, p->ilo, p->ihi, p->invert, mask); break;
+        case KERNEL_F64: filter_range_f64(v, n, p->flo, p->fhi, p->invert, mask); break;
+        default:         filter_eq_u32(v, n, (uint32_t)p->dict_code, p->invert, mask); break;
+    }
+}
+
+/* Kernel path: one bitmask per batch, then the set bits become the
+   selection vector. A column-major table scan runs the kernel straight over
+   the slot range and masks out tombstones word by word; otherwise the
+   selected values are gathered into a dense vector first. */
+static void kernel_filter(const Table* t, Filter* f, Batch* b) {
+    uint64_t mask[BATCH_ROWS / 64];
+    const ColumnStorage* col = t->column_major ? &t->column_data[f->p.col] : NULL;
+
+    if (col && b->span > 0) {
+        const void* v = f->kernel == KERNEL_I64 ? (const void*)(col->ints + b->start)
+                      : f->kernel == KERNEL_F64 ? (const void*)(col->floats + b->start)
+                      : (const void*)(col->codes + b->start);
+        run_kernel(f, v, b->span, mask);
+        if (t->num_deleted > 0) {
+            // Batches start on a 64-row boundary, so bitmap words line up
+            for (int w = 0; w * 64 < b->span; w++) {
+                int dw = (b->start >> 6) + w;
+                if (dw < t->deleted_words) mask[w] &= ~t->deleted[dw];
+            }
+        }
+        b->count = mask_to_selection(mask, b->span, NULL, b->start, b->sel);
+        return;
+    }
+
+    int n = b->count;
+    const int* sel = b->sel;
+    const void* v;
+    switch (f->kernel) {
+        case KERNEL_I64:
+            if (col) {
+                for (int k = 0; k < n; k++) f->ints[k] = col->ints[sel[k]];
+            } else {
+                for (int k = 0; k < n; k++) parse_int_value(t->rows[sel[k]].values[f->p.col], &f->ints[k]);
+            }
+            v = f->ints;
+            break;
+        case KERNEL_F64:
+            if (col) {
+                for (int k = 0; k < n; k++) f->floats[k] = col->floats[sel[k]];
+            } else {
+                for (int k = 0; k < n; k++) parse_float_value(t->rows[sel[k]].values[f->p.col], &f->floats[k]);
+            }
+            v = f->floats;
+            break;
+        default:
+            for (int k = 0; k < n; k++) f->codes[k] = col->codes[sel[k]];
+            v = f->codes;
+            break;
+    }
+    run_kernel(f, v, n, mask);
+    // In place is safe: entry k is read before any write past position k
+    b->count = mask_to_selection(mask, n, b->sel, 0, b->sel);
+}
+
+/* Compacts b->sel to the rows passing f. Numeric and dictionary-equality
+   filters go through the SIMD kernels; TEXT comparisons use a typed loop
+   that stores unconditionally and advances by the test result. */
+static void apply_filter(const Table* t, Filter* f, Batch* b) {
+    if (!f->active) return;
+    if (f->p.empty) {
+        b->count = 0;
+        return;
+    }
+    if (f->kernel != KERNEL_NONE) {
+        kernel_filter(t, f, b);
+        return;
+    }
+
+    int* sel = b->sel;
+    int n = b->count;
+    int w = 0;
+    for (int k = 0; k < n; k++) {
+        int r = sel[k];
+        sel[w] = r;
+        w += predicate_test_row(t, &f->p, r);
+    }
+    b->count = w;
+}
+
+/* Applies the WHERE program to b. A conjunction refines b->sel with one
+   predicate after another, in the planned order, in scratch (their dictionary verdicts are only
+   borrowed); anything with OR or NOT is interpreted row by row. */
+static void filter_where(const Table* t, const WhereProgram* prog, Filter* scratch, Batch* b) {
+    if (!prog || b->count == 0) return;
+    if (!prog->conjunctive) {
+        where_filter_batch(t, prog, b);
+        return;
+    }
+    // The selection no longer covers the batch's whole slot range
+    b->span = 0;
+    for (int i = prog->driven; i < prog->num_preds && b->count > 0; i++) {
+        load_filter(scratch, &prog->preds[prog->order[i]]);
+        apply_filter(t, scratch, b);
+    }
+}
+
+/* Points each view at its column for this batch. */
+static void project(const Table* t, const ScanSpec* spec, const Batch* b, VectorView* views) {
+    for (int i = 0; i < spec->num_cols; i++) {
+        int c = spec->cols[i];
+        if (t->column_major) {
+            views[i].col = &t->column_data[c];
+            continue;
+        }
+        char** cells = views[i].cells;
+        for (int k = 0; k < b->count; k++) cells[k] = t->rows[b->sel[k]].values[c];
+    }
+}
+
+const char* vector_cell_text(const VectorView* v, const Batch* b, int k, char* buf, size_t buf_sz) {
+    if (v->col) return column_cell_text(v->col, b->sel[k], buf, buf_sz);
+    return v->cells[k] ? v->cells[k] : "NULL";
+}
+
+/* Drops the matches OFFSET still skips from the front of b, then cuts b
+   to what LIMIT has left (left -1 = no LIMIT). */
+static void limit_batch(Batch* b, int64_t* skip, int64_t* left) {
+    if (*skip > 0) {
+        int drop = *skip < b->count ? (int)*skip : b->count;
+        memmove(b->sel, b->sel + drop, sizeof(int) * (size_t)(b->count - drop));
+        b->count -= drop;
+        *skip -= drop;
+    }
+    if (*left >= 0) {
+        if (b->count > *left) b->count = (int)*left;
+        *left -= b->count;
+    }
+}
+
+/* ===== Parallel table scans ===== */
+
+typedef struct {
+    MorselJob job;            // first, so the job pointer is the scan
+    const Table* t;
+    const ScanSpec* spec;
+    const Filter* proto;      // prepared once; workers copy its header
+    int refine;               // the WHERE program needs a scratch filter per worker
+    BatchSink* sink;
+    BatchSink** parts;        // forked sinks, per morsel
+    int** matches;            // row ids per morsel for row-order sinks
+    int* counts;
+    Batch* out;
+    VectorView* views;
+    atomic_int stop;          // the sink asked to stop, or a morsel failed
+    atomic_int failed;        // a worker ran out of memory; the result is incomplete
+} MorselScan;
+
+static void scan_morsel(MorselJob* job, int m) {
+    MorselScan* ms = (MorselScan*)job;
+    if (atomic_load(&ms->stop)) return;
+    const Table* t = ms->t;
+    BatchSink* part = ms->sink->fork ? ms->sink->fork(ms->sink) : NULL;
+    Filter* f = malloc(sizeof(Filter));
+    Filter* scratch = ms->refine ? malloc(sizeof(Filter)) : NULL;
+    Batch* b = malloc(sizeof(Batch));
+    int* rows = part ? NULL : malloc(sizeof(int) * MORSEL_ROWS);
+    if (!f || !b || (ms->refine && !scratch) || (ms->sink->fork ? !part : !rows)) {
+        atomic_store(&ms->failed, 1);
+        atomic_store(&ms->stop, 1);
+        if (part) ms->sink->join(ms->sink, part);
+        free(f);
+        free(scratch);
+        free(b);
+        free(rows);
+        return;
+    }
+    // The predicate and any dictionary verdicts are shared read-only
+    f->active = ms->proto->active;
+    f->kernel = ms->proto->kernel;
+    f->p = ms->proto->p;
+
+    int n = 0;
+    int pos = m * MORSEL_ROWS;
+    int limit = pos + MORSEL_ROWS < t->num_rows ? pos + MORSEL_ROWS : t->num_rows;
+    while (scan_next(t, ms->spec, f, &pos, limit, b)) {
+        apply_filter(t, f, b);
+        filter_where(t, ms->spec->where, scratch, b);
+        if (b->count == 0) continue;
+        if (part) {
+            part->consume(part, t, b, NULL, 0);
+        } else {
+            memcpy(rows + n, b->sel, sizeof(int) * (size_t)b->count);
+            n += b->count;
+        }
+    }
+    ms->parts[m] = part;
+    ms->matches[m] = rows;
+    ms->counts[m] = n;
+    free(f);
+    free(scratch);
+    free(b);
+}
+
+static int merge_morsel(MorselJob* job, int m) {
+    MorselScan* ms = (MorselScan*)job;
+    if (ms->parts[m]) {
+        if (!ms->sink->join(ms->sink, ms->parts[m])) atomic_store(&ms->stop, 1);
+        ms->parts[m] = NULL;
+    }
+    const int* rows = ms->matches[m];
+    for (int done = 0; rows && done < ms->counts[m] && !atomic_load(&ms->stop);) {
+        Batch* b = ms->out;
+        b->count = ms->counts[m] - done < BATCH_ROWS ? ms->counts[m] - done : BATCH_ROWS;
+        b->start = 0;
+        b->span = 0;
+        memcpy(b->sel, rows + done, sizeof(int) * (size_t)b->count);
+        done += b->count;
+        project(ms->t, ms->spec, b, ms->views);
+        if (!ms->sink->consume(ms->sink, ms->t, b, ms->views, ms->spec->num_cols)) atomic_store(&ms->stop, 1);
+    }
+    free(ms->matches[m]);
+    ms->matches[m] = NULL;
+    return 1;
+}
+
+static int run_morsels(const Table* t, const ScanSpec* spec, const Filter* f, Batch* b,
+                       VectorView* views, BatchSink* sink) {
+    int num_morsels = (t->num_rows + MORSEL_ROWS - 1) / MORSEL_ROWS;
+    MorselScan ms;
+    memset(&ms, 0, sizeof(MorselScan));
+    ms.job.run = scan_morsel;
+    ms.job.merge = merge_morsel;
+    ms.t = t;
+    ms.spec = spec;
+    ms.proto = f;
+    ms.refine = spec->where && spec->where->conjunctive;
+    ms.sink = sink;
+    ms.out = b;
+    ms.views = views;
+    atomic_init(&ms.stop, 0);
+    atomic_init(&ms.failed, 0);
+    ms.parts = calloc((size_t)num_morsels, sizeof(BatchSink*));
+    ms.matches = calloc((size_t)num_morsels, sizeof(int*));
+    ms.counts = calloc((size_t)num_morsels, sizeof(int));
+    int ok = ms.parts && ms.matches && ms.counts;
+    if (ok) {
+        parallel_run(&ms.job, num_morsels);
+        ok = !atomic_load(&ms.failed);
+    }
+    free(ms.parts);
+    free(ms.matches);
+    free(ms.counts);
+    return ok;
+}
+
+/* ===== Pull form ===== */
+
+//The serial pipeline between calls: one batch, its filters and views
+struct Pipeline {
+    const Table* t;
+    const ScanSpec* spec;
+    Filter* f;
+    Filter* scratch;
+    Batch* b;
+    VectorView* views;
+    char** cells;             // row-major: the gathered cells behind views
+    int pos;                  // next row slot, or index into spec->rows
+    int64_t skip;             // OFFSET matches still to drop
+    int64_t left;             // LIMIT matches still to return, -1 = no LIMIT
+};
+
+void pipeline_close(Pipeline* p) {
+    if (!p) return;
+    if (p->f) predicate_free(&p->f->p);
+    free(p->f);
+    free(p->scratch);
+    free(p->b);
+    free(p->views);
+    free(p->cells);
+    free(p);
+}
+
+Pipeline* pipeline_open(const Table* t, const ScanSpec* spec) {
+    Pipeline* p = calloc(1, sizeof(Pipeline));
+    if (!p) return NULL;
+    p->t = t;
+    p->spec = spec;
+    p->f = malloc(sizeof(Filter));
+    p->scratch = spec->where && spec->where->conjunctive ? malloc(sizeof(Filter)) : NULL;
+    p->b = malloc(sizeof(Batch));
+    p->views = calloc((size_t)(spec->num_cols > 0 ? spec->num_cols : 1), sizeof(VectorView));
+    if (p->f) memset(&p->f->p, 0, sizeof(Predicate));
+    int ok = p->f && p->b && p->views && (p->scratch || !spec->where || !spec->where->conjunctive);
+    if (ok && !t->column_major && spec->num_cols > 0) {
+        p->cells = malloc(sizeof(char*) * BATCH_ROWS * (size_t)spec->num_cols);
+        ok = p->cells != NULL;
+        for (int i = 0; ok && i < spec->num_cols; i++) p->views[i].cells = p->cells + (size_t)i * BATCH_ROWS;
+    }
+    if (!ok || !prepare_filter(t, spec, p->f)) {
+        pipeline_close(p);
+        return NULL;
+    }
+
+    p->skip = spec->offset;
+    p->left = spec->limit;
+    if (!p->f->active && !spec->where && (spec->rows || t->num_deleted == 0)) {
+        // Every row or listed row matches, so OFFSET is a position
+        int end = spec->rows ? spec->num_rows : t->num_rows;
+        p->pos = p->skip < end ? (int)p->skip : end;
+        p->skip = 0;
+    }
+    return p;
+}
+
+const Batch* pipeline_next(Pipeline* p, const VectorView** views) {
+    const Table* t = p->t;
+    const ScanSpec* spec = p->spec;
+    Batch* b = p->b;
+    while (p->left != 0 && scan_next(t, spec, p->f, &p->pos, t->num_rows, b)) {
+        apply_filter(t, p->f, b);
+        filter_where(t, spec->where, p->scratch, b);
+        limit_batch(b, &p->skip, &p->left);
+        if (b->count == 0) continue;
+        project(t, spec, b, p->views);
+        if (views) *views = p->views;
+        return b;
+    }
+    return NULL;
+}
+
+int pipeline_run(const Table* t, const ScanSpec* spec, BatchSink* sink) {
+    Pipeline* p = pipeline_open(t, spec);
+    if (!p) return 0;
+    int ok = 1;
+    if (!spec->rows && p->left < 0 && spec->offset == 0 && t->num_rows >= 2 * MORSEL_ROWS) {
+        ok = run_morsels(t, spec, p->f, p->b, p->views, sink);
+        p->pos = t->num_rows;
+    }
+    const Batch* b;
+    const VectorView* views;
+    while (ok && (b = pipeline_next(p, &views))) {
+        if (!sink->consume(sink, t, b, views, spec->num_cols)) break;
+    }
+    pipeline_close(p);
+    return ok;
+}
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MQ_X86 1
+#include <immintrin.h>
+#endif
+
+/* ============================================================
+   SIMD FILTER KERNELS — comparison -> bitmask -> selection vector
+   ============================================================
+   Every comparison is an inclusive range test, lo <= v <= hi, with an
+   invert flag for <>: = is [v, v], < is [MIN, v - 1] and so on (the
+   pipeline resolves the bounds). Kernels write one bit per element, 64 per
+   word, and mask_to_selection turns the set bits into row ids. The level is
+   picked once from CPUID; SSE2 has no 64-bit integer compare, so INT columns
+   use the scalar loop below AVX2. */
+
+static void range_i64_scalar(const int64_t* v, int n, int64_t lo, int64_t hi, int invert, uint64_t* mask) {
+    for (int w = 0; w * 64 < n; w++) {
+        uint64_t m = 0;
+        int end = n - w * 64 < 64 ? n - w * 64 : 64;
+        const int64_t* p = v + w * 64;
+        for (int j = 0; j < end; j++) m |= (uint64_t)((p[j] >= lo && p[j] <= hi) ^ invert) << j;
+        mask[w] = m;
+    }
+}
+
+static void range_f64_scalar(const double* v, int n, double lo, double hi, int invert, uint64_t* mask) {
+    for (int w = 0; w * 64 < n; w++) {
+        uint64_t m = 0;
+        int end = n - w * 64 < 64 ? n - w * 64 : 64;
+        const double* p = v + w * 64;
+        for (int j = 0; j < end; j++) m |= (uint64_t)((p[j] >= lo && p[j] <= hi) ^ invert) << j;
+        mask[w] = m;
+    }
+}
+
+static void eq_u32_scalar(const uint32_t* v, int n, uint32_t key, int invert, uint64_t* mask) {
+    for (int w = 0; w * 64 < n; w++) {
+        uint64_t m = 0;
+        int end = n - w * 64 < 64 ? n - w * 64 : 64;
+        const uint32_t* p = v + w * 64;
+        for (int j = 0; j < end; j++) m |= (uint64_t)((p[j] == key) ^ invert) << j;
+        mask[w] = m;
+    }
+}
+
+#ifdef MQ_X86
+
+/* Vector bodies cover whole groups of 2, 4 or 8, which never straddle a
+   mask word, so fewer than 64 elements remain after the loop; the scalar
+   kernel recomputes that last word and its bits from i on are kept. */
+#define FINISH_TAIL(i, n, mask, kernel, v, ...)                       \
+    do {                                                              \
+        if ((i) < (n)) {                                              \
+            uint64_t tail;                                            \
+            int from = (i) & ~63;                                     \
+            kernel((v) + from, (n) - from, __VA_ARGS__, &tail);       \
+            uint64_t keep = ((uint64_t)1 << ((i) - from)) - 1;        \
+            mask[from >> 6] = (mask[from >> 6] & keep) | (tail & ~keep); \
+        }                                                             \
+    } while (0)
+
+__attribute__((target("sse2")))
+static void range_f64_sse2(const double* v, int n, double lo, double hi, int invert, uint64_t* mask) {
+    memset(mask, 0, sizeof(uint64_t) * (size_t)((n + 63) / 64));
+    const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+    const int flip = invert ? 0x3 : 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(v + i);
+        __m128d in = _mm_and_pd(_mm_cmpge_pd(x, vlo), _mm_cmple_pd(x, vhi));
+        mask[i >> 6] |= (uint64_t)(_mm_movemask_pd(in) ^ flip) << (i & 63);
+    }
+    FINISH_TAIL(i, n, mask, range_f64_scalar, v, lo, hi, invert);
+}
+
+__attribute__((target("sse2")))
+static void eq_u32_sse2(const uint32_t* v, int n, uint32_t key, int invert, uint64_t* mask) {
+    memset(mask, 0, sizeof(uint64_t) * (size_t)((n + 63) / 64));
+    const __m128i vkey = _mm_set1_epi32((int)key);
+    const int flip = invert ? 0xF : 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+        int bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, vkey)));
+        mask[i >> 6] |= (uint64_t)(bits ^ flip) << (i & 63);
+    }
+    FINISH_TAIL(i, n, mask, eq_u32_scalar, v, key, invert);
+}
+
+__attribute__((target("avx2")))
+static void range_i64_avx2(const int64_t* v, int n, int64_t lo, int64_t hi, int invert, uint64_t* mask) {
+    memset(mask, 0, sizeof(uint64_t) * (size_t)((n + 63) / 64));
+    const __m256i vlo = _mm256_set1_epi64x(lo), vhi = _mm256_set1_epi64x(hi);
+    const int flip = invert ? 0 : 0xF;  // the compares find rows outside the range
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(vlo, x), _mm256_cmpgt_epi64(x, vhi));
+        int bits = _mm256_movemask_pd(_mm256_castsi256_pd(out));
+        mask[i >> 6] |= (uint64_t)(bits ^ flip) << (i & 63);
+    }
+    FINISH_TAIL(i, n, mask, range_i64_scalar, v, lo, hi, invert);
+}
+
+__attribute__((target("avx2")))
+static void range_f64_avx2(const double* v, int n, double lo, double hi, int invert, uint64_t* mask) {
+    memset(mask, 0, sizeof(uint64_t) * (size_t)((n + 63) / 64));
+    const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    const int flip = invert ? 0xF : 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(v + i);
+        __m256d in = _mm256_and_pd(_mm256_cmp_pd(x, vlo, _CMP_GE_OQ), _mm256_cmp_pd(x, vhi, _CMP_LE_OQ));
+        mask[i >> 6] |= (uint64_t)(_mm256_movemask_pd(in) ^ flip) << (i & 63);
+    }
+    FINISH_TAIL(i, n, mask, range_f64_scalar, v, lo, hi, invert);
+}
+
+__attribute__((target("avx2")))
+static void eq_u32_avx2(const uint32_t* v, int n, uint32_t key, int invert, uint64_t* mask) {
+    memset(mask, 0, sizeof(uint64_t) * (size_t)((n + 63) / 64));
+    const __m256i vkey = _mm256_set1_epi32((int)key);
+    const int flip = invert ? 0xFF : 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + i));
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, vkey)));
+        mask[i >> 6] |= (uint64_t)(bits ^ flip) << (i & 63);
+    }
+    FINISH_TAIL(i, n, mask, eq_u32_scalar, v, key, invert);
+}
+
+#endif
+
+/* ===== Dispatch ===== */
+
+static void (*range_i64_fn)(const int64_t*, int, int64_t, int64_t, int, uint64_t*) = range_i64_scalar;
+static void (*range_f64_fn)(const double*, int, double, double, int, uint64_t*) = range_f64_scalar;
+static void (*eq_u32_fn)(const uint32_t*, int, uint32_t, int, uint64_t*) = eq_u32_scalar;
+static SimdLevel active_level = SIMD_SCALAR;
+static int level_chosen = 0;
+
+SimdLevel simd_detect(void) {
+#ifdef MQ_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+SimdLevel simd_set_level(SimdLevel level) {
+    SimdLevel best = simd_detect();
+    if (level > best) level = best;
+    range_i64_fn = range_i64_scalar;
+    range_f64_fn = range_f64_scalar;
+    eq_u32_fn = eq_u32_scalar;
+#ifdef MQ_X86
+    if (level >= SIMD_SSE2) {
+        range_f64_fn = range_f64_sse2;
+        eq_u32_fn = eq_u32_sse2;
+    }
+    if (level >= SIMD_AVX2) {
+        range_i64_fn = range_i64_avx2;
+        range_f64_fn = range_f64_avx2;
+        eq_u32_fn = eq_u32_avx2;
+    }
+#endif
+    active_level = level;
+    level_chosen = 1;
+    return level;
+}
+
+SimdLevel simd_level(void) {
+    if (!level_chosen) simd_set_level(SIMD_AVX2);
+    return active_level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+void filter_range_i64(const int64_t* v, int n, int64_t lo, int64_t hi, int invert, uint64_t* mask) {
+    if (!level_chosen) simd_level();
+    range_i64_fn(v, n, lo, hi, invert, mask);
+}
+
+void filter_range_f64(const double* v, int n, double lo, double hi, int invert, uint64_t* mask) {
+    if (!level_chosen) simd_level();
+    range_f64_fn(v, n, lo, hi, invert, mask);
+}
+
+void filter_eq_u32(const uint32_t* v, int n, uint32_t key, int invert, uint64_t* mask) {
+    if (!level_chosen) simd_level();
+    eq_u32_fn(v, n, key, invert, mask);
+}
+
+int mask_to_selection(const uint64_t* mask, int n, const int* ids, int base, int* sel) {
+    int count = 0;
+    for (int w = 0; w * 64 < n; w++) {
+        uint64_t m = mask[w];
+        while (m) {
+#ifdef __GNUC__
+            int bit = __builtin_ctzll(m);
+#else
+            int bit = 0;
+            while (!((m >> bit) & 1)) bit++;
+#endif
+            int k = w * 64 + bit;
+            sel[count++] = ids ? ids[k] : base + k;
+            m &= m - 1;
+        }
+    }
+    return count;
+}
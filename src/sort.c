@@ -0,0 +1,521 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   ORDER BY — top-N heap and external merge sort
+   ============================================================
+   Matching rows arrive from the batch pipeline and become (key, row)
+   entries, the key read once in the column's own type: INT and FLOAT
+   compare numerically, TEXT with strcmp (NULL first). Equal keys fall back
+   to the row id, so the order is total and repeatable.
+
+   With a LIMIT, a max-heap of OFFSET + LIMIT entries keeps the best rows
+   seen so far: O(n log k) time, O(k) memory. OFFSET rows are dropped on
+   the way out. Without one, entries fill a buffer sized
+   by the sort budget; each full buffer is sorted and spilled as a run to a
+   temporary file, and the runs are k-way merged (SORT_FANIN at a time)
+   into the output. TEXT keys are arena pointers, which stay valid because
+   the table cannot change while the statement runs.
+
+   When the key column has a B+tree, pipeline_run_indexed skips the sort:
+   it walks the tree in key order, filters each chunk of rows through the
+   WHERE and stops as soon as OFFSET + LIMIT rows have matched. */
+
+#define SORT_DEFAULT_BUDGET (64u << 20)
+#define SORT_MIN_ENTRIES 64
+#define SORT_FANIN 64         // runs merged at once
+#define RUN_BUFFER 512        // entries read ahead per run
+
+typedef struct {
+    union {
+        int64_t i;
+        double f;
+        const char* s;
+    } k;
+    int row;
+} SortEntry;
+
+typedef struct {
+    int col;
+    ColumnType type;
+    int desc;
+} SortKey;
+
+static size_t budget_bytes = SORT_DEFAULT_BUDGET;
+
+void sort_set_budget(size_t bytes) {
+    budget_bytes = bytes;
+}
+
+size_t sort_budget(void) {
+    return budget_bytes;
+}
+
+static int entry_cmp(const SortKey* key, const SortEntry* a, const SortEntry* b) {
+    int c;
+    switch (key->type) {
+        case COL_INT:   c = (a->k.i > b->k.i) - (a->k.i < b->k.i); break;
+        case COL_FLOAT: c = (a->k.f > b->k.f) - (a->k.f < b->k.f); break;
+        default:
+            if (!a->k.s || !b->k.s) c = (a->k.s != NULL) - (b->k.s != NULL);
+            else c = strcmp(a->k.s, b->k.s);
+            break;
+    }
+    if (key->desc) c = -c;
+    if (c == 0) c = (a->row > b->row) - (a->row < b->row);
+    return c;
+}
+
+/* ===== Heap ===== */
+
+/* Max-heap under entry_cmp: the root is the entry that sorts last. */
+static void sift_down(const SortKey* key, SortEntry* h, int n, int i) {
+    for (;;) {
+        int big = i;
+        int l = 2 * i + 1;
+        int r = l + 1;
+        if (l < n && entry_cmp(key, &h[l], &h[big]) > 0) big = l;
+        if (r < n && entry_cmp(key, &h[r], &h[big]) > 0) big = r;
+        if (big == i) return;
+        SortEntry tmp = h[i];
+        h[i] = h[big];
+        h[big] = tmp;
+        i = big;
+    }
+}
+
+static void sift_up(const SortKey* key, SortEntry* h, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (entry_cmp(key, &h[i], &h[parent]) <= 0) return;
+        SortEntry tmp = h[i];
+        h[i] = h[parent];
+        h[parent] = tmp;
+        i = parent;
+    }
+}
+
+/* Sorts a valid heap in place into ascending order. */
+static void heap_drain(const SortKey* key, SortEntry* h, int n) {
+    for (int end = n - 1; end > 0; end--) {
+        SortEntry tmp = h[0];
+        h[0] = h[end];
+        h[end] = tmp;
+        sift_down(key, h, end, 0);
+    }
+}
+
+static void heap_sort(const SortKey* key, SortEntry* v, int n) {
+    for (int i = n / 2 - 1; i >= 0; i--) sift_down(key, v, n, i);
+    heap_drain(key, v, n);
+}
+
+/* ===== Collection ===== */
+
+typedef struct {
+    SortKey key;
+    const Table* t;
+    SortEntry* buf;
+    int count;
+    int cap;
+    int64_t limit;  // top-N heap size, -1 = full sort
+    FILE** runs;
+    int64_t* run_len;
+    int num_runs;
+    int run_cap;
+    int failed;
+} Sorter;
+
+static void read_key(const Table* t, const SortKey* key, int row, SortEntry* e) {
+    Value v;
+    table_cell_value(t, row, key->col, &v);
+    e->row = row;
+    switch (key->type) {
+        case COL_INT:   e->k.i = v.i; break;
+        case COL_FLOAT: e->k.f = v.f; break;
+        default:        e->k.s = v.s; break;
+    }
+}
+
+/* Writes the sorted buffer out as one run. */
+static int spill_run(Sorter* s) {
+    heap_sort(&s->key, s->buf, s->count);
+    if (s->num_runs == s->run_cap) {
+        int cap = s->run_cap ? s->run_cap * 2 : 8;
+        FILE** runs = realloc(s->runs, sizeof(FILE*) * (size_t)cap);
+        if (runs) s->runs = runs;
+        int64_t* lens = realloc(s->run_len, sizeof(int64_t) * (size_t)cap);
+        if (lens) s->run_len = lens;
+        if (!runs || !lens) return 0;
+        s->run_cap = cap;
+    }
+    FILE* f = tmpfile();
+    if (!f) return 0;
+    if (fwrite(s->buf, sizeof(SortEntry), (size_t)s->count, f) != (size_t)s->count) {
+        fclose(f);
+        return 0;
+    }
+    rewind(f);
+    s->runs[s->num_runs] = f;
+    s->run_len[s->num_runs++] = s->count;
+    s->count = 0;
+    return 1;
+}
+
+static void add_entry(Sorter* s, int row) {
+    SortEntry e;
+    read_key(s->t, &s->key, row, &e);
+    if (s->limit >= 0) {
+        if (s->count < s->cap) {
+            s->buf[s->count] = e;
+            sift_up(&s->key, s->buf, s->count++);
+        } else if (s->cap > 0 && entry_cmp(&s->key, &e, &s->buf[0]) < 0) {
+            s->buf[0] = e;
+            sift_down(&s->key, s->buf, s->count, 0);
+        }
+        return;
+    }
+    if (s->count == s->cap && !spill_run(s)) {
+        s->failed = 1;
+        return;
+    }
+    s->buf[s->count++] = e;
+}
+
+static int collect_entries(BatchSink* self, const Table* t, const Batch* b,
+                           const VectorView* cols, int num_cols) {
+    (void)t;
+    (void)cols;
+    (void)num_cols;
+    Sorter* s = self->state;
+    for (int k = 0; k < b->count && !s->failed; k++) add_entry(s, b->sel[k]);
+    return !s->failed;
+}
+
+/* ===== Output ===== */
+
+//Sorted row ids, handed to the sink through the pipeline BATCH_ROWS at a time
+typedef struct {
+    const Table* t;
+    ScanSpec spec;
+    BatchSink* sink;
+    int rows[BATCH_ROWS];
+    int count;
+    int64_t skip;  // OFFSET rows still to drop
+    int64_t left;  // LIMIT rows still to emit, -1 = no LIMIT
+    int stopped;
+    int ok;
+} Emitter;
+
+static int forward_batch(BatchSink* self, const Table* t, const Batch* b,
+                         const VectorView* cols, int num_cols) {
+    Emitter* em = self->state;
+    if (!em->sink->consume(em->sink, t, b, cols, num_cols)) em->stopped = 1;
+    return !em->stopped;
+}
+
+static void emit_flush(Emitter* em) {
+    if (em->count == 0 || em->stopped || !em->ok) return;
+    em->spec.rows = em->rows;
+    em->spec.num_rows = em->count;
+    BatchSink proxy = { forward_batch, em, NULL, NULL };
+    em->ok = pipeline_run(em->t, &em->spec, &proxy);
+    em->count = 0;
+}
+
+static void emit_init(Emitter* em, const Table* t, const ScanSpec* spec, BatchSink* sink) {
+    em->t = t;
+    memset(&em->spec, 0, sizeof(ScanSpec));
+    em->spec.filter_col = -1;
+    em->spec.limit = -1;
+    em->spec.cols = spec->cols;
+    em->spec.num_cols = spec->num_cols;
+    em->sink = sink;
+    em->count = 0;
+    em->skip = spec->offset;
+    em->left = spec->limit;
+    em->stopped = 0;
+    em->ok = 1;
+}
+
+static void emit_row(Emitter* em, int row) {
+    if (em->skip > 0) {
+        em->skip--;
+        return;
+    }
+    if (em->left == 0) {
+        em->stopped = 1;
+        return;
+    }
+    em->rows[em->count++] = row;
+    if (em->left > 0) em->left--;
+    if (em->count == BATCH_ROWS || em->left == 0) emit_flush(em);
+    // The LIMIT is met: stop the merge or drain early
+    if (em->left == 0) em->stopped = 1;
+}
+
+/* ===== Merge ===== */
+
+typedef struct {
+    FILE* f;
+    int64_t remaining;  // entries not yet read from f
+    SortEntry buf[RUN_BUFFER];
+    int pos, len;
+} RunReader;
+
+static int reader_fill(RunReader* r) {
+    size_t want = r->remaining < RUN_BUFFER ? (size_t)r->remaining : RUN_BUFFER;
+    r->pos = 0;
+    r->len = (int)fread(r->buf, sizeof(SortEntry), want, r->f);
+    r->remaining -= r->len;
+    return r->len > 0;
+}
+
+/* Min-heap of readers ordered by their current entry. */
+static void reader_sift(const SortKey* key, RunReader** h, int n, int i) {
+    for (;;) {
+        int low = i;
+        int l = 2 * i + 1;
+        int r = l + 1;
+        if (l < n && entry_cmp(key, &h[l]->buf[h[l]->pos], &h[low]->buf[h[low]->pos]) < 0) low = l;
+        if (r < n && entry_cmp(key, &h[r]->buf[h[r]->pos], &h[low]->buf[h[low]->pos]) < 0) low = r;
+        if (low == i) return;
+        RunReader* tmp = h[i];
+        h[i] = h[low];
+        h[low] = tmp;
+        i = low;
+    }
+}
+
+/* Merges runs[first, first + n) in key order, into out (a new run) or, when
+   out is NULL, into the emitter. Closes the merged runs. */
+static int merge_runs(Sorter* s, int first, int n, FILE* out, Emitter* em) {
+    RunReader* readers = malloc(sizeof(RunReader) * (size_t)n);
+    RunReader** heap = malloc(sizeof(RunReader*) * (size_t)n);
+    int ok = readers && heap;
+    int live = 0;
+    for (int i = 0; ok && i < n; i++) {
+        readers[i].f = s->runs[first + i];
+        readers[i].remaining = s->run_len[first + i];
+        if (reader_fill(&readers[i])) heap[live++] = &readers[i];
+    }
+    for (int i = live / 2 - 1; ok && i >= 0; i--) reader_sift(&s->key, heap, live, i);
+
+    while (ok && live > 0 && !(em && em->stopped)) {
+        RunReader* r = heap[0];
+        const SortEntry* e = &r->buf[r->pos];
+        if (out) ok = fwrite(e, sizeof(SortEntry), 1, out) == 1;
+        else emit_row(em, e->row);
+        if (++r->pos == r->len && !reader_fill(r)) heap[0] = heap[--live];
+        reader_sift(&s->key, heap, live, 0);
+    }
+    for (int i = 0; i < n; i++) fclose(s->runs[first + i]);
+    free(readers);
+    free(heap);
+    return ok;
+}
+
+/* Merges until at most SORT_FANIN runs remain, then streams the final merge. */
+static int merge_all(Sorter* s, Emitter* em) {
+    while (s->num_runs > SORT_FANIN) {
+        FILE* out = tmpfile();
+        if (!out) return 0;
+        int64_t len = 0;
+        for (int i = 0; i < SORT_FANIN; i++) len += s->run_len[i];
+        int merged = merge_runs(s, 0, SORT_FANIN, out, NULL);
+        int left = s->num_runs - SORT_FANIN;
+        memmove(s->runs, s->runs + SORT_FANIN, sizeof(FILE*) * (size_t)left);
+        memmove(s->run_len, s->run_len + SORT_FANIN, sizeof(int64_t) * (size_t)left);
+        s->num_runs = left;
+        if (!merged) {
+            fclose(out);
+            return 0;
+        }
+        // The merged run goes last, so every pass takes the oldest, shortest runs
+        rewind(out);
+        s->runs[left] = out;
+        s->run_len[left] = len;
+        s->num_runs = left + 1;
+    }
+    int n = s->num_runs;
+    s->num_runs = 0;
+    return merge_runs(s, 0, n, NULL, em);
+}
+
+/* ===== Entry point ===== */
+
+int pipeline_run_sorted(const Table* t, const ScanSpec* spec, int key_col, int desc,
+                        BatchSink* sink) {
+    int64_t limit = spec->limit >= 0 ? spec->offset + spec->limit : -1;
+    Sorter s;
+    memset(&s, 0, sizeof(Sorter));
+    s.key.col = key_col;
+    s.key.type = t->columns[key_col].type;
+    s.key.desc = desc;
+    s.t = t;
+    s.limit = limit;
+    if (limit >= 0) {
+        int64_t live = t->num_rows - t->num_deleted;
+        s.cap = (int)(limit < live ? limit : live);
+    } else {
+        size_t cap = budget_bytes / sizeof(SortEntry);
+        s.cap = cap < SORT_MIN_ENTRIES ? SORT_MIN_ENTRIES : cap > INT32_MAX ? INT32_MAX : (int)cap;
+        if (s.cap > t->num_rows && t->num_rows > 0) s.cap = t->num_rows;
+    }
+    s.buf = malloc(sizeof(SortEntry) * (size_t)(s.cap > 0 ? s.cap : 1));
+
+    // Collect keys with no projection; the sorted rows are projected on the way out
+    ScanSpec scan = *spec;
+    scan.cols = NULL;
+    scan.num_cols = 0;
+    scan.offset = 0;
+    scan.limit = -1;
+    BatchSink collect = { collect_entries, &s, NULL, NULL };
+    int ok = s.buf && pipeline_run(t, &scan, &collect) && !s.failed;
+
+    Emitter* em = ok ? malloc(sizeof(Emitter)) : NULL;
+    if (em) emit_init(em, t, spec, sink);
+    ok = ok && em;
+
+    if (ok && s.num_runs == 0) {
+        // Everything fit: the top-N buffer is already a heap, a full buffer is not
+        if (limit >= 0) heap_drain(&s.key, s.buf, s.count);
+        else heap_sort(&s.key, s.buf, s.count);
+        for (int i = 0; i < s.count && !em->stopped; i++) emit_row(em, s.buf[i].row);
+    } else if (ok) {
+        ok = s.count == 0 || spill_run(&s);
+        // The buffer is not needed while merging
+        free(s.buf);
+        s.buf = NULL;
+        ok = ok && merge_all(&s, em);
+    }
+    if (em) {
+        emit_flush(em);
+        ok = ok && em->ok;
+    }
+
+    for (int i = 0; i < s.num_runs; i++) fclose(s.runs[i]);
+    free(s.runs);
+    free(s.run_len);
+    free(s.buf);
+    free(em);
+    return ok;
+}
+
+/* ===== Index order ===== */
+
+//A B+tree walk in ORDER BY order
+typedef struct {
+    const Table* t;
+    const Index* ix;
+    int desc;
+    BTreeCursor cur;
+    int* group;     // DESC: rows of the current key, as walked (highest row first)
+    int group_len;
+    int group_cap;
+    int ready;      // group rows not yet handed out
+    int ahead;      // first row of the following key, -1 = not read yet
+} IndexOrder;
+
+/* Fills out with up to max rows; 0 at the end, -1 on out of memory.
+   The tree orders equal keys by row, so walking it backwards reverses
+   them too: DESC gathers each key's rows and hands them out lowest row
+   first, the order the sort would give. */
+static int order_next(IndexOrder* o, int* out, int max) {
+    if (!o->desc) return index_ordered_rows(o->t, o->ix, 0, &o->cur, max, out);
+    int n = 0;
+    while (n < max) {
+        if (o->ready > 0) {
+            out[n++] = o->group[--o->ready];
+            continue;
+        }
+        int row = o->ahead;
+        if (row < 0 && index_ordered_rows(o->t, o->ix, 1, &o->cur, 1, &row) == 0) break;
+        o->ahead = -1;
+        Value key, v;
+        table_cell_value(o->t, row, o->ix->column, &key);
+        o->group_len = 0;
+        for (;;) {
+            if (o->group_len == o->group_cap) {
+                int cap = o->group_cap ? o->group_cap * 2 : 64;
+                int* tmp = realloc(o->group, sizeof(int) * (size_t)cap);
+                if (!tmp) return -1;
+                o->group = tmp;
+                o->group_cap = cap;
+            }
+            o->group[o->group_len++] = row;
+            if (index_ordered_rows(o->t, o->ix, 1, &o->cur, 1, &row) == 0) break;
+            table_cell_value(o->t, row, o->ix->column, &v);
+            if (value_compare(&v, &key) != 0) {
+                o->ahead = row;
+                break;
+            }
+        }
+        o->ready = o->group_len;
+    }
+    return n;
+}
+
+//Rows of one chunk that passed the WHERE, in chunk order
+typedef struct {
+    int rows[BATCH_ROWS];
+    int count;
+} Matches;
+
+static int collect_matches(BatchSink* self, const Table* t, const Batch* b,
+                           const VectorView* cols, int num_cols) {
+    (void)t;
+    (void)cols;
+    (void)num_cols;
+    Matches* m = self->state;
+    memcpy(m->rows + m->count, b->sel, sizeof(int) * (size_t)b->count);
+    m->count += b->count;
+    return 1;
+}
+
+int pipeline_run_indexed(const Table* t, const ScanSpec* spec, const Index* ix, int desc,
+                         BatchSink* sink) {
+    IndexOrder o;
+    memset(&o, 0, sizeof(IndexOrder));
+    o.t = t;
+    o.ix = ix;
+    o.desc = desc;
+    o.ahead = -1;
+    Emitter* em = malloc(sizeof(Emitter));
+    Matches* m = malloc(sizeof(Matches));
+    int* chunk = malloc(sizeof(int) * BATCH_ROWS);
+    int ok = em && m && chunk;
+    if (em) emit_init(em, t, spec, sink);
+
+    // Each chunk runs through the filters as a row list, which keeps its order
+    ScanSpec scan = *spec;
+    scan.cols = NULL;
+    scan.num_cols = 0;
+    scan.offset = 0;
+    scan.limit = -1;
+    BatchSink collect = { collect_matches, m, NULL, NULL };
+    while (ok && !em->stopped) {
+        int n = order_next(&o, chunk, BATCH_ROWS);
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        scan.rows = chunk;
+        scan.num_rows = n;
+        m->count = 0;
+        ok = pipeline_run(t, &scan, &collect);
+        for (int i = 0; ok && i < m->count && !em->stopped; i++) emit_row(em, m->rows[i]);
+    }
+    if (em) {
+        emit_flush(em);
+        ok = ok && em->ok;
+    }
+
+    free(o.group);
+    free(chunk);
+    free(m);
+    free(em);
+    return ok;
+}
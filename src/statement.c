@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   PREPARED STATEMENTS — prepare / bind / step / finalize
+   ============================================================
+   stmt_prepare parses the SQL once and resolves the table, the SELECT
+   columns and the WHERE program; that work is kept until a table is
+   created or dropped (db->schema_version moves). A run after that skips
+   the parser and every name lookup: an INSERT hands its typed row straight
+   to insert_values_quiet, with literals parsed once at resolution and binds
+   used as they are unless the column has another type. A SELECT refreshes its predicates' bounds from
+   the bindings, then plans and scans.
+
+   A SELECT streams: each step takes the next row of the current pipeline
+   batch (see cursor.c), and the column readers read the table in place,
+   so it must not change while a SELECT is being stepped. Prepared
+   statements are not written to the command log. */
+
+/* ===== Resolution ===== */
+
+static void release_resolution(Statement* st) {
+    where_free(&st->prog);
+    free(st->preds);
+    free(st->cols);
+    st->preds = NULL;
+    st->cols = NULL;
+    st->t = NULL;
+    st->resolved = 0;
+}
+
+/* Pairs each program predicate with its comparison, in the compiler's
+   left-to-right leaf order. */
+static void collect_leaves(const Expr* e, StmtPred* preds, int* n) {
+    if (e->kind == EXPR_CMP) {
+        preds[(*n)++].cond = &e->cmp;
+        return;
+    }
+    collect_leaves(e->left, preds, n);
+    if (e->right) collect_leaves(e->right, preds, n);
+}
+
+static int resolve_select(Statement* st, Table* t) {
+    int n = st->col_names ? st->num_cols : t->num_columns;
+    st->cols = malloc(sizeof(int) * (size_t)(n > 0 ? n : 1));
+    if (!st->cols) return 0;
+    for (int i = 0; i < n; i++) {
+        st->cols[i] = st->col_names ? column_index(t, st->col_names[i]) : i;
+        if (st->cols[i] < 0) {
+            printf("Error: unknown column '%s'.\n", st->col_names[i]);
+            return 0;
+        }
+    }
+    st->num_cols = n;
+    if (!st->where) return 1;
+
+    if (!where_compile(t, st->where, &st->prog)) return 0;
+    st->preds = calloc((size_t)st->prog.num_preds, sizeof(StmtPred));
+    if (!st->preds) return 0;
+    int leaves = 0;
+    collect_leaves(st->where, st->preds, &leaves);
+    for (int i = 0; i < st->prog.num_preds; i++) {
+        StmtPred* sp = &st->preds[i];
+        // Literal bounds are typed once; ? bounds wait for each run
+        if (!sp->cond->param && !sp->cond->param2) {
+            sp->valid = condition_range(t->columns[st->prog.preds[i].col].type, sp->cond, &sp->range);
+        }
+    }
+    return 1;
+}
+
+/* Checks the arity and types each literal INSERT value for its column. */
+static int resolve_insert(Statement* st, Table* t) {
+    if (st->num_values != t->num_columns) {
+        printf("Error: expected %d values, got %d.\n", t->num_columns, st->num_values);
+        return 0;
+    }
+    for (int i = 0; i < st->num_values; i++) {
+        const char* lit = st->values[i].literal;
+        if (st->values[i].param || value_parse(t->columns[i].type, lit, &st->row[i])) continue;
+        printf("Error: '%s' is not a valid %s value for column '%s'.\n",
+               lit, column_type_to_string(t->columns[i].type), t->columns[i].name);
+        return 0;
+    }
+    return 1;
+}
+
+/* Resolves names against the current schema unless that is already done. */
+static int resolve(Statement* st) {
+    if (st->resolved && st->schema_version == st->db->schema_version) return 1;
+    release_resolution(st);
+    Table* t = find_table(st->db, st->table);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", st->table);
+        return 0;
+    }
+    if (st->kind == STMT_INSERT && !resolve_insert(st, t)) return 0;
+    if (st->kind == STMT_SELECT && !resolve_select(st, t)) {
+        release_resolution(st);
+        return 0;
+    }
+    st->t = t;
+    st->resolved = 1;
+    st->schema_version = st->db->schema_version;
+    return 1;
+}
+
+/* ===== Binding ===== */
+
+static BindSlot* bind_slot(Statement* st, int param) {
+    if (param < 1 || param > st->num_params) {
+        printf("Error: no parameter ?%d; the statement has %d.\n", param, st->num_params);
+        return NULL;
+    }
+    // New values apply from the next run
+    stmt_reset(st);
+    BindSlot* b = &st->params[param - 1];
+    b->set = 0;
+    return b;
+}
+
+/* Stores text as the slot's text form, reusing its buffer. */
+static int set_text(BindSlot* b, const char* text) {
+    size_t len = strlen(text);
+    if (len + 1 > b->text_cap) {
+        size_t cap = b->text_cap ? b->text_cap : 32;
+        while (cap < len + 1) cap *= 2;
+        char* tmp = realloc(b->text, cap);
+        if (!tmp) {
+            fprintf(stderr, "Out of memory binding a parameter.\n");
+            return 0;
+        }
+        b->text = tmp;
+        b->text_cap = cap;
+    }
+    memcpy(b->text, text, len + 1);
+    b->set = 1;
+    return 1;
+}
+
+/* The slot's text form; a number is rendered only when first asked for.
+   NULL on out of memory. */
+static const char* bound_text(BindSlot* b) {
+    if (b->v.s) return b->v.s;
+    char buf[64];
+    if (!set_text(b, value_text(&b->v, buf, sizeof(buf)))) return NULL;
+    b->v.s = b->text;
+    return b->v.s;
+}
+
+int stmt_bind_int(Statement* st, int param, int64_t v) {
+    BindSlot* b = bind_slot(st, param);
+    if (!b) return 0;
+    b->v.type = COL_INT;
+    b->v.i = v;
+    b->v.s = NULL;
+    b->set = 1;
+    return 1;
+}
+
+int stmt_bind_float(Statement* st, int param, double v) {
+    BindSlot* b = bind_slot(st, param);
+    if (!b) return 0;
+    b->v.type = COL_FLOAT;
+    b->v.f = v;
+    b->v.s = NULL;
+    b->set = 1;
+    return 1;
+}
+
+int stmt_bind_text(Statement* st, int param, const char* s) {
+    BindSlot* b = bind_slot(st, param);
+    if (!b || !set_text(b, s)) return 0;
+    b->v.type = COL_TEXT;
+    b->v.s = b->text;
+    return 1;
+}
+
+static int check_bound(const Statement* st) {
+    for (int i = 0; i < st->num_params; i++) {
+        if (!st->params[i].set) {
+            printf("Error: parameter ?%d is not bound.\n", i + 1);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* A bound value in the column's type; 0 if it can never match (a value
+   the column cannot hold, as with a literal). */
+static int bound_value(BindSlot* b, ColumnType type, Value* out) {
+    if (b->v.type == type) {
+        *out = b->v;
+        return 1;
+    }
+    if (type == COL_FLOAT && b->v.type == COL_INT) {
+        out->type = COL_FLOAT;
+        out->f = (double)b->v.i;
+        out->s = NULL;
+        return 1;
+    }
+    const char* text = bound_text(b);
+    return text && value_parse(type, text, out);
+}
+
+static int operand(Statement* st, int param, const char* literal, ColumnType type, Value* out) {
+    return param ? bound_value(&st->params[param - 1], type, out) : value_parse(type, literal, out);
+}
+
+/* Re-prepares every predicate for this run: ? bounds come from the
+   bindings, and dictionary codes and the layout are read afresh. */
+static int refresh_predicates(Statement* st) {
+    for (int i = 0; i < st->prog.num_preds; i++) {
+        const StmtPred* sp = &st->preds[i];
+        const Condition* c = sp->cond;
+        Predicate* p = &st->prog.preds[i];
+        int col = p->col;
+        ColumnType type = st->t->columns[col].type;
+        KeyRange range = sp->range;
+        int valid = sp->valid;
+        if (c->param || c->param2) {
+            Value v, v2;
+            memset(&v2, 0, sizeof(Value));
+            valid = operand(st, c->param, c->value, type, &v) &&
+                    (c->op != CMP_BETWEEN || operand(st, c->param2, c->value2, type, &v2));
+            if (valid) compare_range(c->op, &v, &v2, &range);
+        }
+        predicate_free(p);
+        if (!valid) {
+            memset(p, 0, sizeof(Predicate));
+            p->col = col;
+            p->type = type;
+            p->empty = 1;
+        } else if (!predicate_prepare(st->t, col, &range, p)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ===== Execution ===== */
+
+static StepResult step_insert(Statement* st) {
+    // Literal cells were typed at resolution; only binds change between runs
+    for (int i = 0; i < st->num_values; i++) {
+        int param = st->values[i].param;
+        const ColumnDef* c = &st->t->columns[i];
+        if (!param || bound_value(&st->params[param - 1], c->type, &st->row[i])) continue;
+        const char* text = bound_text(&st->params[param - 1]);
+        if (text) {
+            printf("Error: '%s' is not a valid %s value for column '%s'.\n",
+                   text, column_type_to_string(c->type), c->name);
+        }
+        return STEP_ERROR;
+    }
+    Value* row = st->row;
+    return insert_values_quiet(st->t, &row, 1) ? STEP_DONE : STEP_ERROR;
+}
+
+/* A ? LIMIT count or OFFSET as a non-negative integer; literal ones stay. */
+static int bound_count(Statement* st, int param, int64_t* out) {
+    if (!param) return 1;
+    Value v;
+    if (bound_value(&st->params[param - 1], COL_INT, &v) && v.i >= 0) {
+        *out = v.i;
+        return 1;
+    }
+    printf("Error: parameter ?%d must be a non-negative integer for LIMIT or OFFSET.\n", param);
+    return 0;
+}
+
+/* Plans this run and opens its pipeline. */
+static int start_select(Statement* st) {
+    Table* t = st->t;
+    st->batch = NULL;
+    st->pos = 0;
+    RowLimit limit = st->limit;
+    if (!bound_count(st, st->limit_param, &limit.count) ||
+        !bound_count(st, st->offset_param, &limit.offset)) {
+        return 0;
+    }
+    if ((st->where && !refresh_predicates(st)) ||
+        !plan_program(t, st->where ? &st->prog : NULL, &limit, &st->spec)) {
+        fprintf(stderr, "Out of memory running a prepared SELECT on '%s'.\n", st->table);
+        return 0;
+    }
+    st->spec.cols = st->cols;
+    st->spec.num_cols = st->num_cols;
+    st->pipe = pipeline_open(t, &st->spec);
+    if (!st->pipe) {
+        fprintf(stderr, "Out of memory running a prepared SELECT on '%s'.\n", st->table);
+        return 0;
+    }
+    return 1;
+}
+
+StepResult stmt_step(Statement* st) {
+    if (!st->pipe) {
+        if (!resolve(st) || !check_bound(st)) return STEP_ERROR;
+        if (st->kind == STMT_INSERT) return step_insert(st);
+        if (!start_select(st)) {
+            stmt_reset(st);
+            return STEP_ERROR;
+        }
+    }
+    if (!st->batch || st->pos == st->batch->count) {
+        st->batch = pipeline_next(st->pipe, &st->views);
+        st->pos = 0;
+    }
+    if (st->batch) {
+        st->pos++;
+        return STEP_ROW;
+    }
+    // Done; the next step runs the query again
+    stmt_reset(st);
+    return STEP_DONE;
+}
+
+void stmt_reset(Statement* st) {
+    pipeline_close(st->pipe);
+    st->pipe = NULL;
+    free((int*)st->spec.rows);
+    st->spec.rows = NULL;
+    st->batch = NULL;
+    st->pos = 0;
+}
+
+/* ===== Results ===== */
+
+int stmt_column_count(const Statement* st) {
+    return st->kind == STMT_SELECT ? st->num_cols : 0;
+}
+
+const char* stmt_column_name(const Statement* st, int i) {
+    return st->t->columns[st->cols[i]].name;
+}
+
+void stmt_column_value(const Statement* st, int i, Value* out) {
+    table_cell_value(st->t, st->batch->sel[st->pos - 1], st->cols[i], out);
+}
+
+const char* stmt_column_text(Statement* st, int i) {
+    return vector_cell_text(&st->views[i], st->batch, st->pos - 1, st->text_buf, sizeof(st->text_buf));
+}
+
+/* ===== Lifetime ===== */
+
+Statement* stmt_prepare(Database* db, const char* sql) {
+    Statement* st = calloc(1, sizeof(Statement));
+    char* text = str_duplicate(sql);
+    if (!st || !text) {
+        fprintf(stderr, "Out of memory preparing statement.\n");
+        free(st);
+        free(text);
+        return NULL;
+    }
+    st->db = db;
+    st->limit.count = -1;
+    int ok = parse_prepared(text, st);
+    free(text);
+
+    if (ok && st->num_params > 0) {
+        st->params = calloc((size_t)st->num_params, sizeof(BindSlot));
+        ok = st->params != NULL;
+    }
+    if (ok && st->kind == STMT_INSERT) {
+        st->row = calloc((size_t)(st->num_values > 0 ? st->num_values : 1), sizeof(Value));
+        ok = st->row != NULL;
+    }
+    // Resolve now so a bad table or column is reported at prepare time
+    if (!ok || !resolve(st)) {
+        stmt_finalize(st);
+        return NULL;
+    }
+    return st;
+}
+
+void stmt_finalize(Statement* st) {
+    if (!st) return;
+    stmt_reset(st);
+    release_resolution(st);
+    for (int i = 0; i < st->num_params; i++) free(st->params ? st->params[i].text : NULL);
+    free(st->params);
+    for (int i = 0; i < st->num_values; i++) free(st->values[i].literal);
+    free(st->values);
+    free(st->row);
+    for (int i = 0; st->col_names && i < st->num_cols; i++) free(st->col_names[i]);
+    free(st->col_names);
+    expr_free(st->where);
+    free(st);
+}
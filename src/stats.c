@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   TABLE STATISTICS — ANALYZE, estimates and access-path costs
+   ============================================================
+   ANALYZE reads every live cell of each column once for its exact count,
+   min and max, and keeps every step-th value as a sample (all of them up
+   to STATS_SAMPLE_ROWS). The sorted sample gives an equi-depth histogram
+   and the distinct count; when only part of the column was sampled, the
+   Duj1 estimator scales that count from the values seen exactly once.
+   Statistics are a snapshot. Later writes leave them alone until the next
+   ANALYZE, and estimates are shares that scale with the current live rows.
+
+   With statistics the planner prices the ways of reading a range: a scan
+   reads every row slot, or only the blocks the zone maps cannot rule
+   out, while an index probe pays a random access per expected match.
+   Without statistics it keeps the rule that any usable index wins. A
+   conjunction is driven by its cheapest predicate and refined by the rest
+   from most to least selective, and a join hashes the side expected to
+   yield fewer rows. */
+
+#define STATS_SAMPLE_ROWS (1 << 20)  // values sorted per column at most
+#define COST_SCAN_ROW 1.0            // reading one row slot in a table scan
+#define COST_INDEX_ROW 4.0           // fetching one matching row through an index
+
+/* ===== Values ===== */
+
+const char* value_text(const Value* v, char* buf, size_t buf_sz) {
+    switch (v->type) {
+        case COL_INT:
+            snprintf(buf, buf_sz, "%" PRId64, v->i);
+            return buf;
+        case COL_FLOAT:
+            format_float_value(v->f, buf, buf_sz);
+            return buf;
+        default:
+            return v->s ? v->s : "NULL";
+    }
+}
+
+/* Replaces a TEXT value's borrowed bytes with an owned copy, cut to
+   MAX_VALUE_LEN - 1 bytes (plenty for estimates). */
+static int own_value(Value* v) {
+    if (v->type != COL_TEXT || !v->s) return 1;
+    size_t len = strlen(v->s);
+    if (len > MAX_VALUE_LEN - 1) len = MAX_VALUE_LEN - 1;
+    char* copy = malloc(len + 1);
+    if (!copy) {
+        v->s = NULL;
+        return 0;
+    }
+    memcpy(copy, v->s, len);
+    copy[len] = '\0';
+    v->s = copy;
+    return 1;
+}
+
+static void free_value(Value* v) {
+    if (v->type == COL_TEXT) free((char*)v->s);
+    v->s = NULL;
+}
+
+static double as_number(const Value* v) {
+    return v->type == COL_INT ? (double)v->i : v->f;
+}
+
+static int is_point(const KeyRange* r) {
+    return r->has_lo && r->has_hi && r->lo_incl && r->hi_incl && value_equals(&r->lo, &r->hi);
+}
+
+/* ===== ANALYZE ===== */
+
+void stats_clear_column(ColumnStats* s) {
+    free_value(&s->min);
+    free_value(&s->max);
+    for (int i = 0; i < s->num_bounds; i++) free_value(&s->bounds[i]);
+    memset(s, 0, sizeof(ColumnStats));
+}
+
+ColumnStats* stats_reserve(Table* t) {
+    if (!t->stats) t->stats = calloc((size_t)t->num_columns, sizeof(ColumnStats));
+    return t->stats;
+}
+
+void stats_free(Table* t) {
+    if (!t->stats) return;
+    for (int c = 0; c < t->num_columns; c++) stats_clear_column(&t->stats[c]);
+    free(t->stats);
+    t->stats = NULL;
+    t->stats_rows = 0;
+}
+
+static int compare_values(const void* a, const void* b) {
+    return value_compare(a, b);
+}
+
+/* Fills s from column c. sample has room for min(live, STATS_SAMPLE_ROWS)
+   values; 0 on out of memory. */
+static int analyze_column(const Table* t, int c, int64_t live, Value* sample, ColumnStats* s) {
+    int64_t step = live > STATS_SAMPLE_ROWS ? (live + STATS_SAMPLE_ROWS - 1) / STATS_SAMPLE_ROWS : 1;
+    int64_t seen = 0;
+    int n = 0;
+    Value v;
+    memset(s, 0, sizeof(ColumnStats));
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        int take = seen++ % step == 0;
+        table_cell_value(t, r, c, &v);
+        if (v.type == COL_TEXT && !v.s) continue;
+        if (s->count == 0 || value_compare(&v, &s->min) < 0) s->min = v;
+        if (s->count == 0 || value_compare(&v, &s->max) > 0) s->max = v;
+        s->count++;
+        if (take) sample[n++] = v;
+    }
+
+    qsort(sample, (size_t)n, sizeof(Value), compare_values);
+    int64_t distinct = 0, once = 0;
+    for (int k = 0; k < n;) {
+        int run = 1;
+        while (k + run < n && value_compare(&sample[k], &sample[k + run]) == 0) run++;
+        distinct++;
+        once += run == 1;
+        k += run;
+    }
+    s->ndv = distinct;
+    if (n < s->count && n > 0) {
+        // Duj1: singletons in the sample hint at values it missed
+        double est = (double)n * (double)distinct / ((double)(n - once) + (double)once * n / (double)s->count);
+        if (est > (double)s->count) est = (double)s->count;
+        if (est > distinct) s->ndv = (int64_t)est;
+    }
+
+    s->num_bounds = n < STATS_BUCKETS ? n : STATS_BUCKETS;
+    for (int i = 0; i < s->num_bounds; i++) {
+        s->bounds[i] = sample[(int64_t)(i + 1) * n / s->num_bounds - 1];
+    }
+    s->analyzed = 1;
+
+    // Everything so far borrows table bytes; keep copies instead
+    s->min.type = s->max.type = t->columns[c].type;
+    int ok = own_value(&s->min) & own_value(&s->max);
+    for (int i = 0; i < s->num_bounds; i++) ok &= own_value(&s->bounds[i]);
+    return ok;
+}
+
+int analyze_table(Table* t) {
+    int64_t live = t->num_rows - t->num_deleted;
+    int64_t cap = live < STATS_SAMPLE_ROWS ? live : STATS_SAMPLE_ROWS;
+    Value* sample = malloc(sizeof(Value) * (size_t)(cap > 0 ? cap : 1));
+    ColumnStats* stats = calloc((size_t)(t->num_columns > 0 ? t->num_columns : 1), sizeof(ColumnStats));
+    int ok = sample && stats;
+    for (int c = 0; ok && c < t->num_columns; c++) ok = analyze_column(t, c, live, sample, &stats[c]);
+    free(sample);
+    if (!ok) {
+        for (int c = 0; stats && c < t->num_columns; c++) stats_clear_column(&stats[c]);
+        free(stats);
+        fprintf(stderr, "Out of memory analyzing '%s'.\n", t->name);
+        return 0;
+    }
+    stats_free(t);
+    t->stats = stats;
+    t->stats_rows = live;
+    t->write_version++;  // the plan, and so an unordered result's row order, may change
+    return 1;
+}
+
+/* ===== Estimates ===== */
+
+/* Share of the column's values that are <= v, read off the histogram;
+   numbers interpolate within their bucket, strings take its middle. */
+static double share_at_most(const ColumnStats* s, const Value* v) {
+    if (value_compare(v, &s->min) < 0) return 0.0;
+    if (value_compare(v, &s->max) >= 0) return 1.0;
+    // Buckets before i end at or below v
+    int i = 0;
+    while (i < s->num_bounds && value_compare(&s->bounds[i], v) <= 0) i++;
+    if (i == s->num_bounds) return 1.0;
+    if (i > 0 && value_compare(&s->bounds[i - 1], v) == 0) return (double)i / s->num_bounds;
+    const Value* lo = i > 0 ? &s->bounds[i - 1] : &s->min;
+    double within = 0.5;
+    if (v->type != COL_TEXT) {
+        double width = as_number(&s->bounds[i]) - as_number(lo);
+        within = width > 0 ? (as_number(v) - as_number(lo)) / width : 1.0;
+        if (within < 0.0) within = 0.0;
+        if (within > 1.0) within = 1.0;
+    }
+    return (i + within) / s->num_bounds;
+}
+
+/* Share of the column's values equal to v: a value that is the bound of
+   several buckets fills about that many, anything else gets 1 / ndv. */
+static double share_equal(const ColumnStats* s, const Value* v) {
+    if (s->ndv == 0 || value_compare(v, &s->min) < 0 || value_compare(v, &s->max) > 0) return 0.0;
+    int bounds = 0;
+    for (int i = 0; i < s->num_bounds; i++) bounds += value_compare(&s->bounds[i], v) == 0;
+    if (bounds > 1) return (double)bounds / s->num_bounds;
+    return 1.0 / (double)s->ndv;
+}
+
+double stats_selectivity(const Table* t, int col, const KeyRange* r) {
+    if (!t->stats || !t->stats[col].analyzed) return 1.0;
+    const ColumnStats* s = &t->stats[col];
+    if (s->count == 0 || t->stats_rows == 0) return 0.0;
+
+    double share;
+    if (is_point(r)) {
+        share = share_equal(s, &r->lo);
+    } else {
+        double lo = 0.0, hi = 1.0;
+        if (r->has_lo) lo = share_at_most(s, &r->lo) - (r->lo_incl ? share_equal(s, &r->lo) : 0.0);
+        if (r->has_hi) hi = share_at_most(s, &r->hi) - (r->hi_incl ? 0.0 : share_equal(s, &r->hi));
+        share = hi - lo;
+    }
+    if (r->exclude) share = 1.0 - share;
+    // NULLs match no comparison
+    share *= (double)s->count / (double)t->stats_rows;
+    if (share < 0.0) return 0.0;
+    return share > 1.0 ? 1.0 : share;
+}
+
+static double expr_selectivity(Table* t, const Expr* e) {
+    switch (e->kind) {
+        case EXPR_CMP: {
+            int col = column_index(t, e->cmp.column);
+            if (col < 0) return 1.0;
+            KeyRange range;
+            if (!condition_range(t->columns[col].type, &e->cmp, &range)) return 0.0;
+            return stats_selectivity(t, col, &range);
+        }
+        case EXPR_NOT:
+            return 1.0 - expr_selectivity(t, e->left);
+        case EXPR_AND:
+            // Columns are taken to be independent
+            return expr_selectivity(t, e->left) * expr_selectivity(t, e->right);
+        default: {
+            double a = expr_selectivity(t, e->left);
+            double b = expr_selectivity(t, e->right);
+            return a + b - a * b;
+        }
+    }
+}
+
+double stats_estimate_rows(Table* t, const Expr* where) {
+    double live = (double)(t->num_rows - t->num_deleted);
+    if (!where || !t->stats) return live;
+    return live * expr_selectivity(t, where);
+}
+
+/* ===== Access paths ===== */
+
+/* Row slots a scan filtered on range reads: every slot, or the blocks the
+   zone maps keep; under a LIMIT, only until cap matches turned up. */
+static double scan_cost(const Table* t, int col, const KeyRange* range, double matches, int64_t cap) {
+    double slots = t->num_rows;
+    const ColumnStorage* cs = &t->column_data[col];
+    if (t->column_major && cs->type != COL_TEXT) {
+        int blocks = zone_block_count(t->num_rows);
+        int hit = 0;
+        for (int b = 0; b < blocks; b++) hit += zone_may_match(cs, b, range);
+        if ((double)hit * ZONE_ROWS < slots) slots = (double)hit * ZONE_ROWS;
+    }
+    if (cap >= 0 && matches > (double)cap) slots *= (double)cap / matches;
+    return slots * COST_SCAN_ROW;
+}
+
+double plan_access(Table* t, int col, const KeyRange* range, int64_t cap, Index** ix) {
+    // Equality prefers a hash index, ranges a B+tree (key order); <> always scans
+    int point = is_point(range);
+    Index* cand = NULL;
+    if (!range->exclude) cand = point ? table_find_index(t, col) : table_find_ordered_index(t, col);
+    *ix = cand;
+    if (!t->stats) return -1.0;
+
+    double live = (double)(t->num_rows - t->num_deleted);
+    double matches = stats_selectivity(t, col, range) * live;
+    double scan = scan_cost(t, col, range, matches, cap);
+    if (!cand) return scan;
+    // A point lookup returns every match; a range probe stops at cap keys
+    double fetched = !point && cap >= 0 && matches > cap ? (double)cap : matches;
+    double probe = fetched * COST_INDEX_ROW + log2(live + 2.0);
+    if (probe < scan) return probe;
+    *ix = NULL;
+    return scan;
+}
+
+void plan_order(Table* t, WhereProgram* prog) {
+    int n = prog->num_preds;
+    for (int i = 0; i < n; i++) prog->order[i] = i;
+    if (!t->stats || !prog->conjunctive || n < 2) return;
+    double* sel = malloc(sizeof(double) * (size_t)n);
+    if (!sel) return;  // the written order still works
+
+    // Drive with the cheapest access path, ties going to the more selective
+    int best = 0;
+    double best_cost = 0.0;
+    for (int i = 0; i < n; i++) {
+        const Predicate* p = &prog->preds[i];
+        Index* ix;
+        double cost = p->empty ? 0.0 : plan_access(t, p->col, &p->range, -1, &ix);
+        sel[i] = p->empty ? 0.0 : p->all ? 1.0 : stats_selectivity(t, p->col, &p->range);
+        if (i == 0 || cost < best_cost || (cost == best_cost && sel[i] < sel[best])) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    // The rest refine the selection, most selective first (stable)
+    prog->order[0] = best;
+    int m = 1;
+    for (int i = 0; i < n; i++) {
+        if (i == best) continue;
+        int k = m++;
+        while (k > 1 && sel[prog->order[k - 1]] > sel[i]) {
+            prog->order[k] = prog->order[k - 1];
+            k--;
+        }
+        prog->order[k] = i;
+    }
+    free(sel);
+}
+
+/* ===== Display ===== */
+
+void print_table_stats(const Table* t) {
+    if (!t->stats) {
+        printf("Table '%s' has no statistics; run ANALYZE %s.\n", t->name, t->name);
+        return;
+    }
+    printf("%s: %" PRId64 " live row(s) when analyzed\n", t->name, t->stats_rows);
+    char lo[64], hi[64];
+    for (int c = 0; c < t->num_columns; c++) {
+        const ColumnStats* s = &t->stats[c];
+        if (!s->analyzed) continue;
+        printf("  %s %s: %" PRId64 " value(s), ~%" PRId64 " distinct", t->columns[c].name,
+               column_type_to_string(t->columns[c].type), s->count, s->ndv);
+        if (s->count > 0) {
+            printf(", min %s, max %s, %d bucket(s)", value_text(&s->min, lo, sizeof(lo)),
+                   value_text(&s->max, hi, sizeof(hi)), s->num_bounds);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,455 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   MATERIALIZED VIEWS — GROUP BY results kept current incrementally
+   ============================================================
+   CREATE MATERIALIZED VIEW v AS SELECT g, COUNT(*), SUM(x) FROM t GROUP BY g
+   stores one row per group in a column-major result table that reads like
+   any other: SELECT, WHERE, ORDER BY and JOIN run over the groups only.
+
+   The view is built once by a full scan. After that the base table's
+   insert, update and delete paths hand every changed row to
+   views_note_row, which finds its group through a chained hash of the
+   result rows and folds the row in or out of the group's running COUNT
+   and SUM; the cells are rewritten in place. A group whose last row goes
+   is swapped with the final result row, so the view never holds dead
+   rows. MIN and MAX cannot be undone by a delete and are not offered.
+
+   FLOAT sums are kept by adding and subtracting, so after deletes and
+   updates they can differ in the last bits from a fresh GROUP BY. */
+
+#define VIEW_MIN_BUCKETS 64
+
+static const char* item_name(AggFunc f) {
+    switch (f) {
+        case AGG_COUNT: return "COUNT";
+        case AGG_SUM:   return "SUM";
+        case AGG_AVG:   return "AVG";
+        case AGG_MIN:   return "MIN";
+        case AGG_MAX:   return "MAX";
+        default:        return "";
+    }
+}
+
+/* ===== Group lookup ===== */
+
+static uint32_t key_hash(const MatView* v, const Table* t, int row) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < v->num_group; i++) {
+        Value val;
+        table_cell_value(t, row, v->group_cols[i], &val);
+        uint32_t vh = (val.type == COL_TEXT && !val.s) ? 0 : value_hash(&val);
+        h = (h ^ vh) * 16777619u;
+    }
+    return h;
+}
+
+//Base row's key against result row g
+static int key_equals(const MatView* v, const Table* t, int row, int g) {
+    for (int i = 0; i < v->num_group; i++) {
+        Value a, b;
+        table_cell_value(t, row, v->group_cols[i], &a);
+        table_cell_value(&v->table, g, v->key_cols[i], &b);
+        if (a.type == COL_TEXT && (!a.s || !b.s)) {
+            if (a.s != b.s) return 0;  // NULL only groups with NULL
+        } else if (!value_equals(&a, &b)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int find_group(const MatView* v, const Table* t, int row, uint32_t h) {
+    if (v->num_buckets == 0) return -1;
+    for (int g = v->heads[h & (uint32_t)(v->num_buckets - 1)]; g >= 0; g = v->next[g]) {
+        if (v->hashes[g] == h && key_equals(v, t, row, g)) return g;
+    }
+    return -1;
+}
+
+static void link_group(MatView* v, int g) {
+    int* head = &v->heads[v->hashes[g] & (uint32_t)(v->num_buckets - 1)];
+    v->next[g] = *head;
+    *head = g;
+}
+
+static void unlink_group(MatView* v, int g) {
+    int* link = &v->heads[v->hashes[g] & (uint32_t)(v->num_buckets - 1)];
+    while (*link != g) link = &v->next[*link];
+    *link = v->next[g];
+}
+
+//Doubles the buckets and relinks every group; 0 on out of memory
+static int grow_buckets(MatView* v) {
+    int n = v->num_buckets ? v->num_buckets * 2 : VIEW_MIN_BUCKETS;
+    int* heads = malloc(sizeof(int) * (size_t)n);
+    if (!heads) return 0;
+    for (int i = 0; i < n; i++) heads[i] = -1;
+    free(v->heads);
+    v->heads = heads;
+    v->num_buckets = n;
+    for (int g = 0; g < v->table.num_rows; g++) link_group(v, g);
+    return 1;
+}
+
+/* ===== Groups ===== */
+
+static int reserve_groups(MatView* v, int n) {
+    if (n <= v->group_cap) return 1;
+    int cap = v->group_cap ? v->group_cap * 2 : 16;
+    while (cap < n) cap *= 2;
+    int64_t* rows = realloc(v->rows, sizeof(int64_t) * (size_t)cap);
+    if (rows) v->rows = rows;
+    ViewAcc* accs = realloc(v->accs, sizeof(ViewAcc) * (size_t)cap * (size_t)v->table.num_columns);
+    if (accs) v->accs = accs;
+    uint32_t* hashes = realloc(v->hashes, sizeof(uint32_t) * (size_t)cap);
+    if (hashes) v->hashes = hashes;
+    int* next = realloc(v->next, sizeof(int) * (size_t)cap);
+    if (next) v->next = next;
+    if (!rows || !accs || !hashes || !next || !table_reserve(&v->table, 1, cap)) return 0;
+    v->group_cap = cap;
+    return 1;
+}
+
+/* Appends an empty group keyed like base row row. Only the key cells are
+   written; the caller fills the rest and notes the row in the zone maps. */
+static int new_group(MatView* v, const Table* t, int row, uint32_t h) {
+    Table* vt = &v->table;
+    if (!reserve_groups(v, vt->num_rows + 1)) return -1;
+    if (vt->num_rows >= v->num_buckets && !grow_buckets(v)) return -1;
+    int g = vt->num_rows;
+    for (int i = 0; i < v->num_group; i++) {
+        ColumnStorage* col = &vt->column_data[v->key_cols[i]];
+        Value val;
+        table_cell_value(t, row, v->group_cols[i], &val);
+        switch (col->type) {
+            case COL_INT:   col->ints[g] = val.i; break;
+            case COL_FLOAT: col->floats[g] = val.f; break;
+            default:
+                col->values[g] = val.s ? arena_strdup(&vt->arena, val.s) : NULL;
+                if (val.s && !col->values[g]) return -1;
+                break;
+        }
+    }
+    v->rows[g] = 0;
+    memset(&v->accs[(size_t)g * (size_t)vt->num_columns], 0, sizeof(ViewAcc) * (size_t)vt->num_columns);
+    v->hashes[g] = h;
+    link_group(v, g);
+    vt->num_rows++;
+    return g;
+}
+
+/* Drops group g by moving the last result row into its place. The
+   dropped key's text stays in the view's arena. */
+static void remove_group(MatView* v, int g) {
+    Table* vt = &v->table;
+    int last = vt->num_rows - 1;
+    unlink_group(v, g);
+    if (g != last) {
+        unlink_group(v, last);
+        for (int c = 0; c < vt->num_columns; c++) {
+            ColumnStorage* col = &vt->column_data[c];
+            switch (col->type) {
+                case COL_INT:   col->ints[g] = col->ints[last]; break;
+                case COL_FLOAT: col->floats[g] = col->floats[last]; break;
+                default:        col->values[g] = col->values[last]; break;
+            }
+            zone_widen(col, g);
+        }
+        memcpy(&v->accs[(size_t)g * (size_t)vt->num_columns], &v->accs[(size_t)last * (size_t)vt->num_columns],
+               sizeof(ViewAcc) * (size_t)vt->num_columns);
+        v->rows[g] = v->rows[last];
+        v->hashes[g] = v->hashes[last];
+        link_group(v, g);
+    }
+    vt->num_rows--;
+}
+
+//Rewrites aggregate cell c of group g from its totals
+static void store_result(MatView* v, int g, int c) {
+    ColumnStorage* col = &v->table.column_data[c];
+    const ViewItem* it = &v->items[c];
+    const ViewAcc* a = &v->accs[(size_t)g * (size_t)v->table.num_columns + (size_t)c];
+    switch (it->func) {
+        case AGG_COUNT:
+            col->ints[g] = it->src < 0 ? v->rows[g] : a->count;
+            break;
+        case AGG_SUM:
+            if (col->type == COL_INT) col->ints[g] = a->isum;
+            else col->floats[g] = a->fsum;
+            break;
+        case AGG_AVG:
+            col->floats[g] = a->count == 0 ? 0.0
+                           : (it->type == COL_INT ? (double)a->isum : a->fsum) / (double)a->count;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Folds base row row into (sign 1) or out of (sign -1) its group. 0 on
+   out of memory. */
+static int view_apply(MatView* v, const Table* t, int row, int sign) {
+    Table* vt = &v->table;
+    uint32_t h = key_hash(v, t, row);
+    int g = find_group(v, t, row, h);
+    int fresh = g < 0;
+    if (fresh) {
+        if (sign < 0) return 1;  // never folded in, nothing to take out
+        g = new_group(v, t, row, h);
+        if (g < 0) return 0;
+    }
+    vt->write_version++;
+    v->rows[g] += sign;
+    if (v->rows[g] <= 0) {
+        remove_group(v, g);
+        return 1;
+    }
+
+    ViewAcc* accs = &v->accs[(size_t)g * (size_t)vt->num_columns];
+    for (int c = 0; c < vt->num_columns; c++) {
+        const ViewItem* it = &v->items[c];
+        if (it->func == AGG_NONE) continue;
+        if (it->src >= 0) {
+            Value val;
+            table_cell_value(t, row, it->src, &val);
+            if (val.type == COL_TEXT && !val.s) continue;  // aggregates skip NULL cells
+            accs[c].count += sign;
+            if (val.type == COL_INT) accs[c].isum += sign > 0 ? val.i : -val.i;
+            else if (val.type == COL_FLOAT) accs[c].fsum += sign > 0 ? val.f : -val.f;
+        }
+        store_result(v, g, c);
+        if (!fresh) zone_widen(&vt->column_data[c], g);
+    }
+    if (fresh) {
+        for (int c = 0; c < vt->num_columns; c++) zone_note_row(&vt->column_data[c], g);
+    }
+    return 1;
+}
+
+static int view_reads(const MatView* v, int col) {
+    for (int i = 0; i < v->num_group; i++) {
+        if (v->group_cols[i] == col) return 1;
+    }
+    for (int c = 0; c < v->table.num_columns; c++) {
+        if (v->items[c].src == col) return 1;
+    }
+    return 0;
+}
+
+void views_note_row(Table* t, int row, int sign, int col) {
+    for (int i = 0; i < t->num_views; i++) {
+        MatView* v = t->views[i];
+        if (col >= 0 && !view_reads(v, col)) continue;
+        if (!view_apply(v, t, row, sign)) {
+            fprintf(stderr, "Out of memory maintaining view '%s'.\n", v->table.name);
+        }
+    }
+}
+
+/* ===== Definition ===== */
+
+/* Resolves the SELECT list and GROUP BY against the base table and names
+   the result columns; prints the error and returns 0 on a bad item. */
+static int resolve_view(MatView* v, Table* t, const SelectItem* items, char** names,
+                        int num_items, char** group_cols, ColumnDef* defs) {
+    for (int i = 0; i < v->num_group; i++) {
+        v->group_cols[i] = column_index(t, group_cols[i]);
+        if (v->group_cols[i] < 0) {
+            printf("Error: unknown column '%s' in GROUP BY.\n", group_cols[i]);
+            return 0;
+        }
+        v->key_cols[i] = -1;
+    }
+    for (int i = 0; i < num_items; i++) {
+        ViewItem* it = &v->items[i];
+        it->func = items[i].func;
+        it->src = -1;
+        it->type = COL_INT;
+        if (it->func == AGG_MIN || it->func == AGG_MAX) {
+            printf("Error: %s cannot be kept up to date in a materialized view.\n", item_name(it->func));
+            return 0;
+        }
+        if (it->func != AGG_COUNT || strcmp(items[i].column, "*") != 0) {
+            it->src = column_index(t, items[i].column);
+            if (it->src < 0) {
+                printf("Error: unknown column '%s'.\n", items[i].column);
+                return 0;
+            }
+            it->type = t->columns[it->src].type;
+        }
+        if ((it->func == AGG_SUM || it->func == AGG_AVG) && it->type == COL_TEXT) {
+            printf("Error: %s needs a numeric column; '%s' is TEXT.\n", item_name(it->func), items[i].column);
+            return 0;
+        }
+        if (it->func == AGG_NONE) {
+            int grouped = 0;
+            for (int j = 0; j < v->num_group; j++) {
+                if (v->group_cols[j] != it->src) continue;
+                grouped = 1;
+                if (v->key_cols[j] < 0) v->key_cols[j] = i;
+            }
+            if (!grouped) {
+                printf("Error: column '%s' must appear in GROUP BY or inside an aggregate.\n",
+                       items[i].column);
+                return 0;
+            }
+        }
+
+        ColumnDef* d = &defs[i];
+        d->type = it->func == AGG_COUNT ? COL_INT : it->func == AGG_AVG ? COL_FLOAT : it->type;
+        if (names && names[i]) {
+            snprintf(d->name, sizeof(d->name), "%s", names[i]);
+        } else if (it->func == AGG_NONE) {
+            snprintf(d->name, sizeof(d->name), "%s", items[i].column);
+        } else if (it->src < 0) {
+            snprintf(d->name, sizeof(d->name), "count");
+        } else {
+            // count_x, sum_x, avg_x: a name WHERE and ORDER BY can refer to
+            snprintf(d->name, sizeof(d->name), "%s_%.*s", it->func == AGG_COUNT ? "count" :
+                     it->func == AGG_SUM ? "sum" : "avg", MAX_NAME_LEN - 7, items[i].column);
+        }
+        for (int j = 0; j < i; j++) {
+            if (strcmp(defs[j].name, d->name) == 0) {
+                printf("Error: duplicate column '%s' in view; name one with AS.\n", d->name);
+                return 0;
+            }
+        }
+    }
+    for (int i = 0; i < v->num_group; i++) {
+        if (v->key_cols[i] < 0) {
+            printf("Error: GROUP BY column '%s' must also be selected by the view.\n", group_cols[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void view_free(MatView* v) {
+    if (!v) return;
+    free_table(&v->table);
+    free(v->items);
+    free(v->group_cols);
+    free(v->key_cols);
+    free(v->rows);
+    free(v->accs);
+    free(v->hashes);
+    free(v->next);
+    free(v->heads);
+    free(v);
+}
+
+//Adds p to a growable pointer list; 0 on out of memory
+static int list_add(MatView*** list, int* n, MatView* p) {
+    MatView** tmp = realloc(*list, sizeof(MatView*) * (size_t)(*n + 1));
+    if (!tmp) return 0;
+    tmp[(*n)++] = p;
+    *list = tmp;
+    return 1;
+}
+
+static void list_remove(MatView*** list, int* n, const MatView* p) {
+    for (int i = 0; i < *n; i++) {
+        if ((*list)[i] != p) continue;
+        memmove(&(*list)[i], &(*list)[i + 1], sizeof(MatView*) * (size_t)(*n - i - 1));
+        if (--*n == 0) {
+            free(*list);
+            *list = NULL;
+        }
+        return;
+    }
+}
+
+int create_view(Database* db, const char* name, const char* base, const SelectItem* items, char** names,
+                int num_items, char** group_cols, int num_group) {
+    if (find_table(db, name)) {
+        printf("Error: table '%s' already exists.\n", name);
+        return 0;
+    }
+    Table* t = find_table(db, base);
+    if (!t) {
+        printf("Error: table '%s' not found.\n", base);
+        return 0;
+    }
+    if (t->view) {
+        printf("Error: '%s' is a materialized view; a view must read a table.\n", base);
+        return 0;
+    }
+    if (num_group == 0 || num_items == 0) {
+        printf("Error: a materialized view needs GROUP BY.\n");
+        return 0;
+    }
+
+    MatView* v = calloc(1, sizeof(MatView));
+    ColumnDef* defs = calloc((size_t)num_items, sizeof(ColumnDef));
+    if (!v || !defs) {
+        free(v);
+        free(defs);
+        fprintf(stderr, "Out of memory creating view '%s'.\n", name);
+        return 0;
+    }
+    Table* vt = &v->table;
+    snprintf(vt->name, sizeof(vt->name), "%s", name);
+    snprintf(v->base, sizeof(v->base), "%s", base);
+    vt->view = v;
+    vt->columns = defs;
+    vt->num_columns = num_items;
+    vt->column_major = 1;
+    arena_init(&vt->arena);
+    v->num_group = num_group;
+    v->items = malloc(sizeof(ViewItem) * (size_t)num_items);
+    v->group_cols = malloc(sizeof(int) * (size_t)num_group);
+    v->key_cols = malloc(sizeof(int) * (size_t)num_group);
+    vt->column_data = calloc((size_t)num_items, sizeof(ColumnStorage));
+    if (!v->items || !v->group_cols || !v->key_cols || !vt->column_data) {
+        view_free(v);
+        fprintf(stderr, "Out of memory creating view '%s'.\n", name);
+        return 0;
+    }
+    if (!resolve_view(v, t, items, names, num_items, group_cols, defs)) {
+        view_free(v);
+        return 0;
+    }
+    for (int c = 0; c < num_items; c++) {
+        strncpy(vt->column_data[c].name, defs[c].name, MAX_NAME_LEN - 1);
+        vt->column_data[c].type = defs[c].type;
+    }
+
+    // One pass over the base table builds every group
+    int ok = grow_buckets(v);
+    for (int r = 0; ok && r < t->num_rows; r++) {
+        if (!table_row_deleted(t, r)) ok = view_apply(v, t, r, 1);
+    }
+    if (!ok || !list_add(&db->views, &db->num_views, v)) {
+        view_free(v);
+        fprintf(stderr, "Out of memory creating view '%s'.\n", name);
+        return 0;
+    }
+    if (!list_add(&t->views, &t->num_views, v)) {
+        list_remove(&db->views, &db->num_views, v);
+        view_free(v);
+        fprintf(stderr, "Out of memory creating view '%s'.\n", name);
+        return 0;
+    }
+    db->schema_version++;
+    return 1;
+}
+
+int drop_view(Database* db, const char* name) {
+    for (int i = 0; i < db->num_views; i++) {
+        MatView* v = db->views[i];
+        if (strcmp(v->table.name, name) != 0) continue;
+        Table* t = find_table(db, v->base);
+        if (t) list_remove(&t->views, &t->num_views, v);
+        list_remove(&db->views, &db->num_views, v);
+        view_free(v);
+        db->schema_version++;
+        printf("Materialized view '%s' dropped.\n", name);
+        return 1;
+    }
+    printf("Error: materialized view '%s' not found.\n", name);
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   WHERE PROGRAM — AND / OR / NOT compiled to a flat instruction list
+   ============================================================
+   The parser hands over an Expr tree. Compiling resolves every column
+   once, converts every literal to the column type (a Predicate) and
+   flattens the tree into a short program over a single boolean
+   accumulator: TEST loads a predicate's verdict, NOT flips it, and AND/OR
+   become conditional jumps past their right operand, so evaluation
+   short-circuits without recursion or per-row name lookups.
+
+   A program made of ANDs alone is marked conjunctive: the pipeline then
+   skips the interpreter and lets each predicate compact the batch's
+   selection vector in turn, so later predicates only read the rows that
+   survived the earlier ones. The order they run in is the planner's
+   (plan_order); it starts out as written. */
+
+void expr_free(Expr* e) {
+    if (!e) return;
+    expr_free(e->left);
+    expr_free(e->right);
+    free(e);
+}
+
+/* ===== Predicates ===== */
+
+static int is_point(const KeyRange* r) {
+    return r->has_lo && r->has_hi && r->lo_incl && r->hi_incl && value_equals(&r->lo, &r->hi);
+}
+
+int predicate_prepare(const Table* t, int col, const KeyRange* range, Predicate* p) {
+    memset(p, 0, sizeof(Predicate));
+    p->col = col;
+    p->type = t->columns[col].type;
+    p->range = *range;
+    p->invert = range->exclude;
+    p->dict_code = -1;
+
+    const KeyRange* r = &p->range;
+    switch (p->type) {
+        case COL_INT:
+            // Exclusive bounds become inclusive ones on the integer line
+            p->ilo = INT64_MIN;
+            p->ihi = INT64_MAX;
+            if (r->has_lo) {
+                if (!r->lo_incl && r->lo.i == INT64_MAX) p->empty = 1;
+                else p->ilo = r->lo_incl ? r->lo.i : r->lo.i + 1;
+            }
+            if (r->has_hi) {
+                if (!r->hi_incl && r->hi.i == INT64_MIN) p->empty = 1;
+                else p->ihi = r->hi_incl ? r->hi.i : r->hi.i - 1;
+            }
+            break;
+        case COL_FLOAT:
+            p->flo = -INFINITY;
+            p->fhi = INFINITY;
+            if (r->has_lo) p->flo = r->lo_incl ? r->lo.f : nextafter(r->lo.f, INFINITY);
+            if (r->has_hi) p->fhi = r->hi_incl ? r->hi.f : nextafter(r->hi.f, -INFINITY);
+            break;
+        default: {
+            const ColumnStorage* cs = &t->column_data[col];
+            if (!t->column_major || !cs->dict) break;
+            if (is_point(r)) {
+                // Equality: resolve the literal to its code once
+                p->dict_code = dict_lookup(cs->dict, r->lo.s);
+                if (p->dict_code < 0) {
+                    // An unknown string: = matches nothing, <> every live row
+                    if (p->invert) p->all = 1;
+                    else p->empty = 1;
+                }
+                break;
+            }
+            // Decide each distinct string once, then compare codes
+            p->dict_hit = malloc((size_t)(cs->dict->count > 0 ? cs->dict->count : 1));
+            if (!p->dict_hit) return 0;
+            for (int c = 0; c < cs->dict->count; c++) {
+                Value dv = { COL_TEXT, 0, 0.0, cs->dict->strings[c] };
+                p->dict_hit[c] = (unsigned char)value_in_range(&dv, r);
+            }
+            break;
+        }
+    }
+    return 1;
+}
+
+void predicate_free(Predicate* p) {
+    free(p->dict_hit);
+    p->dict_hit = NULL;
+}
+
+int predicate_test_row(const Table* t, const Predicate* p, int row) {
+    if (p->empty) return 0;
+    if (p->all) return 1;
+    const ColumnStorage* cs = t->column_major ? &t->column_data[p->col] : NULL;
+    switch (p->type) {
+        case COL_INT: {
+            int64_t v = 0;
+            if (cs) v = cs->ints[row];
+            else parse_int_value(t->rows[row].values[p->col], &v);
+            return (v >= p->ilo && v <= p->ihi) ^ p->invert;
+        }
+        case COL_FLOAT: {
+            double v = 0.0;
+            if (cs) v = cs->floats[row];
+            else parse_float_value(t->rows[row].values[p->col], &v);
+            return (v >= p->flo && v <= p->fhi) ^ p->invert;
+        }
+        default: {
+            if (cs && cs->dict) {
+                if (p->dict_hit) return p->dict_hit[cs->codes[row]];
+                return ((int)cs->codes[row] == p->dict_code) ^ p->invert;
+            }
+            Value v = { COL_TEXT, 0, 0.0, cs ? cs->values[row] : t->rows[row].values[p->col] };
+            return v.s && value_in_range(&v, &p->range);
+        }
+    }
+}
+
+/* ===== Compiler ===== */
+
+static int count_leaves(const Expr* e) {
+    if (e->kind == EXPR_CMP) return 1;
+    return count_leaves(e->left) + (e->right ? count_leaves(e->right) : 0);
+}
+
+static int count_code(const Expr* e) {
+    switch (e->kind) {
+        case EXPR_CMP: return 1;
+        case EXPR_NOT: return count_code(e->left) + 1;
+        default:       return count_code(e->left) + 1 + count_code(e->right);
+    }
+}
+
+/* The first predicate reachable through AND alone, numbering leaves from
+   first; -1 if there is none. Its matches are a superset of e's. */
+static int find_drive(const Expr* e, int first) {
+    if (e->kind == EXPR_CMP) return first;
+    if (e->kind != EXPR_AND) return -1;
+    int d = find_drive(e->left, first);
+    return d >= 0 ? d : find_drive(e->right, first + count_leaves(e->left));
+}
+
+static int emit(const Table* t, const Expr* e, WhereProgram* prog) {
+    switch (e->kind) {
+        case EXPR_CMP: {
+            int col = column_index((Table*)t, e->cmp.column);
+            if (col < 0) {
+                printf("Error: unknown column '%s' in WHERE.\n", e->cmp.column);
+                return 0;
+            }
+            Predicate* p = &prog->preds[prog->num_preds];
+            KeyRange range;
+            if (!condition_range(t->columns[col].type, &e->cmp, &range)) {
+                // A literal the column type can never hold matches no rows
+                memset(p, 0, sizeof(Predicate));
+                p->col = col;
+                p->type = t->columns[col].type;
+                p->empty = 1;
+            } else if (!predicate_prepare(t, col, &range, p)) {
+                return 0;
+            }
+            prog->code[prog->num_code].op = WOP_TEST;
+            prog->code[prog->num_code].arg = prog->num_preds++;
+            prog->num_code++;
+            return 1;
+        }
+        case EXPR_NOT:
+            if (!emit(t, e->left, prog)) return 0;
+            prog->code[prog->num_code].op = WOP_NOT;
+            prog->code[prog->num_code].arg = 0;
+            prog->num_code++;
+            return 1;
+        default: {
+            if (!emit(t, e->left, prog)) return 0;
+            int jump = prog->num_code++;
+            prog->code[jump].op = e->kind == EXPR_AND ? WOP_JUMP_IF_FALSE : WOP_JUMP_IF_TRUE;
+            if (!emit(t, e->right, prog)) return 0;
+            prog->code[jump].arg = prog->num_code;
+            return 1;
+        }
+    }
+}
+
+int where_compile(const Table* t, const Expr* e, WhereProgram* prog) {
+    memset(prog, 0, sizeof(WhereProgram));
+    int leaves = count_leaves(e);
+    prog->preds = calloc((size_t)leaves, sizeof(Predicate));
+    prog->code = malloc(sizeof(WhereInstr) * (size_t)count_code(e));
+    prog->order = malloc(sizeof(int) * (size_t)leaves);
+    if (!prog->preds || !prog->code || !prog->order || !emit(t, e, prog)) {
+        where_free(prog);
+        return 0;
+    }
+    for (int i = 0; i < leaves; i++) prog->order[i] = i;
+    prog->drive = find_drive(e, 0);
+    prog->conjunctive = 1;
+    for (int pc = 0; pc < prog->num_code; pc++) {
+        if (prog->code[pc].op != WOP_TEST && prog->code[pc].op != WOP_JUMP_IF_FALSE) prog->conjunctive = 0;
+    }
+    return 1;
+}
+
+void where_free(WhereProgram* prog) {
+    for (int i = 0; i < prog->num_preds; i++) predicate_free(&prog->preds[i]);
+    free(prog->preds);
+    free(prog->code);
+    free(prog->order);
+    memset(prog, 0, sizeof(WhereProgram));
+}
+
+/* ===== Evaluation ===== */
+
+int where_eval_row(const Table* t, const WhereProgram* prog, int row) {
+    int acc = 1;
+    const WhereInstr* code = prog->code;
+    for (int pc = 0; pc < prog->num_code; pc++) {
+        switch (code[pc].op) {
+            case WOP_TEST:          acc = predicate_test_row(t, &prog->preds[code[pc].arg], row); break;
+            case WOP_NOT:           acc = !acc; break;
+            case WOP_JUMP_IF_FALSE: if (!acc) pc = code[pc].arg - 1; break;
+            case WOP_JUMP_IF_TRUE:  if (acc) pc = code[pc].arg - 1; break;
+        }
+    }
+    return acc;
+}
+
+void where_filter_batch(const Table* t, const WhereProgram* prog, Batch* b) {
+    int w = 0;
+    for (int k = 0; k < b->count; k++) {
+        int r = b->sel[k];
+        b->sel[w] = r;
+        w += where_eval_row(t, prog, r);
+    }
+    b->count = w;
+}
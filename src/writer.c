@@ -0,0 +1,421 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   RESULT WRITER — result sets formatted into one big buffer
+   ============================================================
+   Every printer (plain SELECT, ORDER BY, aggregates, joins) hands its
+   cells to a ResultWriter instead of calling printf per cell. Cells are
+   formatted straight into a 256 KB buffer, reused from one result to the
+   next, which goes to stdout in a single fwrite whenever it fills and
+   once more at writer_end. Integers are formatted two digits at a time,
+   and floats with up to 15 significant digits take an exact shortcut
+   that prints what %.15g would. Only the rest go through snprintf.
+
+   Output modes (.mode):
+     list    cells separated by " | " (the default)
+     tsv     tab-separated; \, tab, CR and LF escaped as \\ \t \r \n; NULL is \N
+     csv     comma-separated, RFC 4180 quoting; NULL is an empty field
+     binary  length-prefixed, described below
+
+   Binary layout, native byte order like the binary storage format:
+     header  int num_cols, then per column: int type, int len, name bytes
+     cell    int len, then len bytes; len -1 = NULL. INT and FLOAT cells
+             hold the 8 stored bytes of the int64_t / double, and TEXT
+             cells hold the stored string without its terminator
+     end     int -2 after the last row
+   Column-major cells are copied into the buffer straight from the
+   column vectors and dictionaries, with no formatting. Row-major cells
+   are stored as text, so INT and FLOAT cells are parsed once.
+
+   While a capture is running (the result cache on a miss), every byte
+   written out is also appended to the capture, up to its limit. */
+
+#define WRITER_BUF_SIZE (1 << 18)
+#define BINARY_NULL (-1)
+#define BINARY_END (-2)
+
+// One result prints at a time, so every writer shares this buffer
+static char writer_buf[WRITER_BUF_SIZE];
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Output kept for the result cache while active
+static struct {
+    char* data;
+    size_t len, cap;
+    size_t limit;
+    int active;
+    int overflow;   // went past limit or out of memory: nothing to keep
+} capture;
+
+/* ===== Buffer ===== */
+
+static void capture_bytes(const char* s, size_t n) {
+    if (!capture.active || capture.overflow) return;
+    if (capture.len + n > capture.limit) {
+        capture.overflow = 1;
+        return;
+    }
+    if (capture.len + n > capture.cap) {
+        size_t cap = capture.cap ? capture.cap : 4096;
+        while (cap < capture.len + n) cap *= 2;
+        char* tmp = realloc(capture.data, cap);
+        if (!tmp) {
+            capture.overflow = 1;
+            return;
+        }
+        capture.data = tmp;
+        capture.cap = cap;
+    }
+    memcpy(capture.data + capture.len, s, n);
+    capture.len += n;
+}
+
+static void drain(ResultWriter* w) {
+    if (w->len > 0) {
+        fwrite(w->buf, 1, w->len, stdout);
+        capture_bytes(w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+//Room for n more bytes, n <= WRITER_BUF_SIZE
+static char* reserve(ResultWriter* w, size_t n) {
+    if (w->len + n > WRITER_BUF_SIZE) drain(w);
+    return w->buf + w->len;
+}
+
+static void put_bytes(ResultWriter* w, const char* s, size_t n) {
+    if (w->len + n > WRITER_BUF_SIZE) {
+        drain(w);
+        if (n > WRITER_BUF_SIZE) {
+            fwrite(s, 1, n, stdout);
+            capture_bytes(s, n);
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_char(ResultWriter* w, char c) {
+    *reserve(w, 1) = c;
+    w->len++;
+}
+
+static void put_int32(ResultWriter* w, int v) {
+    memcpy(reserve(w, sizeof(int)), &v, sizeof(int));
+    w->len += sizeof(int);
+}
+
+/* ===== Number formatting ===== */
+
+//Decimal digits of u, right-aligned to end; returns where they start
+static char* format_digits(uint64_t u, char* end) {
+    char* p = end;
+    while (u >= 100) {
+        unsigned d = (unsigned)(u % 100) * 2;
+        u /= 100;
+        *--p = digit_pairs[d + 1];
+        *--p = digit_pairs[d];
+    }
+    if (u >= 10) {
+        unsigned d = (unsigned)u * 2;
+        *--p = digit_pairs[d + 1];
+        *--p = digit_pairs[d];
+    } else {
+        *--p = (char)('0' + u);
+    }
+    return p;
+}
+
+//Writes v to out (at least 21 bytes), returns its length
+static size_t format_int(int64_t v, char* out) {
+    char tmp[24];
+    char* end = tmp + sizeof(tmp);
+    char* p = format_digits(v < 0 ? 0 - (uint64_t)v : (uint64_t)v, end);
+    if (v < 0) *--p = '-';
+    size_t n = (size_t)(end - p);
+    memcpy(out, p, n);
+    return n;
+}
+
+/* Writes v to out (at least 32 bytes) exactly as format_float_value
+   would. A value that is the nearest double to some decimal r / 10^k of
+   at most 15 digits prints as that decimal, which is also what %.15g
+   gives back, and %.15g keeps fixed notation from 1e-4 up to 1e15. */
+static size_t format_float(double v, char* out) {
+    double a = fabs(v);
+    if (a >= 1e-4 && a < 1e15) {
+        double scale = 1.0;
+        for (int k = 0; k <= 18 && a * scale < 1e15; k++, scale *= 10.0) {
+            double r = floor(a * scale + 0.5);
+            if (r >= 1e15 || r / scale != a) continue;
+
+            char tmp[40];
+            char* end = tmp + sizeof(tmp);
+            char* p = format_digits((uint64_t)r, end);
+            int digits = (int)(end - p);
+            size_t n = 0;
+            if (v < 0) out[n++] = '-';
+            if (digits <= k) {
+                out[n++] = '0';
+                out[n++] = '.';
+                for (int z = digits; z < k; z++) out[n++] = '0';
+                memcpy(out + n, p, (size_t)digits);
+                n += (size_t)digits;
+            } else {
+                memcpy(out + n, p, (size_t)(digits - k));
+                n += (size_t)(digits - k);
+                if (k > 0) {
+                    out[n++] = '.';
+                    memcpy(out + n, end - k, (size_t)k);
+                    n += (size_t)k;
+                }
+            }
+            if (k > 0) {
+                while (out[n - 1] == '0') n--;
+                if (out[n - 1] == '.') n--;
+            }
+            return n;
+        }
+    } else if (v == 0.0 && !signbit(v)) {
+        out[0] = '0';
+        return 1;
+    }
+    format_float_value(v, out, 32);
+    return strlen(out);
+}
+
+/* ===== Cells ===== */
+
+static int text_mode(const ResultWriter* w) {
+    return w->mode != OUTPUT_BINARY;
+}
+
+static void cell_start(ResultWriter* w) {
+    if (w->col == 0) return;
+    switch (w->mode) {
+        case OUTPUT_TSV:    put_char(w, '\t'); break;
+        case OUTPUT_CSV:    put_char(w, ','); break;
+        case OUTPUT_BINARY: break;
+        default:            put_bytes(w, " | ", 3); break;
+    }
+}
+
+static void cell_end(ResultWriter* w) {
+    if (++w->col < w->num_cols) return;
+    w->col = 0;
+    if (text_mode(w)) put_char(w, '\n');
+}
+
+static void put_tsv(ResultWriter* w, const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        size_t run = strcspn(s + i, "\\\t\r\n");
+        if (run > n - i) run = n - i;
+        put_bytes(w, s + i, run);
+        i += run;
+        if (i == n) break;
+        char esc[2] = { '\\', 'n' };
+        switch (s[i]) {
+            case '\\': esc[1] = '\\'; break;
+            case '\t': esc[1] = 't'; break;
+            case '\r': esc[1] = 'r'; break;
+            default:   break;
+        }
+        put_bytes(w, esc, 2);
+        i++;
+    }
+}
+
+static void put_csv(ResultWriter* w, const char* s, size_t n) {
+    if (strcspn(s, ",\"\r\n") >= n) {
+        put_bytes(w, s, n);
+        return;
+    }
+    put_char(w, '"');
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] == '"') put_char(w, '"');
+        put_char(w, s[i]);
+    }
+    put_char(w, '"');
+}
+
+//A cell's bytes in the current mode, without framing
+static void put_text(ResultWriter* w, const char* s, size_t n) {
+    switch (w->mode) {
+        case OUTPUT_TSV:    put_tsv(w, s, n); break;
+        case OUTPUT_CSV:    put_csv(w, s, n); break;
+        case OUTPUT_BINARY:
+            put_int32(w, (int)n);
+            put_bytes(w, s, n);
+            break;
+        default:            put_bytes(w, s, n); break;
+    }
+}
+
+static void put_null(ResultWriter* w) {
+    switch (w->mode) {
+        case OUTPUT_TSV:    put_bytes(w, "\\N", 2); break;
+        case OUTPUT_CSV:    break;
+        case OUTPUT_BINARY: put_int32(w, BINARY_NULL); break;
+        default:            put_bytes(w, "NULL", 4); break;
+    }
+}
+
+static void put_int(ResultWriter* w, int64_t v) {
+    if (w->mode == OUTPUT_BINARY) {
+        char* p = reserve(w, sizeof(int) + sizeof(v));
+        int n = (int)sizeof(v);
+        memcpy(p, &n, sizeof(int));
+        memcpy(p + sizeof(int), &v, sizeof(v));
+        w->len += sizeof(int) + sizeof(v);
+        return;
+    }
+    w->len += format_int(v, reserve(w, 24));
+}
+
+static void put_float(ResultWriter* w, double v) {
+    if (w->mode == OUTPUT_BINARY) {
+        char* p = reserve(w, sizeof(int) + sizeof(v));
+        int n = (int)sizeof(v);
+        memcpy(p, &n, sizeof(int));
+        memcpy(p + sizeof(int), &v, sizeof(v));
+        w->len += sizeof(int) + sizeof(v);
+        return;
+    }
+    w->len += format_float(v, reserve(w, 32));
+}
+
+/* ===== Writer ===== */
+
+void writer_begin(ResultWriter* w, OutputMode mode, int num_cols) {
+    w->mode = mode;
+    w->buf = writer_buf;
+    w->len = 0;
+    w->num_cols = num_cols;
+    w->col = 0;
+    if (mode == OUTPUT_BINARY) put_int32(w, num_cols);
+}
+
+void writer_column(ResultWriter* w, const char* name, ColumnType type) {
+    if (w->mode == OUTPUT_BINARY) {
+        // Header columns carry their type; the row of names is not repeated
+        put_int32(w, (int)type);
+        put_text(w, name, strlen(name));
+        return;
+    }
+    writer_text(w, name);
+}
+
+void writer_text(ResultWriter* w, const char* s) {
+    cell_start(w);
+    if (s) put_text(w, s, strlen(s));
+    else put_null(w);
+    cell_end(w);
+}
+
+void writer_int(ResultWriter* w, int64_t v) {
+    cell_start(w);
+    put_int(w, v);
+    cell_end(w);
+}
+
+void writer_float(ResultWriter* w, double v) {
+    cell_start(w);
+    put_float(w, v);
+    cell_end(w);
+}
+
+void writer_null(ResultWriter* w) {
+    cell_start(w);
+    put_null(w);
+    cell_end(w);
+}
+
+void writer_value(ResultWriter* w, const Value* v) {
+    switch (v->type) {
+        case COL_INT:   writer_int(w, v->i); break;
+        case COL_FLOAT: writer_float(w, v->f); break;
+        default:        writer_text(w, v->s); break;
+    }
+}
+
+void writer_cell(ResultWriter* w, const Table* t, int row, int col) {
+    if (t->column_major) {
+        const ColumnStorage* cs = &t->column_data[col];
+        switch (cs->type) {
+            case COL_INT:   writer_int(w, cs->ints[row]); return;
+            case COL_FLOAT: writer_float(w, cs->floats[row]); return;
+            default:
+                writer_text(w, cs->dict ? cs->dict->strings[cs->codes[row]] : cs->values[row]);
+                return;
+        }
+    }
+    const char* s = t->rows[row].values[col];
+    ColumnType type = t->columns[col].type;
+    if (w->mode != OUTPUT_BINARY || !s || type == COL_TEXT) {
+        writer_text(w, s);
+        return;
+    }
+    int64_t i;
+    double f;
+    if (type == COL_INT && parse_int_value(s, &i)) writer_int(w, i);
+    else if (type == COL_FLOAT && parse_float_value(s, &f)) writer_float(w, f);
+    else writer_null(w);
+}
+
+void writer_end(ResultWriter* w) {
+    if (w->mode == OUTPUT_BINARY) put_int32(w, BINARY_END);
+    drain(w);
+}
+
+void writer_capture_start(size_t limit) {
+    capture.len = 0;
+    capture.limit = limit;
+    capture.active = 1;
+    capture.overflow = 0;
+}
+
+char* writer_capture_take(size_t* len) {
+    capture.active = 0;
+    if (capture.overflow || capture.len == 0) return NULL;
+    char* data = capture.data;
+    *len = capture.len;
+    capture.data = NULL;
+    capture.len = 0;
+    capture.cap = 0;
+    return data;
+}
+
+const char* output_mode_name(OutputMode mode) {
+    switch (mode) {
+        case OUTPUT_TSV:    return "tsv";
+        case OUTPUT_CSV:    return "csv";
+        case OUTPUT_BINARY: return "binary";
+        default:            return "list";
+    }
+}
+
+int parse_output_mode(const char* s) {
+    if (strcmp(s, "list") == 0) return OUTPUT_LIST;
+    if (strcmp(s, "tsv") == 0) return OUTPUT_TSV;
+    if (strcmp(s, "csv") == 0) return OUTPUT_CSV;
+    if (strcmp(s, "binary") == 0) return OUTPUT_BINARY;
+    return -1;
+}
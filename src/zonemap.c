@@ -0,0 +1,152 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "miniqlite.h"
+
+/* ============================================================
+   ZONE MAPS — per-block min/max for column-major numeric columns
+   ============================================================
+   Every ZONE_ROWS rows of an INT or FLOAT vector share one summary. Appends
+   widen it, while UPDATE and DELETE recompute the touched blocks from their
+   live rows, so the bounds stay exact. Scans skip a block when its range
+   cannot overlap the predicate or it holds no live rows. A NaN compares
+   neither below nor above anything, so a FLOAT block holding one keeps NaN
+   bounds and is never skipped. */
+
+static int is_zoned(const ColumnStorage* col) {
+    return col->type == COL_INT || col->type == COL_FLOAT;
+}
+
+/* Folds v into a FLOAT block. Once a NaN is in, the bounds stay NaN until
+   the block is recomputed. */
+static void fold_float(ZoneMap* z, double v) {
+    if (z->live == 0 || isnan(v)) {
+        z->fmin = z->fmax = v;
+    } else {
+        if (v < z->fmin) z->fmin = v;
+        if (v > z->fmax) z->fmax = v;
+    }
+}
+
+int zone_block_count(int num_rows) {
+    return (num_rows + ZONE_ROWS - 1) / ZONE_ROWS;
+}
+
+int zone_reserve(ColumnStorage* col, int capacity) {
+    if (!is_zoned(col)) return 1;
+    int blocks = zone_block_count(capacity);
+    if (blocks < 1) blocks = 1;
+    ZoneMap* tmp = realloc(col->zones, sizeof(ZoneMap) * (size_t)blocks);
+    if (!tmp) return 0;
+    col->zones = tmp;
+    return 1;
+}
+
+void zone_note_row(ColumnStorage* col, int row) {
+    if (!is_zoned(col)) return;
+    ZoneMap* z = &col->zones[row / ZONE_ROWS];
+    if (row % ZONE_ROWS == 0) {
+        // First row of a new block
+        memset(z, 0, sizeof(ZoneMap));
+        if (col->type == COL_INT) {
+            z->imin = z->imax = col->ints[row];
+        } else {
+            z->fmin = z->fmax = col->floats[row];
+        }
+        z->live = 1;
+        return;
+    }
+    if (col->type == COL_INT) {
+        int64_t v = col->ints[row];
+        if (z->live == 0 || v < z->imin) z->imin = v;
+        if (z->live == 0 || v > z->imax) z->imax = v;
+    } else {
+        fold_float(z, col->floats[row]);
+    }
+    z->live++;
+}
+
+/* Unlike zone_note_row this never starts a block over or counts a new row:
+   the bounds only grow, so they may be looser than the live rows but
+   never skip one. */
+void zone_widen(ColumnStorage* col, int row) {
+    if (!is_zoned(col)) return;
+    ZoneMap* z = &col->zones[row / ZONE_ROWS];
+    if (col->type == COL_INT) {
+        int64_t v = col->ints[row];
+        if (z->live == 0 || v < z->imin) z->imin = v;
+        if (z->live == 0 || v > z->imax) z->imax = v;
+    } else {
+        fold_float(z, col->floats[row]);
+    }
+    if (z->live == 0) z->live = 1;
+}
+
+void zone_refresh_block(const Table* t, int c, int block) {
+    ColumnStorage* col = &t->column_data[c];
+    if (!is_zoned(col)) return;
+    ZoneMap* z = &col->zones[block];
+    memset(z, 0, sizeof(ZoneMap));
+    int end = (block + 1) * ZONE_ROWS;
+    if (end > t->num_rows) end = t->num_rows;
+    for (int r = block * ZONE_ROWS; r < end; r++) {
+        if (table_row_deleted(t, r)) continue;
+        if (col->type == COL_INT) {
+            int64_t v = col->ints[r];
+            if (z->live == 0 || v < z->imin) z->imin = v;
+            if (z->live == 0 || v > z->imax) z->imax = v;
+        } else {
+            fold_float(z, col->floats[r]);
+        }
+        z->live++;
+    }
+}
+
+void table_rebuild_zones(Table* t) {
+    if (!t->column_major) return;
+    int blocks = zone_block_count(t->num_rows);
+    for (int c = 0; c < t->num_columns; c++) {
+        for (int b = 0; b < blocks; b++) zone_refresh_block(t, c, b);
+    }
+}
+
+void table_refresh_zones(Table* t, int only_col, const int* rows, int n) {
+    if (!t->column_major || n == 0) return;
+    int blocks = zone_block_count(t->num_rows);
+    unsigned char* touched = calloc((size_t)blocks, 1);
+    if (!touched) {
+        // Without the scratch map, refresh everything
+        table_rebuild_zones(t);
+        return;
+    }
+    for (int k = 0; k < n; k++) touched[rows[k] / ZONE_ROWS] = 1;
+    for (int c = 0; c < t->num_columns; c++) {
+        if (only_col >= 0 && c != only_col) continue;
+        for (int b = 0; b < blocks; b++) {
+            if (touched[b]) zone_refresh_block(t, c, b);
+        }
+    }
+    free(touched);
+}
+
+int zone_may_match(const ColumnStorage* col, int block, const KeyRange* range) {
+    const ZoneMap* z = &col->zones[block];
+    if (z->live == 0) return 0;
+    if (col->type == COL_FLOAT && isnan(z->fmin)) return 1;
+    Value zmin = { col->type, z->imin, z->fmin, NULL };
+    Value zmax = { col->type, z->imax, z->fmax, NULL };
+    if (range->exclude) {
+        // Only a block holding nothing but the excluded value is ruled out
+        return !(value_equals(&zmin, &range->lo) && value_equals(&zmax, &range->lo));
+    }
+    if (range->has_lo) {
+        int c = value_compare(&zmax, &range->lo);
+        if (c < 0 || (c == 0 && !range->lo_incl)) return 0;
+    }
+    if (range->has_hi) {
+        int c = value_compare(&zmin, &range->hi);
+        if (c > 0 || (c == 0 && !range->hi_incl)) return 0;
+    }
+    return 1;
+}
@@ -2,8 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <inttypes.h>
 #include "miniqlite.h"
 
+#define LOAD_BATCH_ROWS 1024
+// Binary files start "MINIQLITE <n> BINARY"; each version changes the table blob
+#define BINARY_VERSION_LAYOUT 2  // layout int and typed column vectors
+#define BINARY_VERSION_FLAGS 3   // per-column flags and dictionary blocks
+#define BINARY_VERSION_ZONES 4   // ZoneMap array after each numeric vector
+#define BINARY_VERSION_NO_ZONES 5 // no ZoneMap arrays; zones are rebuilt on load
+#define BINARY_FORMAT_VERSION BINARY_VERSION_NO_ZONES
+#define VIEW_MAX_ITEMS 64        // GROUP BY columns or result columns on a VIEW line, as the parser allows
+
 /* ============================================================
    VARIADIC LOGGER — db_log()
    ============================================================ */
@@ -25,6 +35,170 @@ void db_log(const char* fmt, ...) {
     fclose(f);
 }
 
+/* ============================================================
+   CATALOG TRAILER — text lines after the last table, both formats
+   ============================================================
+     INDEX <name> <table> <column> <kind>
+     STATS <table> <column> <rows> <count> <ndv> <buckets>[\t<min>\t<max>\t<bound>...]
+     VIEW <name> <table> <groups> <column>... <items> { <COLUMN|COUNT|SUM|AVG> <column|*> <name> }...
+   Index and view contents are not stored; they are rebuilt from the loaded rows.
+   UNIQUE/PRIMARY KEY indexes are not listed: they follow the column flags.
+   STATS lines carry ANALYZE results as they were; the values (present when
+   count > 0) are tab-separated text. A line that does not read back
+   cleanly leaves its column unanalyzed. */
+
+static const char* index_kind_to_string(int kind) {
+    return kind == INDEX_BTREE ? "BTREE" : "HASH";
+}
+
+static const char* view_func_to_string(AggFunc func) {
+    switch (func) {
+        case AGG_COUNT: return "COUNT";
+        case AGG_SUM:   return "SUM";
+        case AGG_AVG:   return "AVG";
+        default:        return "COLUMN";
+    }
+}
+
+static void save_stats(const Table* t, FILE* f) {
+    char buf[64];
+    for (int c = 0; c < t->num_columns; c++) {
+        const ColumnStats* s = &t->stats[c];
+        if (!s->analyzed) continue;
+        fprintf(f, "STATS %s %s %" PRId64 " %" PRId64 " %" PRId64 " %d", t->name, t->columns[c].name,
+                t->stats_rows, s->count, s->ndv, s->num_bounds);
+        if (s->count > 0) {
+            fprintf(f, "\t%s", value_text(&s->min, buf, sizeof(buf)));
+            fprintf(f, "\t%s", value_text(&s->max, buf, sizeof(buf)));
+            for (int i = 0; i < s->num_bounds; i++) fprintf(f, "\t%s", value_text(&s->bounds[i], buf, sizeof(buf)));
+        }
+        fprintf(f, "\n");
+    }
+}
+
+static void save_catalog(Database* db, FILE* f) {
+    for (int i = 0; i < db->num_tables; i++) {
+        Table* t = &db->tables[i];
+        for (int j = 0; j < t->num_indexes; j++) {
+            Index* ix = &t->indexes[j];
+            if (ix->unique) continue;  // recreated from the column flags
+            fprintf(f, "INDEX %s %s %s %s\n", ix->name, t->name,
+                    t->columns[ix->column].name, index_kind_to_string(ix->kind));
+        }
+        if (t->stats) save_stats(t, f);
+    }
+    for (int i = 0; i < db->num_views; i++) {
+        const MatView* v = db->views[i];
+        const Table* t = find_table(db, v->base);
+        fprintf(f, "VIEW %s %s %d", v->table.name, v->base, v->num_group);
+        for (int g = 0; g < v->num_group; g++) fprintf(f, " %s", t->columns[v->group_cols[g]].name);
+        fprintf(f, " %d", v->table.num_columns);
+        for (int c = 0; c < v->table.num_columns; c++) {
+            const ViewItem* it = &v->items[c];
+            fprintf(f, " %s %s %s", view_func_to_string(it->func),
+                    it->src < 0 ? "*" : t->columns[it->src].name, v->table.columns[c].name);
+        }
+        fprintf(f, "\n");
+    }
+}
+
+/* Reads one tab-separated stats value into v; 0 if it is missing or bad. */
+static int read_stats_value(char** p, ColumnType type, Value* v) {
+    if (**p != '\t') return 0;
+    char* field = *p + 1;
+    size_t len = strcspn(field, "\t");
+    char saved = field[len];
+    field[len] = '\0';
+    *p = field + len;
+    int ok;
+    if (type == COL_TEXT) {
+        v->type = COL_TEXT;
+        v->s = str_duplicate(field);
+        ok = v->s != NULL;
+    } else {
+        ok = value_parse(type, field, v);
+        v->s = NULL;
+    }
+    field[len] = saved;
+    return ok;
+}
+
+static void load_stats(Database* db, char* line) {
+    char tname[MAX_NAME_LEN], cname[MAX_NAME_LEN];
+    int64_t rows, count, ndv;
+    int buckets, used = 0;
+    if (sscanf(line, "STATS %63s %63s %" SCNd64 " %" SCNd64 " %" SCNd64 " %d%n",
+               tname, cname, &rows, &count, &ndv, &buckets, &used) != 6) return;
+    Table* t = find_table(db, tname);
+    int c = t ? column_index(t, cname) : -1;
+    if (c < 0 || buckets < 0 || buckets > STATS_BUCKETS) return;
+
+    char* p = line + used;
+    p[strcspn(p, "\r\n")] = '\0';
+    ColumnType type = t->columns[c].type;
+    ColumnStats s;
+    memset(&s, 0, sizeof(ColumnStats));
+    s.count = count;
+    s.ndv = ndv;
+    s.num_bounds = buckets;
+    int ok = 1;
+    if (count > 0) {
+        ok = read_stats_value(&p, type, &s.min) && read_stats_value(&p, type, &s.max);
+        for (int i = 0; ok && i < buckets; i++) ok = read_stats_value(&p, type, &s.bounds[i]);
+    }
+    ColumnStats* all = ok && *p == '\0' ? stats_reserve(t) : NULL;
+    if (!all) {
+        stats_clear_column(&s);
+        return;
+    }
+    s.analyzed = 1;
+    stats_clear_column(&all[c]);
+    all[c] = s;
+    t->stats_rows = rows;
+}
+
+/* Recreates a view from its VIEW line; a malformed line is skipped. */
+static void load_view(Database* db, char* line) {
+    char* tok[4 + VIEW_MAX_ITEMS + 1 + 3 * VIEW_MAX_ITEMS];
+    int n = 0;
+    for (char* p = strtok(line, " \r\n"); p && n < (int)(sizeof(tok) / sizeof(tok[0])); p = strtok(NULL, " \r\n")) {
+        tok[n++] = p;
+    }
+    int64_t num_group = 0, num_items = 0;
+    if (n < 4 || !parse_int_value(tok[3], &num_group) || num_group < 1 || num_group > VIEW_MAX_ITEMS ||
+        n < 5 + num_group || !parse_int_value(tok[4 + num_group], &num_items) || num_items < 1 ||
+        num_items > VIEW_MAX_ITEMS || n != 5 + num_group + 3 * num_items) {
+        return;
+    }
+    SelectItem items[VIEW_MAX_ITEMS];
+    char* names[VIEW_MAX_ITEMS];
+    char** items_tok = &tok[5 + num_group];
+    for (int i = 0; i < num_items; i++) {
+        memset(&items[i], 0, sizeof(SelectItem));
+        const char* fn = items_tok[3 * i];
+        items[i].func = strcmp(fn, "COUNT") == 0 ? AGG_COUNT : strcmp(fn, "SUM") == 0 ? AGG_SUM :
+                        strcmp(fn, "AVG") == 0 ? AGG_AVG : AGG_NONE;
+        strncpy(items[i].column, items_tok[3 * i + 1], MAX_NAME_LEN - 1);
+        names[i] = items_tok[3 * i + 2];
+    }
+    create_view(db, tok[1], tok[2], items, names, (int)num_items, &tok[4], (int)num_group);
+}
+
+static void load_catalog(Database* db, FILE* f) {
+    char line[8192];
+    while (fgets(line, sizeof(line), f)) {
+        char iname[MAX_NAME_LEN], tname[MAX_NAME_LEN], cname[MAX_NAME_LEN], kind[16];
+        if (sscanf(line, "INDEX %63s %63s %63s %15s", iname, tname, cname, kind) == 4) {
+            create_index(db, iname, tname, cname,
+                         strcmp(kind, "BTREE") == 0 ? INDEX_BTREE : INDEX_HASH);
+        } else if (strncmp(line, "STATS ", 6) == 0) {
+            load_stats(db, line);
+        } else if (strncmp(line, "VIEW ", 5) == 0) {
+            load_view(db, line);
+        }
+    }
+}
+
 int save_database(Database* db, const char* filename) {
     FILE* f = fopen(filename, db -> binary_mode? "wb":"w");
     if (!f) {
@@ -32,11 +206,16 @@ int save_database(Database* db, const char* filename) {
         return 0;
     }
 
-    fprintf(f, "MINIQLITE 1\n");
+    if (db->binary_mode) {
+        fprintf(f, "MINIQLITE %d BINARY\n", BINARY_FORMAT_VERSION);
+    } else {
+        fprintf(f, "MINIQLITE 1\n");
+    }
     fprintf(f, "TABLE_COUNT %d\n", db->num_tables);
 
     for (int i = 0; i < db->num_tables; i++) {
         Table* t = &db->tables[i];
+        // Only live rows are written; tombstoned ones are skipped in place
         if (db->binary_mode){
             // Write a binary table blob. Do not emit text TABLE/COLUMN/ROW lines.
             if (!save_table_binary(t, f)) {
@@ -45,34 +224,183 @@ int save_database(Database* db, const char* filename) {
             }
         }
         else {
-            fprintf(f, "TABLE %s %d %d\n", t->name, t->num_columns, t->num_rows);
+            fprintf(f, "TABLE %s %d %d %s\n", t->name, t->num_columns, t->num_rows - t->num_deleted,
+                    t->column_major ? "COLUMN" : "ROW");
 
             for (int c = 0; c < t->num_columns; c++) {
-                fprintf(f, "COLUMN %s %s\n",
+                int flags = t->columns[c].flags;
+                fprintf(f, "COLUMN %s %s%s%s\n",
                         t->columns[c].name,
-                        column_type_to_string(t->columns[c].type));
+                        column_type_to_string(t->columns[c].type),
+                        (flags & COLUMN_DICT) ? " DICT" : "",
+                        (flags & COLUMN_PRIMARY_KEY) ? " PRIMARY KEY" :
+                        (flags & COLUMN_UNIQUE) ? " UNIQUE" : "");
             }
 
+            char buf[64];
             for (int r = 0; r < t->num_rows; r++) {
+                if (table_row_deleted(t, r)) continue;
                 fprintf(f, "ROW");
                 for (int c = 0; c < t->num_columns; c++) {
-                    fprintf(f, "\t%s", t->rows[r].values[c] ? t->rows[r].values[c] : "");
+                    if (t->column_major) {
+                        fprintf(f, "\t%s", column_cell_text(&t->column_data[c], r, buf, sizeof(buf)));
+                    } else {
+                        fprintf(f, "\t%s", t->rows[r].values[c] ? t->rows[r].values[c] : "");
+                    }
                 }
                 fprintf(f, "\n");
             }
         }
     }
 
+    save_catalog(db, f);
     fclose(f);
     return 1;
 }
 
+/* Binary table blob:
+     name[MAX_NAME_LEN], num_columns, { name[MAX_NAME_LEN], type, flags } * num_columns,
+     num_rows, layout (0 = row cells, 1 = column vectors), payload. Only live
+   rows are written, so num_rows excludes tombstones. Version 1 blobs have no
+   layout and always hold row cells; before version 3 columns carry no flags.
+   Row cells are (len, bytes) per cell in row order. Column vectors are written
+   column by column: INT/FLOAT columns as one raw int64_t/double array, TEXT
+   columns as (len, bytes) per cell. DICT columns write the dictionary
+   (count, then (len, bytes) per entry) followed by a code width of 1, 2 or
+   4 bytes and the packed codes. In version 4 only, each INT/FLOAT vector is
+   followed by its raw ZoneMap array, one entry per ZONE_ROWS rows; loaders
+   skip it and rebuild the zones from the data. */
+static int write_text_cell(const char* val, FILE* f) {
+    int len = (int)strlen(val);
+    if (fwrite(&len, sizeof(int), 1, f) != 1) return 0;
+    if (len > 0) {
+        if (fwrite(val, 1, len, f) != (size_t)len) return 0;
+    }
+    return 1;
+}
+
+/* Reads one (len, bytes) cell into the table arena, NULL on failure. */
+static char* read_text_cell(Arena* arena, FILE* f) {
+    int len = 0;
+    if (fread(&len, sizeof(int), 1, f) != 1 || len < 0) return NULL;
+    char* buf = arena_alloc_bytes(arena, (size_t)len + 1);
+    if (len > 0 && fread(buf, 1, (size_t)len, f) != (size_t)len) return NULL;
+    buf[len] = '\0';
+    return buf;
+}
+
+static int dict_code_width(int count) {
+    if (count <= 0x100) return 1;
+    if (count <= 0x10000) return 2;
+    return 4;
+}
+
+static int write_dict_column(const ColumnStorage* col, const uint32_t* codes, size_t n, FILE* f) {
+    const TextDict* d = col->dict;
+    if (fwrite(&d->count, sizeof(int), 1, f) != 1) return 0;
+    for (int code = 0; code < d->count; code++) {
+        if (!write_text_cell(d->strings[code], f)) return 0;
+    }
+
+    // Codes are narrowed to the smallest width that holds the dictionary
+    int width = dict_code_width(d->count);
+    if (fwrite(&width, sizeof(int), 1, f) != 1) return 0;
+    if (width == 4) return n == 0 || fwrite(codes, sizeof(uint32_t), n, f) == n;
+    unsigned char buf[4096];
+    size_t per = sizeof(buf) / (size_t)width;
+    for (size_t start = 0; start < n; start += per) {
+        size_t cnt = n - start < per ? n - start : per;
+        for (size_t i = 0; i < cnt; i++) {
+            uint32_t code = codes[start + i];
+            if (width == 1) {
+                buf[i] = (unsigned char)code;
+            } else {
+                uint16_t c16 = (uint16_t)code;
+                memcpy(buf + i * 2, &c16, 2);
+            }
+        }
+        if (fwrite(buf, (size_t)width, cnt, f) != cnt) return 0;
+    }
+    return 1;
+}
+
+/* Reads a dictionary into the arena. Returns the entry array (heap) or NULL. */
+static char** read_dict_strings(Arena* arena, FILE* f, int* out_count) {
+    int count = 0;
+    if (fread(&count, sizeof(int), 1, f) != 1 || count < 0) return NULL;
+    char** strings = malloc(sizeof(char*) * (count > 0 ? (size_t)count : 1));
+    if (!strings) return NULL;
+    for (int code = 0; code < count; code++) {
+        strings[code] = read_text_cell(arena, f);
+        if (!strings[code]) {
+            free(strings);
+            return NULL;
+        }
+    }
+    *out_count = count;
+    return strings;
+}
+
+/* Reads n packed codes, widening them to uint32_t and checking the range. */
+static int read_dict_codes(FILE* f, uint32_t* out, size_t n, int count) {
+    int width = 0;
+    if (fread(&width, sizeof(int), 1, f) != 1) return 0;
+    if (width != 1 && width != 2 && width != 4) return 0;
+    unsigned char buf[4096];
+    size_t per = sizeof(buf) / (size_t)width;
+    for (size_t start = 0; start < n; start += per) {
+        size_t cnt = n - start < per ? n - start : per;
+        if (fread(buf, (size_t)width, cnt, f) != cnt) return 0;
+        for (size_t i = 0; i < cnt; i++) {
+            uint32_t code;
+            if (width == 1) {
+                code = buf[i];
+            } else if (width == 2) {
+                uint16_t c16;
+                memcpy(&c16, buf + i * 2, 2);
+                code = c16;
+            } else {
+                memcpy(&code, buf + i * 4, 4);
+            }
+            if (code >= (uint32_t)count) return 0;
+            out[start + i] = code;
+        }
+    }
+    return 1;
+}
+
+/* Writes a numeric vector or dictionary codes with the tombstoned rows
+   squeezed out. */
+static int write_packed_column(const Table* t, const ColumnStorage* col, FILE* f) {
+    size_t n = (size_t)(t->num_rows - t->num_deleted);
+    size_t width = col->type == COL_TEXT ? sizeof(uint32_t) : sizeof(int64_t);
+    void* vec = malloc(width * (n > 0 ? n : 1));
+    if (!vec) return 0;
+    int64_t* ints = vec;
+    double* floats = vec;
+    uint32_t* codes = vec;
+    size_t w = 0;
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        switch (col->type) {
+            case COL_INT:   ints[w] = col->ints[r]; break;
+            case COL_FLOAT: floats[w] = col->floats[r]; break;
+            default:        codes[w] = col->codes[r]; break;
+        }
+        w++;
+    }
+    int ok = col->type == COL_TEXT ? write_dict_column(col, codes, n, f)
+                                   : n == 0 || fwrite(vec, width, n, f) == n;
+    free(vec);
+    return ok;
+}
+
 int save_table_binary(Table* t, FILE* f) {
     if (!f || !t) return 0;
 
     // Write fixed-size table name block
     char namebuf[MAX_NAME_LEN] = {0};
-    strncpy(namebuf, t->name ? t->name : "", MAX_NAME_LEN-1);
+    strncpy(namebuf, t->name, MAX_NAME_LEN-1);
     if (fwrite(namebuf, 1, MAX_NAME_LEN, f) != MAX_NAME_LEN) return 0;
 
     // number of columns
@@ -81,140 +409,183 @@ int save_table_binary(Table* t, FILE* f) {
     // columns: name (fixed) + type (int)
     for (int i = 0; i < t->num_columns; i++) {
         char colname[MAX_NAME_LEN] = {0};
-        strncpy(colname, t->columns[i].name ? t->columns[i].name : "", MAX_NAME_LEN-1);
+        strncpy(colname, t->columns[i].name, MAX_NAME_LEN-1);
         if (fwrite(colname, 1, MAX_NAME_LEN, f) != MAX_NAME_LEN) return 0;
         if (fwrite(&t->columns[i].type, sizeof(int), 1, f) != 1) return 0;
+        if (fwrite(&t->columns[i].flags, sizeof(int), 1, f) != 1) return 0;
     }
 
-    // number of rows
-    if (fwrite(&t->num_rows, sizeof(int), 1, f) != 1) return 0;
+    // number of live rows and payload layout
+    int live = t->num_rows - t->num_deleted;
+    if (fwrite(&live, sizeof(int), 1, f) != 1) return 0;
+    int layout = t->column_major;
+    if (fwrite(&layout, sizeof(int), 1, f) != 1) return 0;
+
+    if (layout == 1) {
+        // column vectors: numeric columns go out as one contiguous block
+        size_t n = (size_t)live;
+        for (int c = 0; c < t->num_columns; c++) {
+            ColumnStorage* col = &t->column_data[c];
+            if (t->num_deleted > 0 && (col->type != COL_TEXT || col->dict)) {
+                if (!write_packed_column(t, col, f)) return 0;
+            } else if (col->type == COL_INT || col->type == COL_FLOAT) {
+                if (col->type == COL_INT) {
+                    if (n > 0 && fwrite(col->ints, sizeof(int64_t), n, f) != n) return 0;
+                } else {
+                    if (n > 0 && fwrite(col->floats, sizeof(double), n, f) != n) return 0;
+                }
+            } else if (col->dict) {
+                if (!write_dict_column(col, col->codes, n, f)) return 0;
+            } else {
+                for (int r = 0; r < t->num_rows; r++) {
+                    if (table_row_deleted(t, r)) continue;
+                    if (!write_text_cell(col->values[r] ? col->values[r] : "", f)) return 0;
+                }
+            }
+        }
+        return 1;
+    }
 
     // rows: for each cell write length (int) then raw bytes
     for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
         for (int c = 0; c < t->num_columns; c++) {
-            const char* val = (t->rows[r].values[c] ? t->rows[r].values[c] : "");
-            int len = (int)strlen(val);
-            if (fwrite(&len, sizeof(int), 1, f) != 1) return 0;
-            if (len > 0) {
-                if (fwrite(val, 1, len, f) != (size_t)len) return 0;
-            }
+            if (!write_text_cell(t->rows[r].values[c] ? t->rows[r].values[c] : "", f)) return 0;
         }
     }
 
     return 1;
 }
-Table* load_table_binary(FILE* f) {
-    if (!f) return NULL;
+
+/* Reads a column-vector payload straight into the table's column storage.
+   Zone maps are always rebuilt from the loaded data rather than trusted
+   from the file. */
+static int load_column_vectors(Table* t, int num_rows, FILE* f, int version) {
+    size_t n = (size_t)num_rows;
+    size_t blocks = (size_t)zone_block_count(num_rows);
+    if (!table_reserve(t, 1, num_rows)) return 0;
+    for (int c = 0; c < t->num_columns; c++) {
+        ColumnStorage* col = &t->column_data[c];
+        if (col->type == COL_INT || col->type == COL_FLOAT) {
+            if (col->type == COL_INT) {
+                if (n > 0 && fread(col->ints, sizeof(int64_t), n, f) != n) return 0;
+            } else {
+                if (n > 0 && fread(col->floats, sizeof(double), n, f) != n) return 0;
+            }
+            if (version == BINARY_VERSION_ZONES && blocks > 0 &&
+                fseek(f, (long)(sizeof(ZoneMap) * blocks), SEEK_CUR) != 0) return 0;
+        } else if (col->dict) {
+            /* Re-intern the saved dictionary; codes keep their numbering. An
+               out-of-memory or a repeated entry would renumber them, so the
+               stored codes could no longer be trusted. */
+            int count = 0;
+            char** strings = read_dict_strings(&t->arena, f, &count);
+            if (!strings) return 0;
+            for (int code = 0; code < count; code++) {
+                if (dict_intern(col->dict, &t->arena, strings[code]) != code) {
+                    free(strings);
+                    return 0;
+                }
+            }
+            free(strings);
+            if (!read_dict_codes(f, col->codes, n, count)) return 0;
+        } else {
+            for (int r = 0; r < num_rows; r++) {
+                col->values[r] = read_text_cell(&t->arena, f);
+                if (!col->values[r]) return 0;
+            }
+        }
+    }
+    t->num_rows = num_rows;
+    table_rebuild_zones(t);
+    return 1;
+}
+
+int load_table_binary(Database* db, FILE* f, int version) {
+    if (!f) return 0;
 
     // read table name
     char tname[MAX_NAME_LEN] = {0};
-    if (fread(tname, 1, MAX_NAME_LEN, f) != MAX_NAME_LEN) return NULL;
+    if (fread(tname, 1, MAX_NAME_LEN, f) != MAX_NAME_LEN) return 0;
+    tname[MAX_NAME_LEN-1] = '\0';
 
     int num_cols = 0;
-    if (fread(&num_cols, sizeof(int), 1, f) != 1) return NULL;
+    if (fread(&num_cols, sizeof(int), 1, f) != 1 || num_cols <= 0) return 0;
 
     ColumnDef* cols = malloc(sizeof(ColumnDef) * num_cols);
-    if (!cols) return NULL;
+    if (!cols) return 0;
 
     for (int i = 0; i < num_cols; i++) {
         if (fread(cols[i].name, 1, MAX_NAME_LEN, f) != MAX_NAME_LEN) {
             free(cols);
-            return NULL;
+            return 0;
         }
-        if (fread(&cols[i].type, sizeof(int), 1, f) != 1) {
+        cols[i].flags = 0;
+        if (fread(&cols[i].type, sizeof(int), 1, f) != 1 ||
+            (version >= BINARY_VERSION_FLAGS && fread(&cols[i].flags, sizeof(int), 1, f) != 1)) {
             free(cols);
-            return NULL;
+            return 0;
         }
         cols[i].name[MAX_NAME_LEN-1] = '\0';
     }
 
     int num_rows = 0;
-    if (fread(&num_rows, sizeof(int), 1, f) != 1) {
+    int layout = 0;
+    if (fread(&num_rows, sizeof(int), 1, f) != 1 || num_rows < 0 ||
+        (version >= BINARY_VERSION_LAYOUT && fread(&layout, sizeof(int), 1, f) != 1)) {
         free(cols);
-        return NULL;
+        return 0;
     }
 
-    // create table structure
-    Table* t = create_table_struct(cols, num_cols);
-    if (!t) {
-        free(cols);
-        return NULL;
+    create_table(db, tname, cols, num_cols);
+    free(cols);
+    Table* t = find_table(db, tname);
+    if (!t) return 0;
+
+    // Every table is restored in the layout it was saved with
+    t->column_major = layout == 1;
+    if (t->column_major) {
+        if (!load_column_vectors(t, num_rows, f, version)) return 0;
+        return table_rebuild_indexes(t);
     }
 
-    // ensure name copied
-    strncpy(t->name, tname, MAX_NAME_LEN-1);
-    t->name[MAX_NAME_LEN-1] = '\0';
-
-    // Read rows: for each cell read len + bytes, then assign via str_duplicate
+    if (!table_reserve(t, 0, num_rows)) return 0;
     for (int r = 0; r < num_rows; r++) {
-        // prepare temporary vals array
-        char** vals = malloc(sizeof(char*) * num_cols);
-        if (!vals) {
-            free(cols);
-            // Note: not freeing table fully here; caller should manage
-            return t;
-        }
+        // Cells are decoded straight into the arena; no per-cell malloc
+        t->rows[r].values = arena_alloc(&t->arena, sizeof(char*) * (size_t)num_cols);
         for (int c = 0; c < num_cols; c++) {
-            int len = 0;
-            if (fread(&len, sizeof(int), 1, f) != 1) {
-                // cleanup
-                for (int k = 0; k < c; k++) free(vals[k]);
-                free(vals);
-                free(cols);
-                return t;
-            }
-            char* buf = malloc(len + 1);
-            if (!buf) {
-                for (int k = 0; k < c; k++) free(vals[k]);
-                free(vals);
-                free(cols);
-                return t;
-            }
-            if (len > 0) {
-                if (fread(buf, 1, len, f) != (size_t)len) {
-                    free(buf);
-                    for (int k = 0; k < c; k++) free(vals[k]);
-                    free(vals);
-                    free(cols);
-                    return t;
-                }
-            }
-            buf[len] = '\0';
-            vals[c] = str_duplicate(buf);
-            free(buf);
+            t->rows[r].values[c] = read_text_cell(&t->arena, f);
+            if (!t->rows[r].values[c]) return 0;
         }
-
-        // Try to insert into table's row storage. Prefer using existing helper if available.
-        // If insert_row(db, tname, vals, num_cols) is not usable here (no db), attempt to
-        // place values directly if t->rows is allocated.
-        if (t->rows && r < t->num_rows) {
-            for (int c = 0; c < num_cols; c++) {
-                // free any existing value to avoid leak (best-effort)
-                if (t->rows[r].values[c]) free(t->rows[r].values[c]);
-                t->rows[r].values[c] = vals[c];
-            }
-        } else {
-            // best-effort: append by using create/insert helper if available (not used here).
-            // If direct placement was not possible, free the temporary values to avoid leak.
-            for (int c = 0; c < num_cols; c++) free(vals[c]);
-        }
-        free(vals);
+        t->num_rows = r + 1;
     }
 
-    free(cols);
-    t->num_rows = num_rows;
-    return t;
+    // Constraint indexes were created empty with the table
+    return table_rebuild_indexes(t);
 }
 
 int load_database(Database* db, const char* filename) {
-    FILE* f = fopen(filename, "r");
+    FILE* f = fopen(filename, "rb");
     if (!f) {
         // Not an error if file doesn't exist yet.
         return 0;
     }
 
+    // Reloading replaces the tables but keeps the session's storage modes
+    int binary_mode = db->binary_mode;
+    int column_store = db->column_store;
+    OutputMode output_mode = db->output_mode;
+    ResultCache* cache = db->cache;
+    db->cache = NULL;
+    unsigned schema_version = db->schema_version;
     free_database(db);
     init_database(db);
+    db->binary_mode = binary_mode;
+    db->column_store = column_store;
+    db->output_mode = output_mode;
+    db->cache = cache;
+    // Tables are replaced, so prepared statements must resolve again
+    db->schema_version = schema_version + 1;
 
     char line[1024];
 
@@ -226,6 +597,16 @@ int load_database(Database* db, const char* filename) {
         fclose(f);
         return 0;
     }
+    int binary = strstr(line, "BINARY") != NULL;
+    int version = 1;
+    sscanf(line, "MINIQLITE %d", &version);
+    // A newer writer may have changed the table blob in ways this build would misread
+    if (binary && version > BINARY_FORMAT_VERSION) {
+        printf("Error: '%s' uses binary format version %d; this build reads up to %d.\n",
+               filename, version, BINARY_FORMAT_VERSION);
+        fclose(f);
+        return 0;
+    }
 
     if (!fgets(line, sizeof(line), f)) {
         fclose(f);
@@ -238,6 +619,18 @@ int load_database(Database* db, const char* filename) {
         return 0;
     }
 
+    if (binary) {
+        for (int ti = 0; ti < table_count; ti++) {
+            if (!load_table_binary(db, f, version)) {
+                fclose(f);
+                return 0;
+            }
+        }
+        load_catalog(db, f);
+        fclose(f);
+        return 1;
+    }
+
     for (int ti = 0; ti < table_count; ti++) {
         if (!fgets(line, sizeof(line), f)) break;
 
@@ -245,7 +638,8 @@ int load_database(Database* db, const char* filename) {
         int num_cols = 0;
         int num_rows = 0;
 
-        if (sscanf(line, "TABLE %63s %d %d", tname, &num_cols, &num_rows) != 3) {
+        char layout[16] = {0};
+        if (sscanf(line, "TABLE %63s %d %d %15s", tname, &num_cols, &num_rows, layout) < 3) {
             break;
         }
 
@@ -263,7 +657,8 @@ int load_database(Database* db, const char* filename) {
             }
             char colname[MAX_NAME_LEN];
             char typestr[32];
-            if (sscanf(line, "COLUMN %63s %31s", colname, typestr) != 2) {
+            int used = 0;
+            if (sscanf(line, "COLUMN %63s %31s%n", colname, typestr, &used) < 2) {
                 free(cols);
                 fclose(f);
                 return 0;
@@ -271,6 +666,15 @@ int load_database(Database* db, const char* filename) {
             strncpy(cols[c].name, colname, MAX_NAME_LEN - 1);
             cols[c].name[MAX_NAME_LEN - 1] = '\0';
             cols[c].type = parse_column_type(typestr);
+            // Modifiers: DICT, UNIQUE, PRIMARY KEY
+            cols[c].flags = 0;
+            char modstr[32];
+            int n = 0;
+            for (char* m = line + used; sscanf(m, "%31s%n", modstr, &n) == 1; m += n) {
+                if (strcmp(modstr, "DICT") == 0) cols[c].flags |= COLUMN_DICT;
+                else if (strcmp(modstr, "UNIQUE") == 0) cols[c].flags |= COLUMN_UNIQUE;
+                else if (strcmp(modstr, "PRIMARY") == 0) cols[c].flags |= COLUMN_PRIMARY_KEY | COLUMN_UNIQUE;
+            }
         }
 
         create_table(db, tname, cols, num_cols);
@@ -281,25 +685,30 @@ int load_database(Database* db, const char* filename) {
             return 0;
         }
 
-        for (int r = 0; r < num_rows; r++) {
-            if (!fgets(line, sizeof(line), f)) {
-                free(cols);
-                fclose(f);
-                return 0;
-            }
-            if (strncmp(line, "ROW", 3) != 0) {
-                free(cols);
-                fclose(f);
-                return 0;
-            }
+        // Rows are staged in a scratch arena and inserted in batches
+        Arena scratch;
+        arena_init(&scratch);
+        char*** batch = malloc(sizeof(char**) * LOAD_BATCH_ROWS);
+        // Files without a layout token predate per-table layouts: keep the default
+        if (layout[0]) t->column_major = strcmp(layout, "COLUMN") == 0;
+        if (!batch || !table_reserve(t, t->column_major, num_rows)) {
+            free(batch);
+            free(cols);
+            fclose(f);
+            return 0;
+        }
+        int nbatch = 0;
 
-            char** vals = malloc(sizeof(char*) * num_cols);
-            if (!vals) {
+        for (int r = 0; r < num_rows; r++) {
+            if (!fgets(line, sizeof(line), f) || strncmp(line, "ROW", 3) != 0) {
+                arena_free(&scratch);
+                free(batch);
                 free(cols);
                 fclose(f);
                 return 0;
             }
 
+            char** vals = arena_alloc(&scratch, sizeof(char*) * (size_t)num_cols);
             int vc = 0;
             char* p = strchr(line, '\t');
             if (p) {
@@ -309,29 +718,42 @@ int load_database(Database* db, const char* filename) {
                     if (!end) {
                         char* nl = strchr(p, '\n');
                         if (nl) *nl = '\0';
-                        vals[vc++] = str_duplicate(p);
+                        vals[vc++] = arena_strdup(&scratch, p);
                         break;
                     } else {
                         *end = '\0';
-                        vals[vc++] = str_duplicate(p);
+                        vals[vc++] = arena_strdup(&scratch, p);
                         p = end + 1;
                     }
                 }
             }
 
             while (vc < num_cols) {
-                vals[vc++] = str_duplicate("");
+                vals[vc++] = "";
             }
 
-            insert_row(db, tname, vals, num_cols);
-
-            for (int i = 0; i < num_cols; i++) free(vals[i]);
-            free(vals);
+            batch[nbatch++] = vals;
+            if (nbatch == LOAD_BATCH_ROWS || r == num_rows - 1) {
+                // A rejected row would silently drop its whole batch: fail the load
+                if (!insert_rows_quiet(t, batch, nbatch)) {
+                    printf("Error: could not load rows %d-%d of table '%s'.\n",
+                           r - nbatch + 2, r + 1, tname);
+                    arena_free(&scratch);
+                    free(batch);
+                    free(cols);
+                    fclose(f);
+                    return 0;
+                }
+                nbatch = 0;
+                arena_free(&scratch);
+            }
         }
 
+        free(batch);
         free(cols);
     }
 
+    load_catalog(db, f);
     fclose(f);
     return 1;
 }
@@ -0,0 +1,183 @@
+#include <criterion/criterion.h>
+#include "miniqlite.h"
+
+#define NUM_ROWS 3000
+#define NUM_KEYS 23  // few distinct keys, so runs of equal keys span several leaves
+
+static BTreeNode* root;
+static int present[NUM_ROWS];  // 1 while row r is in the tree
+
+static void teardown(void) {
+    btree_free(root);
+    root = NULL;
+}
+
+static int64_t key_of(int row) {
+    return (row * 7) % NUM_KEYS;
+}
+
+static Value int_key(int64_t k) {
+    Value v = { COL_INT, k, 0.0, NULL };
+    return v;
+}
+
+// Inserts every row in a scrambled order
+static void build(void) {
+    for (int k = 0; k < NUM_ROWS; k++) {
+        int row = (k * 1237) % NUM_ROWS;
+        Value v = int_key(key_of(row));
+        btree_insert(&root, &v, row);
+        present[row] = 1;
+    }
+}
+
+static void remove_row(int row) {
+    Value v = int_key(key_of(row));
+    btree_remove(root, &v, row);
+    present[row] = 0;
+}
+
+/* The rows still present in (key, row) order, or its reverse; returns the count. */
+static int expected(int desc, int* out) {
+    int n = 0;
+    for (int64_t k = 0; k < NUM_KEYS; k++) {
+        for (int row = 0; row < NUM_ROWS; row++) {
+            if (present[row] && key_of(row) == k) out[n++] = row;
+        }
+    }
+    for (int i = 0; desc && i < n / 2; i++) {
+        int tmp = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = tmp;
+    }
+    return n;
+}
+
+/* Walks the whole tree max rows at a time and checks it against expected. */
+static void check_walk(int desc, int max) {
+    static int want[NUM_ROWS], got[NUM_ROWS + 64];
+    int n = expected(desc, want);
+    BTreeCursor c;
+    memset(&c, 0, sizeof(c));
+    int total = 0, step;
+    while ((step = btree_walk(root, desc, &c, max, got + total)) > 0) {
+        cr_assert_leq(step, max);
+        total += step;
+        cr_assert_leq(total, n, "desc %d max %d: walk returned too many rows", desc, max);
+    }
+    cr_assert_eq(total, n, "desc %d max %d: %d rows, want %d", desc, max, total, n);
+    for (int i = 0; i < n; i++) {
+        cr_assert_eq(got[i], want[i], "desc %d max %d: position %d", desc, max, i);
+    }
+    // A finished walk stays finished
+    cr_assert_eq(btree_walk(root, desc, &c, max, got), 0);
+}
+
+static void check_both_directions(void) {
+    const int maxes[] = { 1, 3, 64, 65, 1000, NUM_ROWS };
+    for (size_t m = 0; m < sizeof(maxes) / sizeof(maxes[0]); m++) {
+        check_walk(0, maxes[m]);
+        check_walk(1, maxes[m]);
+    }
+}
+
+Test(btree, walk_with_duplicate_keys, .fini = teardown) {
+    build();
+    check_both_directions();
+}
+
+Test(btree, walk_after_removals, .fini = teardown) {
+    build();
+    // Scattered removals, then every row of one key so whole leaves empty out
+    for (int row = 0; row < NUM_ROWS; row += 5) remove_row(row);
+    for (int row = 0; row < NUM_ROWS; row++) {
+        if (key_of(row) == 11 && present[row]) remove_row(row);
+    }
+    check_both_directions();
+
+    // The smallest and largest keys, so the walk starts and ends on empty leaves
+    for (int row = 0; row < NUM_ROWS; row++) {
+        if ((key_of(row) == 0 || key_of(row) == NUM_KEYS - 1) && present[row]) remove_row(row);
+    }
+    check_both_directions();
+
+    // Removing a row twice, or one never inserted, changes nothing
+    remove_row(1);
+    remove_row(1);
+    Value v = int_key(NUM_KEYS + 5);
+    btree_remove(root, &v, 7);
+    check_both_directions();
+}
+
+Test(btree, walk_of_an_emptied_tree, .fini = teardown) {
+    BTreeCursor c;
+    int out[4];
+    memset(&c, 0, sizeof(c));
+    cr_assert_eq(btree_walk(NULL, 1, &c, 4, out), 0);
+
+    build();
+    for (int row = 0; row < NUM_ROWS; row++) remove_row(row);
+    check_walk(0, 10);
+    check_walk(1, 10);
+}
+
+Test(btree, range_over_duplicates, .fini = teardown) {
+    build();
+    for (int row = 0; row < NUM_ROWS; row += 3) remove_row(row);
+    static int want[NUM_ROWS], got[NUM_ROWS];
+    int n = expected(0, want);
+
+    // 5 <= key < 9, in (key, row) order
+    KeyRange r;
+    memset(&r, 0, sizeof(r));
+    r.has_lo = r.lo_incl = 1;
+    r.lo = int_key(5);
+    r.has_hi = 1;
+    r.hi = int_key(9);
+    int count = btree_range(root, &r, -1, got);
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (key_of(want[i]) < 5 || key_of(want[i]) >= 9) continue;
+        cr_assert_lt(k, count);
+        cr_assert_eq(got[k], want[i], "position %d", k);
+        want[k++] = want[i];
+    }
+    cr_assert_eq(count, k);
+
+    // max keeps the first rows of the same order
+    cr_assert_eq(btree_range(root, &r, 10, got), 10);
+    for (int i = 0; i < 10; i++) cr_assert_eq(got[i], want[i]);
+}
+
+static void run(Database* db, const char* sql) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", sql);
+    cr_assert_eq(execute_command(db, buf), 0);
+}
+
+Test(btree, index_walk_follows_deletes_and_updates) {
+    Database db;
+    init_database(&db);
+    run(&db, "CREATE TABLE t (k INT, v INT)");
+    run(&db, "INSERT INTO t VALUES (3, 0), (1, 1), (3, 2), (2, 3), (1, 4), (3, 5), (2, 6)");
+    run(&db, "CREATE INDEX t_k ON t(k) USING BTREE");
+    run(&db, "DELETE FROM t WHERE v = 2");
+    run(&db, "UPDATE t SET k = 0 WHERE v = 6");
+
+    Table* t = find_table(&db, "t");
+    Index* ix = table_find_ordered_index(t, 0);
+    cr_assert_not_null(ix);
+    // Equal keys come out lowest row first ascending and highest row first descending
+    const int asc[] = { 6, 1, 4, 3, 0, 5 };
+    const int desc[] = { 5, 0, 3, 4, 1, 6 };
+    int out[8];
+    for (int d = 0; d < 2; d++) {
+        BTreeCursor c;
+        memset(&c, 0, sizeof(c));
+        int n = 0, step;
+        while ((step = index_ordered_rows(t, ix, d, &c, 2, out + n)) > 0) n += step;
+        cr_assert_eq(n, 6);
+        for (int i = 0; i < n; i++) cr_assert_eq(out[i], d ? desc[i] : asc[i], "desc %d position %d", d, i);
+    }
+    free_database(&db);
+}
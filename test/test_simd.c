@@ -0,0 +1,132 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <string.h>
+#include "miniqlite.h"
+
+#define MAX_N 300   // several mask words, so every tail length 0..63 comes up
+#define MAX_SKEW 7  // start offsets that leave the vectors unaligned
+#define GUARD 0xA5A5A5A5A5A5A5A5ULL
+
+static int64_t ints[MAX_N + MAX_SKEW];
+static double floats[MAX_N + MAX_SKEW];
+static uint32_t codes[MAX_N + MAX_SKEW];
+
+// Values from a small range so every kernel sees matches and misses
+static void fill(void) {
+    srand(12345);
+    for (int i = 0; i < MAX_N + MAX_SKEW; i++) {
+        int r = rand() % 9 - 4;
+        ints[i] = r;
+        floats[i] = r * 0.5;
+        codes[i] = (uint32_t)(r + 4);
+    }
+    ints[3] = INT64_MIN;
+    ints[40] = INT64_MAX;
+    floats[5] = NAN;
+    floats[70] = -0.0;
+    floats[131] = INFINITY;
+    codes[9] = UINT32_MAX;
+}
+
+static void teardown(void) {
+    simd_set_level(SIMD_AVX2);
+}
+
+static int words(int n) {
+    return (n + 63) / 64;
+}
+
+/* Runs kernel at the current level and at SIMD_SCALAR over every length
+   and skew, and asserts the masks match word for word without writing
+   past the last one. */
+#define CHECK_KERNEL(level, call_scalar, call_level)                            \
+    do {                                                                        \
+        uint64_t want[MAX_N / 64 + 2], got[MAX_N / 64 + 2];                     \
+        for (int skew = 0; skew < MAX_SKEW; skew++) {                           \
+            for (int n = 0; n <= MAX_N; n++) {                                  \
+                for (int invert = 0; invert < 2; invert++) {                    \
+                    simd_set_level(SIMD_SCALAR);                                \
+                    call_scalar;                                                \
+                    for (size_t w = 0; w < sizeof(got) / sizeof(got[0]); w++) got[w] = GUARD; \
+                    simd_set_level(level);                                      \
+                    call_level;                                                 \
+                    for (int w = 0; w < words(n); w++) {                        \
+                        cr_assert_eq(got[w], want[w], "%s skew %d n %d invert %d word %d", \
+                                     simd_level_name(level), skew, n, invert, w); \
+                    }                                                           \
+                    cr_assert_eq(got[words(n)], GUARD, "%s wrote past n %d", simd_level_name(level), n); \
+                }                                                               \
+            }                                                                   \
+        }                                                                       \
+    } while (0)
+
+Test(simd, range_i64_matches_scalar, .fini = teardown) {
+    fill();
+    const int64_t bounds[][2] = { { -1, 2 }, { 0, 0 }, { INT64_MIN, -3 }, { 3, INT64_MAX }, { 5, -5 } };
+    for (SimdLevel level = SIMD_SSE2; level <= simd_detect(); level++) {
+        for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+            int64_t lo = bounds[b][0], hi = bounds[b][1];
+            CHECK_KERNEL(level, filter_range_i64(ints + skew, n, lo, hi, invert, want),
+                         filter_range_i64(ints + skew, n, lo, hi, invert, got));
+        }
+    }
+}
+
+Test(simd, range_f64_matches_scalar, .fini = teardown) {
+    fill();
+    const double bounds[][2] = { { -0.5, 1.0 }, { 0.0, 0.0 }, { -INFINITY, -1.5 }, { 1.5, INFINITY }, { 2.0, -2.0 } };
+    for (SimdLevel level = SIMD_SSE2; level <= simd_detect(); level++) {
+        for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+            double lo = bounds[b][0], hi = bounds[b][1];
+            CHECK_KERNEL(level, filter_range_f64(floats + skew, n, lo, hi, invert, want),
+                         filter_range_f64(floats + skew, n, lo, hi, invert, got));
+        }
+    }
+}
+
+Test(simd, eq_u32_matches_scalar, .fini = teardown) {
+    fill();
+    const uint32_t keys[] = { 0, 4, 8, UINT32_MAX, 100 };
+    for (SimdLevel level = SIMD_SSE2; level <= simd_detect(); level++) {
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+            uint32_t key = keys[k];
+            CHECK_KERNEL(level, filter_eq_u32(codes + skew, n, key, invert, want),
+                         filter_eq_u32(codes + skew, n, key, invert, got));
+        }
+    }
+}
+
+Test(simd, scalar_mask_and_selection, .fini = teardown) {
+    fill();
+    simd_set_level(SIMD_SCALAR);
+    uint64_t mask[MAX_N / 64 + 1];
+    int sel[MAX_N], ids[MAX_N];
+    for (int i = 0; i < MAX_N; i++) ids[i] = 1000 + 2 * i;
+    for (int n = 0; n <= MAX_N; n++) {
+        filter_range_i64(ints + 1, n, -1, 2, 1, mask);
+        // Bits past n stay clear even when invert sets the rest
+        if (n % 64) cr_assert_eq(mask[n / 64] >> (n % 64), 0, "n %d", n);
+
+        int count = mask_to_selection(mask, n, NULL, 10, sel);
+        int expect = 0;
+        for (int k = 0; k < n; k++) {
+            if (ints[1 + k] >= -1 && ints[1 + k] <= 2) continue;
+            cr_assert_lt(expect, count);
+            cr_assert_eq(sel[expect], 10 + k, "n %d", n);
+            expect++;
+        }
+        cr_assert_eq(count, expect);
+        int with_ids = mask_to_selection(mask, n, ids, 0, sel);
+        cr_assert_eq(with_ids, count);
+        for (int k = 0; k < with_ids; k++) cr_assert_eq(sel[k] % 2, 0);
+    }
+}
+
+Test(simd, level_is_capped_at_the_cpu) {
+    SimdLevel best = simd_detect();
+    cr_assert_eq(simd_set_level(SIMD_AVX2), best);
+    cr_assert_eq(simd_level(), best);
+    cr_assert_eq(simd_set_level(SIMD_SCALAR), SIMD_SCALAR);
+    cr_assert_str_eq(simd_level_name(simd_level()), "scalar");
+    simd_set_level(SIMD_AVX2);
+}
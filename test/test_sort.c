@@ -0,0 +1,206 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include "miniqlite.h"
+
+#define NUM_ROWS 10000  // at 64 entries per run this spills over SORT_FANIN runs
+
+static Database db;
+static Table* t;
+static size_t saved_budget;
+
+static void run(const char* sql) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", sql);
+    cr_assert_eq(execute_command(&db, buf), 0);
+}
+
+/* s (k INT, f FLOAT, name TEXT) with many equal keys in each column,
+   less the rows with k = 5, which stay behind as tombstones. */
+static void setup(void) {
+    init_database(&db);
+    saved_budget = sort_budget();
+    ColumnDef cols[3] = {
+        { "k", COL_INT, 0 },
+        { "f", COL_FLOAT, 0 },
+        { "name", COL_TEXT, 0 },
+    };
+    cr_assert(create_table(&db, "s", cols, 3));
+    Statement* ins = stmt_prepare(&db, "INSERT INTO s VALUES (?, ?, ?)");
+    cr_assert_not_null(ins);
+    for (int i = 0; i < NUM_ROWS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%03d", (i * 31) % 211);
+        cr_assert(stmt_bind_int(ins, 1, (i * 7919) % 97));
+        cr_assert(stmt_bind_float(ins, 2, ((i * 13) % 59) * 0.25 - 3.0));
+        cr_assert(stmt_bind_text(ins, 3, name));
+        cr_assert_eq(stmt_step(ins), STEP_DONE);
+    }
+    stmt_finalize(ins);
+    run("DELETE FROM s WHERE k = 5");
+    t = find_table(&db, "s");
+    cr_assert_gt(t->num_deleted, 0);
+}
+
+static void teardown(void) {
+    sort_set_budget(saved_budget);
+    free_database(&db);
+}
+
+// The order qsort checks against: key, then row id ascending in either direction
+static int ref_col, ref_desc;
+
+static int ref_cmp(const void* pa, const void* pb) {
+    int a = *(const int*)pa, b = *(const int*)pb;
+    Value va, vb;
+    table_cell_value(t, a, ref_col, &va);
+    table_cell_value(t, b, ref_col, &vb);
+    int c = value_compare(&va, &vb);
+    if (ref_desc) c = -c;
+    return c != 0 ? c : (a > b) - (a < b);
+}
+
+static int expected(int col, int desc, int64_t below, int* out) {
+    int n = 0;
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        Value v;
+        table_cell_value(t, r, 1, &v);
+        if (below >= 0 && v.f >= (double)below) continue;
+        out[n++] = r;
+    }
+    ref_col = col;
+    ref_desc = desc;
+    qsort(out, (size_t)n, sizeof(int), ref_cmp);
+    return n;
+}
+
+typedef struct {
+    int* rows;
+    int count;
+} Collected;
+
+static int collect(BatchSink* self, const Table* table, const Batch* b,
+                   const VectorView* cols, int num_cols) {
+    (void)table;
+    (void)cols;
+    (void)num_cols;
+    Collected* c = self->state;
+    for (int k = 0; k < b->count; k++) {
+        cr_assert_lt(c->count, NUM_ROWS);
+        c->rows[c->count++] = b->sel[k];
+    }
+    return 1;
+}
+
+/* ORDER BY col through pipeline_run_sorted, or the B+tree walk when ix is
+   given; below >= 0 adds WHERE f < below. */
+static int ordered(const Index* ix, int col, int desc, int64_t below, int64_t offset, int64_t limit, int* out) {
+    Expr where;
+    memset(&where, 0, sizeof(where));
+    where.kind = EXPR_CMP;
+    strcpy(where.cmp.column, "f");
+    snprintf(where.cmp.value, sizeof(where.cmp.value), "%lld", (long long)below);
+    where.cmp.op = CMP_LT;
+
+    ScanSpec spec;
+    WhereProgram prog;
+    cr_assert(plan_where(t, below >= 0 ? &where : NULL, &spec, &prog));
+    int proj[1] = { col };
+    spec.cols = proj;
+    spec.num_cols = 1;
+    spec.offset = offset;
+    spec.limit = limit;
+    Collected c = { out, 0 };
+    BatchSink sink = { collect, &c, NULL, NULL };
+    cr_assert(ix ? pipeline_run_indexed(t, &spec, ix, desc, &sink)
+                 : pipeline_run_sorted(t, &spec, col, desc, &sink));
+    release_plan(&spec, &prog);
+    return c.count;
+}
+
+static int sorted(int col, int desc, int64_t below, int64_t offset, int64_t limit, int* out) {
+    return ordered(NULL, col, desc, below, offset, limit, out);
+}
+
+static void check_order(int col, int desc, int64_t below) {
+    static int want[NUM_ROWS], got[NUM_ROWS];
+    int n = expected(col, desc, below, want);
+    cr_assert_gt(n, 0);
+    cr_assert_eq(sorted(col, desc, below, 0, -1, got), n, "col %d desc %d", col, desc);
+    for (int i = 0; i < n; i++) cr_assert_eq(got[i], want[i], "col %d desc %d position %d", col, desc, i);
+
+    // OFFSET drops the first rows of the same order
+    int off = n / 3;
+    cr_assert_eq(sorted(col, desc, below, off, -1, got), n - off);
+    for (int i = 0; i < n - off; i++) cr_assert_eq(got[i], want[off + i]);
+}
+
+Test(sort, in_memory, .init = setup, .fini = teardown) {
+    for (int col = 0; col < 3; col++) {
+        check_order(col, 0, -1);
+        check_order(col, 1, -1);
+    }
+}
+
+Test(sort, external_merge_with_a_tiny_budget, .init = setup, .fini = teardown) {
+    // Below the floor of 64 entries, so every 64 rows spill as one run
+    sort_set_budget(1);
+    for (int col = 0; col < 3; col++) {
+        check_order(col, 0, -1);
+        check_order(col, 1, -1);
+    }
+}
+
+Test(sort, external_merge_after_a_filter, .init = setup, .fini = teardown) {
+    sort_set_budget(1);
+    check_order(0, 0, 2);
+    check_order(2, 1, 2);
+}
+
+Test(sort, top_n_matches_the_full_sort, .init = setup, .fini = teardown) {
+    static int want[NUM_ROWS], got[NUM_ROWS];
+    sort_set_budget(1);
+    for (int col = 0; col < 3; col++) {
+        for (int desc = 0; desc < 2; desc++) {
+            int n = expected(col, desc, -1, want);
+            cr_assert_eq(sorted(col, desc, -1, 0, 25, got), 25);
+            for (int i = 0; i < 25; i++) cr_assert_eq(got[i], want[i]);
+            cr_assert_eq(sorted(col, desc, -1, 100, 10, got), 10);
+            for (int i = 0; i < 10; i++) cr_assert_eq(got[i], want[100 + i]);
+            // A LIMIT past the end returns every row
+            cr_assert_eq(sorted(col, desc, -1, 0, NUM_ROWS * 2, got), n);
+        }
+    }
+}
+
+Test(sort, sortmem_command_sets_the_budget, .init = setup, .fini = teardown) {
+    run(".sortmem 1");
+    cr_assert_eq(sort_budget(), 1024);
+    check_order(0, 1, -1);
+    check_order(2, 0, 5);
+}
+
+Test(sort, index_walk_matches_the_sort, .init = setup, .fini = teardown) {
+    static int want[NUM_ROWS], got[NUM_ROWS];
+    run("CREATE INDEX s_k ON s(k) USING BTREE");
+    run("CREATE INDEX s_name ON s(name) USING BTREE");
+    const int cols[2] = { 0, 2 };
+    for (int c = 0; c < 2; c++) {
+        const Index* ix = table_find_ordered_index(t, cols[c]);
+        cr_assert_not_null(ix);
+        for (int desc = 0; desc < 2; desc++) {
+            int n = expected(cols[c], desc, -1, want);
+            cr_assert_eq(ordered(ix, cols[c], desc, -1, 0, -1, got), n);
+            for (int i = 0; i < n; i++) cr_assert_eq(got[i], want[i], "col %d desc %d position %d", cols[c], desc, i);
+            cr_assert_eq(ordered(ix, cols[c], desc, -1, 50, 20, got), 20);
+            for (int i = 0; i < 20; i++) cr_assert_eq(got[i], want[50 + i]);
+
+            // The WHERE runs over each chunk of the walk
+            n = expected(cols[c], desc, 4, want);
+            cr_assert_eq(ordered(ix, cols[c], desc, 4, 0, 7, got), 7);
+            for (int i = 0; i < 7; i++) cr_assert_eq(got[i], want[i]);
+            cr_assert_eq(ordered(ix, cols[c], desc, 4, n - 3, 10, got), 3);
+            for (int i = 0; i < 3; i++) cr_assert_eq(got[i], want[n - 3 + i]);
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include "miniqlite.h"
+
+static Database db;
+
+static void setup(void) {
+    init_database(&db);
+}
+
+static void teardown(void) {
+    free_database(&db);
+}
+
+static void create_people(void) {
+    ColumnDef cols[3] = {
+        { "id", COL_INT, 0 },
+        { "name", COL_TEXT, 0 },
+        { "score", COL_FLOAT, 0 },
+    };
+    cr_assert(create_table(&db, "people", cols, 3));
+}
+
+/* Inserts ids first .. last through a prepared INSERT. */
+static void insert_people(int first, int last) {
+    Statement* ins = stmt_prepare(&db, "INSERT INTO people VALUES (?, ?, ?)");
+    cr_assert_not_null(ins);
+    for (int i = first; i <= last; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "p%d", i);
+        cr_assert(stmt_bind_int(ins, 1, i));
+        cr_assert(stmt_bind_text(ins, 2, name));
+        cr_assert(stmt_bind_float(ins, 3, i * 0.5));
+        cr_assert_eq(stmt_step(ins), STEP_DONE);
+    }
+    stmt_finalize(ins);
+}
+
+/* Steps a one-column SELECT to the end, collecting its INT values. */
+static int collect_ids(Statement* st, int64_t* out, int max) {
+    int n = 0;
+    StepResult r;
+    while ((r = stmt_step(st)) == STEP_ROW) {
+        Value v;
+        stmt_column_value(st, 0, &v);
+        cr_assert_lt(n, max);
+        out[n++] = v.i;
+    }
+    cr_assert_eq(r, STEP_DONE);
+    return n;
+}
+
+Test(statement, insert_bind_step_reexecute, .init = setup, .fini = teardown) {
+    create_people();
+    insert_people(1, 100);
+    cr_assert_eq(find_table(&db, "people")->num_rows, 100);
+
+    Statement* sel = stmt_prepare(&db, "SELECT id, name, score FROM people WHERE id = ?");
+    cr_assert_not_null(sel);
+    cr_assert_eq(stmt_column_count(sel), 3);
+    cr_assert_str_eq(stmt_column_name(sel, 1), "name");
+
+    cr_assert(stmt_bind_int(sel, 1, 42));
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    Value v;
+    stmt_column_value(sel, 0, &v);
+    cr_assert_eq(v.i, 42);
+    stmt_column_value(sel, 1, &v);
+    cr_assert_str_eq(v.s, "p42");
+    stmt_column_value(sel, 2, &v);
+    cr_assert_float_eq(v.f, 21.0, 1e-9);
+    cr_assert_str_eq(stmt_column_text(sel, 2), "21");
+    cr_assert_eq(stmt_step(sel), STEP_DONE);
+
+    // After STEP_DONE the next step runs the query again with the same bindings
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    cr_assert_eq(stmt_step(sel), STEP_DONE);
+
+    // New bindings apply from the next run, even mid-result
+    cr_assert(stmt_bind_int(sel, 1, 7));
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    stmt_column_value(sel, 0, &v);
+    cr_assert_eq(v.i, 7);
+    cr_assert_eq(stmt_step(sel), STEP_DONE);
+    stmt_finalize(sel);
+}
+
+Test(statement, typed_binds_follow_column_types, .init = setup, .fini = teardown) {
+    db.column_store = 1;
+    create_people();
+    Statement* ins = stmt_prepare(&db, "INSERT INTO people VALUES (?, \"lit\", ?)");
+    cr_assert_not_null(ins);
+
+    // Text parses into INT, and INT widens into FLOAT
+    cr_assert(stmt_bind_text(ins, 1, "12"));
+    cr_assert(stmt_bind_int(ins, 2, 3));
+    cr_assert_eq(stmt_step(ins), STEP_DONE);
+
+    // A value the column cannot hold inserts nothing
+    cr_assert(stmt_bind_float(ins, 1, 2.5));
+    cr_assert_eq(stmt_step(ins), STEP_ERROR);
+    cr_assert_eq(find_table(&db, "people")->num_rows, 1);
+    stmt_finalize(ins);
+
+    Statement* sel = stmt_prepare(&db, "SELECT name, score FROM people WHERE id = 12");
+    cr_assert_not_null(sel);
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    cr_assert_str_eq(stmt_column_text(sel, 0), "lit");
+    Value v;
+    stmt_column_value(sel, 1, &v);
+    cr_assert_eq(v.type, COL_FLOAT);
+    cr_assert_float_eq(v.f, 3.0, 1e-9);
+    stmt_finalize(sel);
+
+    // Bad literals and unknown names are reported at prepare time
+    cr_assert_null(stmt_prepare(&db, "INSERT INTO people VALUES (abc, ?, ?)"));
+    cr_assert_null(stmt_prepare(&db, "INSERT INTO people VALUES (?, ?)"));
+    cr_assert_null(stmt_prepare(&db, "SELECT nope FROM people"));
+    cr_assert_null(stmt_prepare(&db, "SELECT id FROM nowhere"));
+}
+
+Test(statement, unbound_parameters_are_rejected, .init = setup, .fini = teardown) {
+    create_people();
+    insert_people(1, 5);
+    Statement* sel = stmt_prepare(&db, "SELECT id FROM people WHERE id >= ? AND id <= ?");
+    cr_assert_not_null(sel);
+    cr_assert_eq(stmt_step(sel), STEP_ERROR);
+
+    cr_assert(stmt_bind_int(sel, 1, 2));
+    cr_assert_eq(stmt_step(sel), STEP_ERROR);
+    cr_assert_not(stmt_bind_int(sel, 3, 9));
+    cr_assert_not(stmt_bind_int(sel, 0, 9));
+
+    cr_assert(stmt_bind_int(sel, 2, 4));
+    int64_t ids[8];
+    cr_assert_eq(collect_ids(sel, ids, 8), 3);
+    cr_assert_eq(ids[0], 2);
+    cr_assert_eq(ids[2], 4);
+    stmt_finalize(sel);
+}
+
+Test(statement, reresolves_after_drop_and_create, .init = setup, .fini = teardown) {
+    create_people();
+    insert_people(1, 3);
+    Statement* sel = stmt_prepare(&db, "SELECT id, name FROM people WHERE id = ?");
+    Statement* ins = stmt_prepare(&db, "INSERT INTO people VALUES (?, ?, ?)");
+    cr_assert_not_null(sel);
+    cr_assert_not_null(ins);
+    cr_assert(stmt_bind_int(sel, 1, 2));
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    stmt_reset(sel);
+
+    cr_assert(drop_table(&db, "people"));
+    cr_assert_eq(stmt_step(sel), STEP_ERROR);
+
+    // The same name with columns in another order: names resolve afresh
+    ColumnDef cols[3] = {
+        { "name", COL_TEXT, 0 },
+        { "score", COL_FLOAT, 0 },
+        { "id", COL_INT, 0 },
+    };
+    cr_assert(create_table(&db, "people", cols, 3));
+    cr_assert(stmt_bind_text(ins, 1, "q2"));
+    cr_assert(stmt_bind_float(ins, 2, 1.5));
+    cr_assert(stmt_bind_int(ins, 3, 2));
+    cr_assert_eq(stmt_step(ins), STEP_DONE);
+
+    cr_assert_eq(stmt_step(sel), STEP_ROW);
+    Value v;
+    stmt_column_value(sel, 0, &v);
+    cr_assert_eq(v.type, COL_INT);
+    cr_assert_eq(v.i, 2);
+    cr_assert_str_eq(stmt_column_text(sel, 1), "q2");
+    cr_assert_eq(stmt_step(sel), STEP_DONE);
+    stmt_finalize(sel);
+    stmt_finalize(ins);
+}
+
+Test(statement, select_with_where_and_limit_params, .init = setup, .fini = teardown) {
+    create_people();
+    insert_people(1, 50);
+    Statement* sel = stmt_prepare(&db, "SELECT id FROM people WHERE id >= ? LIMIT ? OFFSET ?");
+    cr_assert_not_null(sel);
+
+    cr_assert(stmt_bind_int(sel, 1, 10));
+    cr_assert(stmt_bind_int(sel, 2, 3));
+    cr_assert(stmt_bind_int(sel, 3, 2));
+    int64_t ids[64];
+    cr_assert_eq(collect_ids(sel, ids, 64), 3);
+    cr_assert_eq(ids[0], 12);
+    cr_assert_eq(ids[1], 13);
+    cr_assert_eq(ids[2], 14);
+
+    cr_assert(stmt_bind_int(sel, 1, 45));
+    cr_assert(stmt_bind_int(sel, 2, 10));
+    cr_assert(stmt_bind_int(sel, 3, 0));
+    cr_assert_eq(collect_ids(sel, ids, 64), 6);
+    cr_assert_eq(ids[5], 50);
+
+    cr_assert(stmt_bind_int(sel, 2, -1));
+    cr_assert_eq(stmt_step(sel), STEP_ERROR);
+    stmt_finalize(sel);
+
+    // A literal LIMIT with a ? in the WHERE
+    sel = stmt_prepare(&db, "SELECT id FROM people WHERE name = ? LIMIT 1");
+    cr_assert_not_null(sel);
+    cr_assert(stmt_bind_text(sel, 1, "p33"));
+    cr_assert_eq(collect_ids(sel, ids, 64), 1);
+    cr_assert_eq(ids[0], 33);
+    stmt_finalize(sel);
+}
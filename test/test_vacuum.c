@@ -0,0 +1,177 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include "miniqlite.h"
+
+#define NUM_ROWS 6000
+
+static Database db;
+
+static void setup(void) {
+    init_database(&db);
+}
+
+static void teardown(void) {
+    free_database(&db);
+}
+
+static int run(const char* sql) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", sql);
+    return execute_command(&db, buf);
+}
+
+/* v (id INT PRIMARY KEY, k INT, name TEXT) with a B+tree on k and a hash
+   index on name; k and name repeat, id does not. */
+static Table* create_indexed(int column_major) {
+    ColumnDef cols[3] = {
+        { "id", COL_INT, COLUMN_PRIMARY_KEY | COLUMN_UNIQUE },
+        { "k", COL_INT, 0 },
+        { "name", COL_TEXT, COLUMN_DICT },
+    };
+    db.column_store = column_major;
+    cr_assert(create_table(&db, "v", cols, 3));
+    Statement* ins = stmt_prepare(&db, "INSERT INTO v VALUES (?, ?, ?)");
+    cr_assert_not_null(ins);
+    for (int i = 0; i < NUM_ROWS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%d", i % 37);
+        cr_assert(stmt_bind_int(ins, 1, i));
+        cr_assert(stmt_bind_int(ins, 2, (i * 7) % 101));
+        cr_assert(stmt_bind_text(ins, 3, name));
+        cr_assert_eq(stmt_step(ins), STEP_DONE);
+    }
+    stmt_finalize(ins);
+    cr_assert_eq(run("CREATE INDEX v_k ON v(k) USING BTREE"), 0);
+    cr_assert_eq(run("CREATE INDEX v_name ON v(name)"), 0);
+    return find_table(&db, "v");
+}
+
+/* Every index entry points at the row now holding its key: each live
+   row is found through each index, and the indexes hold nothing else. */
+static void check_indexes(Table* t) {
+    static int out[NUM_ROWS];
+    int live = t->num_rows - t->num_deleted;
+    for (int i = 0; i < t->num_indexes; i++) {
+        const Index* ix = &t->indexes[i];
+        int total = 0;
+        for (int r = 0; r < t->num_rows; r++) {
+            if (table_row_deleted(t, r)) continue;
+            Value key;
+            table_cell_value(t, r, ix->column, &key);
+            int n = index_lookup(t, ix, &key, out);
+            int found = 0;
+            for (int j = 0; j < n; j++) {
+                Value v;
+                cr_assert(!table_row_deleted(t, out[j]), "index %s row %d", ix->name, out[j]);
+                table_cell_value(t, out[j], ix->column, &v);
+                cr_assert(value_equals(&v, &key), "index %s row %d", ix->name, out[j]);
+                found += out[j] == r;
+            }
+            cr_assert_eq(found, 1, "index %s misses row %d", ix->name, r);
+        }
+        if (ix->kind == INDEX_BTREE) {
+            BTreeCursor c;
+            memset(&c, 0, sizeof(c));
+            total = index_ordered_rows(t, ix, 0, &c, NUM_ROWS, out);
+            cr_assert_eq(total, live, "index %s holds %d rows, %d live", ix->name, total, live);
+        }
+    }
+}
+
+/* ids of the live rows, in row order */
+static int live_ids(Table* t, int64_t* out) {
+    int n = 0;
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        Value v;
+        table_cell_value(t, r, 0, &v);
+        out[n++] = v.i;
+    }
+    return n;
+}
+
+static void auto_vacuum_renumbers(int column_major) {
+    static int64_t ids[NUM_ROWS];
+    Table* t = create_indexed(column_major);
+
+    // Too few tombstones to compact
+    cr_assert_eq(run("DELETE FROM v WHERE k = 3"), 0);
+    cr_assert_gt(t->num_deleted, 0);
+    check_indexes(t);
+
+    // Over AUTO_VACUUM_MIN_DEAD and a quarter of the slots: the DELETE compacts
+    cr_assert_eq(run("DELETE FROM v WHERE k < 30"), 0);
+    cr_assert_eq(t->num_deleted, 0);
+    int n = live_ids(t, ids);
+    cr_assert_eq(n, t->num_rows);
+    cr_assert_lt(n, NUM_ROWS - AUTO_VACUUM_MIN_DEAD);
+    for (int i = 1; i < n; i++) cr_assert_lt(ids[i - 1], ids[i], "rows keep their order");
+    for (int i = 0; i < n; i++) cr_assert_geq((ids[i] * 7) % 101, 30);
+    check_indexes(t);
+
+    // The PRIMARY KEY index was renumbered too: a live id is taken, a deleted one is free
+    char dup[64], reuse[64];
+    snprintf(dup, sizeof(dup), "INSERT INTO v VALUES (%lld, 1, \"x\")", (long long)ids[n / 2]);
+    cr_assert_eq(run(dup), 0);
+    cr_assert_eq(t->num_rows, n);
+    snprintf(reuse, sizeof(reuse), "INSERT INTO v VALUES (%d, 1, \"x\")", 0);
+    cr_assert_eq(run(reuse), 0);
+    cr_assert_eq(t->num_rows, n + 1);
+    check_indexes(t);
+
+    // Updates through the renumbered indexes hit the right rows
+    cr_assert_eq(run("UPDATE v SET name = \"moved\" WHERE k = 50"), 0);
+    Statement* sel = stmt_prepare(&db, "SELECT k FROM v WHERE name = \"moved\"");
+    cr_assert_not_null(sel);
+    int moved = 0;
+    while (stmt_step(sel) == STEP_ROW) {
+        Value v;
+        stmt_column_value(sel, 0, &v);
+        cr_assert_eq(v.i, 50);
+        moved++;
+    }
+    cr_assert_gt(moved, 0);
+    stmt_finalize(sel);
+    check_indexes(t);
+}
+
+Test(vacuum, auto_vacuum_renumbers_row_major, .init = setup, .fini = teardown) {
+    auto_vacuum_renumbers(0);
+}
+
+Test(vacuum, auto_vacuum_renumbers_column_major, .init = setup, .fini = teardown) {
+    auto_vacuum_renumbers(1);
+}
+
+Test(vacuum, explicit_vacuum_and_layout_change, .init = setup, .fini = teardown) {
+    static int64_t before[NUM_ROWS], after[NUM_ROWS];
+    Table* t = create_indexed(1);
+    cr_assert_eq(run("DELETE FROM v WHERE name = \"n4\""), 0);
+    cr_assert_gt(t->num_deleted, 0);
+    int n = live_ids(t, before);
+
+    cr_assert_eq(vacuum_table(t), NUM_ROWS - n);
+    cr_assert_eq(vacuum_table(t), 0);
+    cr_assert_eq(live_ids(t, after), n);
+    cr_assert_eq(memcmp(before, after, sizeof(int64_t) * (size_t)n), 0);
+    check_indexes(t);
+
+    // Zone maps follow the compacted rows
+    Statement* sel = stmt_prepare(&db, "SELECT id FROM v WHERE id >= ? AND id < ?");
+    cr_assert_not_null(sel);
+    cr_assert(stmt_bind_int(sel, 1, NUM_ROWS - 100));
+    cr_assert(stmt_bind_int(sel, 2, NUM_ROWS));
+    int count = 0;
+    while (stmt_step(sel) == STEP_ROW) count++;
+    int expect = 0;
+    for (int i = 0; i < n; i++) expect += before[i] >= NUM_ROWS - 100;
+    cr_assert_eq(count, expect);
+    stmt_finalize(sel);
+
+    // A layout change also drops the tombstones and renumbers the indexes
+    cr_assert_eq(run("DELETE FROM v WHERE k = 7"), 0);
+    cr_assert_gt(t->num_deleted, 0);
+    cr_assert_eq(run("ALTER TABLE v SET LAYOUT ROW"), 0);
+    cr_assert_eq(t->num_deleted, 0);
+    check_indexes(t);
+}
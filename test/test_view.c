@@ -0,0 +1,176 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+#include "miniqlite.h"
+
+#define MAX_GROUPS 256
+
+static Database db;
+
+static void setup(void) {
+    init_database(&db);
+}
+
+static void teardown(void) {
+    free_database(&db);
+}
+
+static void run(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void run(const char* fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    cr_assert_eq(execute_command(&db, buf), 0, "%s", buf);
+}
+
+//One group of a fresh GROUP BY g, k over the base table
+typedef struct {
+    const char* g;
+    int64_t k;
+    int64_t count;
+    int64_t xsum;
+    double ysum;
+} Group;
+
+static int find_group(Group* groups, int n, const char* g, int64_t k) {
+    for (int i = 0; i < n; i++) {
+        if (groups[i].k == k && strcmp(groups[i].g, g) == 0) return i;
+    }
+    return -1;
+}
+
+/* The view v AS SELECT g, k, COUNT(*), SUM(x), SUM(y), AVG(y) FROM t
+   GROUP BY g, k holds exactly the groups a full scan of t finds. */
+static void check_view(void) {
+    static Group groups[MAX_GROUPS];
+    Table* t = find_table(&db, "t");
+    Table* v = find_table(&db, "v");
+    cr_assert(t && v && v->view);
+
+    int n = 0;
+    for (int r = 0; r < t->num_rows; r++) {
+        if (table_row_deleted(t, r)) continue;
+        Value g, k, x, y;
+        table_cell_value(t, r, 0, &g);
+        table_cell_value(t, r, 1, &k);
+        table_cell_value(t, r, 2, &x);
+        table_cell_value(t, r, 3, &y);
+        int i = find_group(groups, n, g.s, k.i);
+        if (i < 0) {
+            cr_assert_lt(n, MAX_GROUPS);
+            i = n++;
+            memset(&groups[i], 0, sizeof(Group));
+            groups[i].g = g.s;
+            groups[i].k = k.i;
+        }
+        groups[i].count++;
+        groups[i].xsum += x.i;
+        groups[i].ysum += y.f;
+    }
+
+    cr_assert_eq(v->num_deleted, 0, "a view never holds dead rows");
+    cr_assert_eq(v->num_rows, n, "view has %d groups, a fresh GROUP BY %d", v->num_rows, n);
+    for (int r = 0; r < v->num_rows; r++) {
+        Value g, k, count, xsum, ysum, yavg;
+        table_cell_value(v, r, 0, &g);
+        table_cell_value(v, r, 1, &k);
+        table_cell_value(v, r, 2, &count);
+        table_cell_value(v, r, 3, &xsum);
+        table_cell_value(v, r, 4, &ysum);
+        table_cell_value(v, r, 5, &yavg);
+        int i = find_group(groups, n, g.s, k.i);
+        cr_assert_geq(i, 0, "view group (%s, %lld) is not in the table", g.s, (long long)k.i);
+        cr_assert_eq(count.i, groups[i].count, "group (%s, %lld)", g.s, (long long)k.i);
+        cr_assert_eq(xsum.i, groups[i].xsum, "group (%s, %lld)", g.s, (long long)k.i);
+        cr_assert_float_eq(ysum.f, groups[i].ysum, 1e-6);
+        cr_assert_float_eq(yavg.f, groups[i].ysum / (double)groups[i].count, 1e-6);
+        groups[i].count = -1;  // each group once
+    }
+}
+
+static void create_base_and_view(int column_major) {
+    db.column_store = column_major;
+    run("CREATE TABLE t (g TEXT, k INT, x INT, y FLOAT)");
+    for (int i = 0; i < 200; i++) {
+        run("INSERT INTO t VALUES (\"g%d\", %d, %d, %d.25)", i % 5, i % 7, i - 100, i % 11);
+    }
+    run("CREATE MATERIALIZED VIEW v AS SELECT g, k, COUNT(*), SUM(x), SUM(y), AVG(y) FROM t GROUP BY g, k");
+    check_view();
+}
+
+static void churn(void) {
+    // A multi-row INSERT, including new groups
+    run("INSERT INTO t VALUES (\"g1\", 3, 5, 1.5), (\"new\", 100, 7, 2.0), (\"new\", 100, -7, 0.5)");
+    check_view();
+
+    // Updates to an aggregated column stay in their group
+    run("UPDATE t SET x = 1000 WHERE k = 2");
+    check_view();
+    run("UPDATE t SET y = -1.5 WHERE x < 0");
+    check_view();
+
+    // Updates to a GROUP BY column move rows between groups
+    run("UPDATE t SET g = \"g0\" WHERE g = \"g4\"");
+    check_view();
+    run("UPDATE t SET k = 100 WHERE x > 50");
+    check_view();
+
+    // Deletes empty whole groups, which swap the last result row into place
+    run("DELETE FROM t WHERE g = \"g2\"");
+    check_view();
+    run("DELETE FROM t WHERE k = 100");
+    check_view();
+    run("DELETE FROM t WHERE x = 1000");
+    check_view();
+
+    // Refill after the table was emptied
+    run("DELETE FROM t WHERE k >= 0");
+    check_view();
+    run("INSERT INTO t VALUES (\"g9\", 9, 9, 9.0)");
+    check_view();
+}
+
+Test(view, consistent_through_writes_row_major, .init = setup, .fini = teardown) {
+    create_base_and_view(0);
+    churn();
+}
+
+Test(view, consistent_through_writes_column_major, .init = setup, .fini = teardown) {
+    create_base_and_view(1);
+    churn();
+}
+
+Test(view, consistent_through_auto_vacuum_and_layout_change, .init = setup, .fini = teardown) {
+    create_base_and_view(1);
+    Statement* ins = stmt_prepare(&db, "INSERT INTO t VALUES (?, ?, ?, ?)");
+    cr_assert_not_null(ins);
+    for (int i = 0; i < 4000; i++) {
+        char g[8];
+        snprintf(g, sizeof(g), "h%d", i % 3);
+        cr_assert(stmt_bind_text(ins, 1, g));
+        cr_assert(stmt_bind_int(ins, 2, i % 13));
+        cr_assert(stmt_bind_int(ins, 3, i));
+        cr_assert(stmt_bind_float(ins, 4, 0.5));
+        cr_assert_eq(stmt_step(ins), STEP_DONE);
+    }
+    stmt_finalize(ins);
+    check_view();
+
+    // Enough tombstones for the DELETE to compact the base table
+    run("DELETE FROM t WHERE x < 2500");
+    cr_assert_eq(find_table(&db, "t")->num_deleted, 0);
+    check_view();
+
+    run("ALTER TABLE t SET LAYOUT ROW");
+    run("UPDATE t SET g = \"h0\" WHERE k = 4");
+    check_view();
+
+    // The view itself takes no writes
+    char ins_v[] = "INSERT INTO v VALUES (\"z\", 1, 1, 1, 1.0, 1.0)";
+    execute_command(&db, ins_v);
+    check_view();
+}
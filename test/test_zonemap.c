@@ -0,0 +1,222 @@
+#include <criterion/criterion.h>
+#include <math.h>
+#include <string.h>
+#include "miniqlite.h"
+
+static Database db;
+
+static void setup(void) {
+    init_database(&db);
+}
+
+static void teardown(void) {
+    free_database(&db);
+}
+
+/* Creates table name (x FLOAT) in the given layout and inserts xs. */
+static void create_floats(const char* name, int column_major, const double* xs, int n) {
+    ColumnDef cols[1] = { { "x", COL_FLOAT, 0 } };
+    db.column_store = column_major;
+    cr_assert(create_table(&db, name, cols, 1));
+    char sql[64];
+    snprintf(sql, sizeof(sql), "INSERT INTO %s VALUES (?)", name);
+    Statement* ins = stmt_prepare(&db, sql);
+    cr_assert_not_null(ins);
+    for (int i = 0; i < n; i++) {
+        cr_assert(stmt_bind_float(ins, 1, xs[i]));
+        cr_assert_eq(stmt_step(ins), STEP_DONE);
+    }
+    stmt_finalize(ins);
+}
+
+/* Runs SELECT x FROM name WHERE where, collecting x in row order. */
+static int select_floats(const char* name, const char* where, double* out, int max) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "SELECT x FROM %s WHERE %s", name, where);
+    Statement* sel = stmt_prepare(&db, sql);
+    cr_assert_not_null(sel);
+    int n = 0;
+    StepResult r;
+    while ((r = stmt_step(sel)) == STEP_ROW) {
+        Value v;
+        stmt_column_value(sel, 0, &v);
+        cr_assert_lt(n, max);
+        out[n++] = v.f;
+    }
+    cr_assert_eq(r, STEP_DONE);
+    stmt_finalize(sel);
+    return n;
+}
+
+static const char* const predicates[] = {
+    "x > 5", "x >= 5", "x < 5", "x <= 3", "x = 3", "x <> 3", "x <> 10",
+    "x > 5 AND x < 20", "NOT x > 5",
+};
+
+/* Every predicate returns the same rows from the row-major and the
+   column-major copy of xs. */
+static void check_layouts_agree(const double* xs, int n) {
+    create_floats("r", 0, xs, n);
+    create_floats("c", 1, xs, n);
+    double* a = malloc(sizeof(double) * (size_t)n);
+    double* b = malloc(sizeof(double) * (size_t)n);
+    cr_assert(a && b);
+    for (size_t p = 0; p < sizeof(predicates) / sizeof(predicates[0]); p++) {
+        int na = select_floats("r", predicates[p], a, n);
+        int nb = select_floats("c", predicates[p], b, n);
+        cr_assert_eq(na, nb, "%s: %d row-major rows, %d column-major", predicates[p], na, nb);
+        for (int i = 0; i < na; i++) {
+            cr_assert(a[i] == b[i] || (isnan(a[i]) && isnan(b[i])), "%s: row %d differs", predicates[p], i);
+        }
+    }
+    free(a);
+    free(b);
+}
+
+Test(zonemap, nan_first_in_block, .init = setup, .fini = teardown) {
+    double xs[] = { NAN, 10.0, 3.0 };
+    check_layouts_agree(xs, 3);
+
+    double out[3];
+    cr_assert_eq(select_floats("c", "x > 5", out, 3), 1);
+    cr_assert_float_eq(out[0], 10.0, 1e-9);
+    cr_assert_eq(select_floats("c", "x <> 3", out, 3), 2);
+    cr_assert(isnan(out[0]));
+}
+
+Test(zonemap, nan_later_in_block, .init = setup, .fini = teardown) {
+    double xs[] = { 3.0, 3.0, NAN, 3.0 };
+    check_layouts_agree(xs, 4);
+}
+
+Test(zonemap, nan_across_blocks, .init = setup, .fini = teardown) {
+    // Block 0 holds only 1.0; block 1 starts with a NaN; block 2 has none
+    int n = ZONE_ROWS * 2 + 100;
+    double* xs = malloc(sizeof(double) * (size_t)n);
+    cr_assert_not_null(xs);
+    for (int i = 0; i < n; i++) xs[i] = i < ZONE_ROWS ? 1.0 : (double)(i % 17);
+    xs[ZONE_ROWS] = NAN;
+    xs[ZONE_ROWS * 2 + 50] = 3.0;
+    check_layouts_agree(xs, n);
+    free(xs);
+}
+
+Test(zonemap, nan_survives_delete, .init = setup, .fini = teardown) {
+    double xs[] = { 3.0, NAN, 10.0 };
+    check_layouts_agree(xs, 3);
+
+    // Recomputing the block keeps the NaN's pin while it is live
+    char del_c[] = "DELETE FROM c WHERE x = 10";
+    char del_r[] = "DELETE FROM r WHERE x = 10";
+    cr_assert_eq(execute_command(&db, del_c), 0);
+    cr_assert_eq(execute_command(&db, del_r), 0);
+    double a[3], b[3];
+    cr_assert_eq(select_floats("c", "x <> 3", b, 3), 1);
+    cr_assert_eq(select_floats("r", "x <> 3", a, 3), 1);
+    cr_assert(isnan(a[0]) && isnan(b[0]));
+}
+
+/* Runs SELECT k FROM name WHERE where, collecting k in row order. */
+static int select_ints(const char* name, const char* where, int64_t* out, int max) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "SELECT k FROM %s WHERE %s", name, where);
+    Statement* sel = stmt_prepare(&db, sql);
+    cr_assert_not_null(sel);
+    int n = 0;
+    StepResult r;
+    while ((r = stmt_step(sel)) == STEP_ROW) {
+        Value v;
+        stmt_column_value(sel, 0, &v);
+        cr_assert_lt(n, max);
+        out[n++] = v.i;
+    }
+    cr_assert_eq(r, STEP_DONE);
+    stmt_finalize(sel);
+    return n;
+}
+
+static void run_both(const char* fmt) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), fmt, "r");
+    cr_assert_eq(execute_command(&db, sql), 0);
+    snprintf(sql, sizeof(sql), fmt, "c");
+    cr_assert_eq(execute_command(&db, sql), 0);
+}
+
+Test(zonemap, int_blocks_follow_updates_and_deletes, .init = setup, .fini = teardown) {
+    // Each block holds a narrow band of k, so most blocks are pruned
+    int n = ZONE_ROWS * 4;
+    ColumnDef cols[1] = { { "k", COL_INT, 0 } };
+    for (int layout = 0; layout < 2; layout++) {
+        db.column_store = layout;
+        cr_assert(create_table(&db, layout ? "c" : "r", cols, 1));
+        Statement* ins = stmt_prepare(&db, layout ? "INSERT INTO c VALUES (?)" : "INSERT INTO r VALUES (?)");
+        cr_assert_not_null(ins);
+        for (int i = 0; i < n; i++) {
+            cr_assert(stmt_bind_int(ins, 1, i / 100));
+            cr_assert_eq(stmt_step(ins), STEP_DONE);
+        }
+        stmt_finalize(ins);
+    }
+
+    const char* const where[] = { "k = 5", "k > 150", "k >= 40 AND k < 42", "k < 0", "k <> 0", "k = 9999" };
+    int64_t* a = malloc(sizeof(int64_t) * (size_t)n);
+    int64_t* b = malloc(sizeof(int64_t) * (size_t)n);
+    cr_assert(a && b);
+    for (int step = 0; step < 4; step++) {
+        // A value outside a block's band, a widened band, then emptied blocks
+        if (step == 1) run_both("UPDATE %s SET k = 9999 WHERE k = 3");
+        if (step == 2) run_both("UPDATE %s SET k = -1 WHERE k = 120");
+        if (step == 3) run_both("DELETE FROM %s WHERE k < 41");
+        for (size_t w = 0; w < sizeof(where) / sizeof(where[0]); w++) {
+            int na = select_ints("r", where[w], a, n);
+            int nb = select_ints("c", where[w], b, n);
+            cr_assert_eq(na, nb, "step %d %s: %d row-major rows, %d column-major", step, where[w], na, nb);
+            cr_assert_eq(memcmp(a, b, sizeof(int64_t) * (size_t)na), 0, "step %d %s", step, where[w]);
+        }
+    }
+    int64_t out[200];
+    cr_assert_eq(select_ints("c", "k = 9999", out, 200), 100);
+    cr_assert_eq(select_ints("c", "k < 0", out, 200), 0);
+    free(a);
+    free(b);
+}
+
+Test(zonemap, blocks_rebuilt_after_binary_reload, .init = setup, .fini = teardown) {
+    // Tombstones shift the saved rows between blocks, so stale zones would prune wrongly
+    int n = ZONE_ROWS * 3;
+    ColumnDef cols[1] = { { "k", COL_INT, 0 } };
+    for (int layout = 0; layout < 2; layout++) {
+        db.column_store = layout;
+        cr_assert(create_table(&db, layout ? "c" : "r", cols, 1));
+        Statement* ins = stmt_prepare(&db, layout ? "INSERT INTO c VALUES (?)" : "INSERT INTO r VALUES (?)");
+        cr_assert_not_null(ins);
+        for (int i = 0; i < n; i++) {
+            cr_assert(stmt_bind_int(ins, 1, i / 100));
+            cr_assert_eq(stmt_step(ins), STEP_DONE);
+        }
+        stmt_finalize(ins);
+    }
+    run_both("DELETE FROM %s WHERE k >= 10 AND k < 30");
+
+    db.binary_mode = 1;
+    cr_assert(save_database(&db, "zones.db"));
+    cr_assert(load_database(&db, "zones.db"));
+    remove("zones.db");
+    Table* c = find_table(&db, "c");
+    cr_assert(c && c->column_major);
+    cr_assert_eq(c->num_rows, n - 2000);
+
+    const char* const where[] = { "k = 5", "k = 35", "k >= 40 AND k < 42", "k > 100", "k < 10" };
+    int64_t* a = malloc(sizeof(int64_t) * (size_t)n);
+    int64_t* b = malloc(sizeof(int64_t) * (size_t)n);
+    cr_assert(a && b);
+    for (size_t w = 0; w < sizeof(where) / sizeof(where[0]); w++) {
+        int na = select_ints("r", where[w], a, n);
+        int nb = select_ints("c", where[w], b, n);
+        cr_assert_eq(na, nb, "%s: %d row-major rows, %d column-major", where[w], na, nb);
+        cr_assert_eq(memcmp(a, b, sizeof(int64_t) * (size_t)na), 0, "%s", where[w]);
+    }
+    free(a);
+    free(b);
+}